@@ -0,0 +1,163 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  main.cpp: TtyWidget and result view rendering benchmarks
+ **
+ **  runs on the offscreen platform, one JSON object per line on stdout:
+ **
+ **    {"bench":"tty-burst","frames":200,"fps":...,"p50_ns":...,
+ **     "p99_ns":...,"max_ns":...,"maxrss_kb":...}
+ **
+ **/
+#include <sys/resource.h>
+
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QScrollBar>
+
+#include "ComposerFrame.h"
+#include "LatencyHistogram.h"
+#include "MainWindow.h"
+#include "TtyWidget.h"
+
+using gyreui::ComposerFrame;
+using gyreui::LatencyHistogram;
+using gyreui::MainWindow;
+using gyreui::TtyWidget;
+
+namespace {
+
+const char* filter = nullptr;
+
+long maxRssKb() {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+#if defined(__APPLE__)
+  return usage.ru_maxrss / 1024;
+#else
+  return usage.ru_maxrss;
+#endif
+}
+
+/** * frame(i) prepares frame i and returns the widget to repaint **/
+void bench(const char* name, int frames, std::function<QWidget*(int)> frame) {
+  if (filter != nullptr && strstr(name, filter) == nullptr) return;
+
+  LatencyHistogram hist;
+  qint64 total = 0;
+  QElapsedTimer timer;
+
+  for (int i = 0; i < frames; ++i) {
+    auto widget = frame(i);
+
+    timer.start();
+    widget->repaint();
+    auto ns = timer.nsecsElapsed();
+
+    hist.record(ns);
+    total += ns;
+  }
+
+  printf(
+      "{\"bench\":\"%s\",\"frames\":%d,\"fps\":%.1f,\"p50_ns\":%llu,"
+      "\"p99_ns\":%llu,\"max_ns\":%llu,\"maxrss_kb\":%ld}\n",
+      name, frames, total ? frames * 1e9 / total : 0.0,
+      (unsigned long long)hist.percentile(0.50),
+      (unsigned long long)hist.percentile(0.99),
+      (unsigned long long)hist.max(), maxRssKb());
+  fflush(stdout);
+}
+
+QString line(int n, int width) {
+  QString text = QString("%1: ").arg(n);
+
+  while (text.size() < width) text += "(fixnum+ 1 2) ";
+
+  return text.left(width);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+
+  QApplication app(argc, argv);
+
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+      filter = argv[++i];
+    else {
+      fprintf(stderr, "usage: %s [--filter substring]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  auto tty = new TtyWidget(nullptr);
+  tty->resize(1200, 800);
+  tty->show();
+
+  auto vs = tty->verticalScrollBar();
+  auto hs = tty->horizontalScrollBar();
+
+  bench("tty-burst", 200, [tty, vs](int n) -> QWidget* {
+    for (int i = 0; i < 100; ++i) tty->writeTty(line(n * 100 + i, 80));
+    vs->setValue(vs->maximum());
+    return tty->viewport();
+  });
+
+  bench("tty-long-lines", 200, [tty, hs](int n) -> QWidget* {
+    if (n == 0)
+      for (int i = 0; i < 200; ++i) tty->writeTty(line(i, 4000));
+    hs->setValue((n * hs->pageStep()) % qMax(1, hs->maximum()));
+    return tty->viewport();
+  });
+
+  bench("tty-selection", 200, [tty, vs](int n) -> QWidget* {
+    auto top = vs->value() / tty->fontMetrics().height();
+
+    tty->setSelection(top + n % 10, n % 40, top + 30 + n % 10, 60 - n % 40);
+    return tty->viewport();
+  });
+
+  tty->clearSelection();
+
+  bench("tty-scroll", 500, [tty, vs](int n) -> QWidget* {
+    if (n == 0)
+      for (int i = 0; i < 20000; ++i) tty->writeTty(line(i, 100));
+    vs->setValue((n * vs->pageStep()) % qMax(1, vs->maximum()));
+    return tty->viewport();
+  });
+
+  MainWindow mw;
+  auto composer = new ComposerFrame("bench", &mw, tty->get_gyre());
+  composer->resize(1200, 800);
+  composer->show();
+
+  auto evalText = composer->findChild<QLabel*>("evalText");
+
+  QStringList result;
+  for (int i = 0; i < 20000; ++i) result << line(i, 100);
+  auto big = result.join("\n");
+
+  if (evalText != nullptr)
+    bench("composer-eval-text", 50, [composer, evalText, &big](int n) {
+      evalText->setText(big + QString::number(n));
+      return static_cast<QWidget*>(composer);
+    });
+
+  return 0;
+}
@@ -0,0 +1,13 @@
+CONFIG += console c++14
+CONFIG -= app_bundle
+
+DESTDIR = ../../../build/bench
+MOC_DIR = ../../../build/bench/render
+OBJECTS_DIR = ../../../build/bench/render
+TARGET = gyre-bench-render
+TEMPLATE = app
+
+include(../../ui/ui.pri)
+
+SOURCES += \
+           main.cpp
@@ -0,0 +1,165 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  main.cpp: GyreEnv read-eval-print benchmarks
+ **
+ **  one JSON object per line on stdout:
+ **
+ **    {"bench":"rep-fixnum","n":10000,"p50_ns":...,"p99_ns":...,
+ **     "max_ns":...,"mean_ns":...,"bytes_per_sec":...}
+ **
+ **/
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+
+#include <QString>
+
+#include "GyreEnv.h"
+#include "LatencyHistogram.h"
+#include "mu.h"
+
+using gyreui::GyreEnv;
+using gyreui::LatencyHistogram;
+using gyreui::Mu;
+
+namespace {
+
+typedef std::chrono::steady_clock steady;
+
+const char* filter = nullptr;
+int scale = 1;
+
+uint64_t nsecs(steady::duration d) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+}
+
+void report(const char* name, const LatencyHistogram& hist, uint64_t total,
+            uint64_t bytes) {
+  printf(
+      "{\"bench\":\"%s\",\"n\":%llu,\"p50_ns\":%llu,\"p99_ns\":%llu,"
+      "\"max_ns\":%llu,\"mean_ns\":%llu,\"bytes_per_sec\":%.0f}\n",
+      name, (unsigned long long)hist.count(),
+      (unsigned long long)hist.percentile(0.50),
+      (unsigned long long)hist.percentile(0.99),
+      (unsigned long long)hist.max(),
+      (unsigned long long)(hist.count() ? total / hist.count() : 0),
+      total ? bytes * 1e9 / total : 0.0);
+  fflush(stdout);
+}
+
+bool selected(const char* name) {
+  return filter == nullptr || strstr(name, filter) != nullptr;
+}
+
+/** * time n calls of fn, fn returns bytes processed **/
+void bench(const char* name, int n, std::function<uint64_t()> fn) {
+  if (!selected(name)) return;
+
+  LatencyHistogram hist;
+  uint64_t total = 0, bytes = 0;
+
+  for (int i = 0; i < n * scale; ++i) {
+    auto start = steady::now();
+    bytes += fn();
+    auto ns = nsecs(steady::now() - start);
+
+    hist.record(ns);
+    total += ns;
+  }
+
+  report(name, hist, total, bytes);
+}
+
+/** * time one rep phase using GyreEnv's own instrumentation **/
+void phase(const char* name, GyreEnv* env, QString form, int n,
+           uint64_t gyreui::RepTiming::*ns, size_t gyreui::RepTiming::*bytes) {
+  if (!selected(name)) return;
+
+  LatencyHistogram hist;
+  uint64_t total = 0, nbytes = 0;
+
+  for (int i = 0; i < n * scale; ++i) {
+    env->withException([env, form]() { (void)env->rep(form); });
+
+    auto timing = env->lastTiming();
+    hist.record(timing.*ns);
+    total += timing.*ns;
+    nbytes += timing.*bytes;
+  }
+
+  report(name, hist, total, nbytes);
+}
+
+QString bigList(int len) {
+  QString form("(:quote (");
+
+  for (int i = 0; i < len; ++i) form += QString::number(i) + " ";
+
+  return form + "))";
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--scale") && i + 1 < argc)
+      scale = std::max(1, atoi(argv[++i]));
+    else if (!strcmp(argv[i], "--filter") && i + 1 < argc)
+      filter = argv[++i];
+    else {
+      fprintf(stderr, "usage: %s [--scale n] [--filter substring]\n", argv[0]);
+      return 1;
+    }
+  }
+
+  bench("env-construct", 5, []() -> uint64_t {
+    delete new GyreEnv();
+    return 0;
+  });
+
+  auto env = new GyreEnv();
+
+  bench("rep-fixnum", 10000,
+        [env]() -> uint64_t { return env->rep("(fixnum+ 1 2)").size(); });
+
+  bench("rep-string", 10000,
+        [env]() -> uint64_t { return env->rep("\"gyre\"").size(); });
+
+  bench("rep-list", 10000,
+        [env]() -> uint64_t { return env->rep("(:quote (1 2 3 4))").size(); });
+
+  bench("mu-fixnum", 10000, []() -> uint64_t {
+    static Mu mu;
+    return mu.mu("(fixnum+ 1 2)").size();
+  });
+
+  bench("with-exception-empty", 10000, [env]() -> uint64_t {
+    return env->withException([]() {}).size();
+  });
+
+  bench("with-exception-rep", 10000, [env]() -> uint64_t {
+    QString out;
+    env->withException([env, &out]() { out = env->rep("(fixnum+ 1 2)"); });
+    return out.size();
+  });
+
+  auto big = bigList(100000);
+
+  phase("read-large", env, big, 10, &gyreui::RepTiming::read,
+        &gyreui::RepTiming::bytesIn);
+  phase("print-large", env, big, 10, &gyreui::RepTiming::print,
+        &gyreui::RepTiming::bytesOut);
+
+  return 0;
+}
@@ -0,0 +1,21 @@
+CONFIG += console c++14
+CONFIG -= app_bundle
+
+DESTDIR = ../../../build/bench
+INCLUDEPATH += ../../ui /opt/gyre/include
+LIBS += /opt/gyre/lib/libmu.a
+MOC_DIR = ../../../build/bench/rep
+OBJECTS_DIR = ../../../build/bench/rep
+TARGET = gyre-bench-rep
+TEMPLATE = app
+
+HEADERS += \
+           /opt/gyre/include/libmu/libmu.h \
+           ../../ui/GyreEnv.h          \
+           ../../ui/LatencyHistogram.h \
+           ../../ui/mu.h
+
+SOURCES += \
+           main.cpp
+
+QT = core
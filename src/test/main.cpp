@@ -0,0 +1,128 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  main.cpp: checks for the parts that don't need a gui or an env
+ **
+ **  a line per failed check on stdout, and a non-zero exit if any did.
+ **
+ **/
+#include <cstdio>
+
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QVector>
+
+#include "FormReader.h"
+#include "TrigramIndex.h"
+
+using gyreui::FormReader;
+using gyreui::TrigramIndex;
+
+namespace {
+
+int failed = 0;
+
+void check(bool ok, const char* what) {
+  if (ok) return;
+
+  printf("failed: %s\n", what);
+  failed++;
+}
+
+void literals() {
+  check(TrigramIndex::literals("a.b|c", false) == QStringList{"a.b|c"},
+        "literals: plain text is its own run");
+  check(TrigramIndex::literals("foo.*bar", true) ==
+            QStringList({"foo", "bar"}),
+        "literals: wildcards split runs");
+  check(TrigramIndex::literals("foo|bar", true).isEmpty(),
+        "literals: alternation gives up");
+  check(TrigramIndex::literals("colou?r", true) == QStringList({"colo", "r"}),
+        "literals: an optional character is dropped");
+  check(TrigramIndex::literals("\\(defun", true) == QStringList{"(defun"},
+        "literals: escaped punctuation is literal");
+  check(TrigramIndex::literals("[abc]def", true) == QStringList{"def"},
+        "literals: classes break runs");
+  check(TrigramIndex::literals("\\d+foo", true) == QStringList{"foo"},
+        "literals: letter escapes break runs");
+  check(TrigramIndex::literals("x{2,3}yz", true) == QStringList{"yz"},
+        "literals: counted repeats drop their character");
+}
+
+void forms() {
+  auto two = FormReader::forms("(a b) ; c\n(d \"e)\")");
+  check(two.size() == 2 && two[0].text == "(a b)" && two[0].line == 1 &&
+            two[1].text == "(d \"e)\")" && two[1].line == 2,
+        "forms: strings and comments don't end forms");
+
+  auto skipped = FormReader::forms("#| (x |#\n(y)");
+  check(skipped.size() == 1 && skipped[0].text == "(y)" &&
+            skipped[0].line == 2,
+        "forms: block comments are skipped");
+
+  auto chars = FormReader::forms("(#\\))");
+  check(chars.size() == 1 && chars[0].text == "(#\\))",
+        "forms: a character literal doesn't close a list");
+
+  auto marked = FormReader::forms("; @independent\n(x)\n(y)");
+  check(marked.size() == 2 && marked[0].independent && !marked[1].independent,
+        "forms: @independent marks the next form only");
+
+  auto open = 0;
+  auto some = FormReader::forms("(a)\n(b\n(c)", &open);
+  check(some.size() == 1 && open == 2,
+        "forms: an unterminated form stops the read at its line");
+
+  FormReader::forms("(a)", &open);
+  check(open == 0, "forms: a clean end is no unterminated form");
+
+  check(FormReader::complete("(a (b))") && !FormReader::complete("(a (b)"),
+        "forms: complete");
+}
+
+void index() {
+  QTemporaryDir dir;
+  auto path = dir.filePath("index");
+
+  QVector<TrigramIndex::File> files{{"a.l", 0, 9}, {"b.l", 0, 7}};
+  QVector<QByteArray> packed{
+      TrigramIndex::pack(TrigramIndex::trigrams("defun foo")),
+      TrigramIndex::pack(TrigramIndex::trigrams("bar baz"))};
+
+  TrigramIndex index;
+  check(TrigramIndex::write(path, "/root", files, packed) && index.open(path),
+        "index: written and mapped");
+  if (index.files() != 2) return;
+
+  check(index.root() == "/root" && index.file(1).path == "b.l",
+        "index: root and paths");
+  check(index.candidates(TrigramIndex::trigrams("foo")) ==
+            QVector<quint32>{0},
+        "index: a trigram in one file");
+  check(index.candidates(TrigramIndex::trigrams("DEFUN")) ==
+            QVector<quint32>{0},
+        "index: trigrams are case folded");
+  check(index.candidates(TrigramIndex::trigrams("ba")) ==
+            QVector<quint32>({0, 1}),
+        "index: no trigrams, every file");
+  check(index.candidates(TrigramIndex::trigrams("fox")).isEmpty(),
+        "index: a missing trigram, no files");
+}
+
+}  // namespace
+
+int main() {
+  literals();
+  forms();
+  index();
+
+  printf("%s\n", failed == 0 ? "ok" : "FAILED");
+  return failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+CONFIG += console c++14
+CONFIG -= app_bundle
+
+DESTDIR = ../../build/test
+INCLUDEPATH += ../ui
+OBJECTS_DIR = ../../build/test
+TARGET = gyre-test
+TEMPLATE = app
+
+HEADERS += \
+           ../ui/FormReader.h   \
+           ../ui/TrigramIndex.h
+
+SOURCES += \
+           ../ui/TrigramIndex.cpp \
+           main.cpp
+
+QT = core
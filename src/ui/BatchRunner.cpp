@@ -0,0 +1,162 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  BatchRunner.cpp: headless batch evaluation implementation
+ **
+ **/
+#include "BatchRunner.h"
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include <thread>
+
+#include <QFile>
+#include <QTextStream>
+
+namespace gyreui {
+
+bool BatchRunner::isBatch(int argc, char** argv) {
+  for (int i = 1; i < argc; ++i)
+    if (!strcmp(argv[i], "--batch")) return true;
+
+  return false;
+}
+
+void BatchRunner::output(FILE* stream, QString text) {
+  if (text.isEmpty()) return;
+
+  auto bytes = text.toUtf8();
+
+  std::lock_guard<std::mutex> lock(outputLock);
+  fwrite(bytes.data(), 1, bytes.size(), stream);
+  if (!text.endsWith('\n')) fputc('\n', stream);
+  fflush(stream);
+}
+
+/** * evaluate forms one at a time so results stream as they happen **/
+bool BatchRunner::evalForms(GyreEnv* env,
+                            const QVector<FormReader::Form>& forms,
+                            QString origin, bool echo) {
+  bool ok = true;
+
+  for (auto& form : forms) {
+    QString out;
+
+    auto error = env->withException(
+        [env, &form, &out]() { out = env->rep(form.text); });
+
+    if (echo) output(stdout, out);
+    if (error.size() > 1) {
+      if (echo)
+        output(stderr,
+               QString("%1:%2: %3").arg(origin).arg(form.line).arg(error));
+      ok = false;
+    }
+  }
+
+  return ok;
+}
+
+/** * the forms of text, reporting one left open at the end **/
+QVector<FormReader::Form> BatchRunner::readForms(const QString& text,
+                                                 QString origin,
+                                                 std::atomic<bool>& ok) {
+  int unterminated;
+  auto forms = FormReader::forms(text, &unterminated);
+
+  if (unterminated > 0) {
+    output(stderr,
+           QString("%1:%2: unterminated form").arg(origin).arg(unterminated));
+    ok = false;
+  }
+
+  return forms;
+}
+
+/** * dependent forms run in order, @independent forms on any worker **/
+void BatchRunner::submitFile(EnvPool& pool, QString path,
+                             std::atomic<bool>& ok) {
+  QFile f(path);
+
+  if (!f.open(QFile::ReadOnly | QFile::Text)) {
+    output(stderr, QString("gyre-ui: cannot open %1").arg(path));
+    ok = false;
+    return;
+  }
+
+  QTextStream in(&f);
+  QVector<FormReader::Form> dependent;
+  QVector<FormReader::Form> independent;
+
+  for (auto& form : readForms(in.readAll(), path, ok))
+    (form.independent ? independent : dependent).push_back(form);
+
+  /* the dependent forms are reported wherever they run. a worker that
+     ran them has no need to prepare its env silently for the rest */
+  auto prep = path + "#prep";
+
+  pool.submit([this, path, prep, dependent, &ok](GyreEnv* env) {
+    if (!evalForms(env, dependent, path, true)) ok = false;
+    EnvPool::mark(env, prep);
+  });
+
+  for (auto& form : independent)
+    pool.submit([this, path, prep, dependent, form, &ok](GyreEnv* env) {
+      EnvPool::once(env, prep, [&](GyreEnv* worker) {
+        (void)evalForms(worker, dependent, path, false);
+      });
+
+      if (!evalForms(env, {form}, path, true)) ok = false;
+    });
+}
+
+GyreEnv* BatchRunner::makeEnv() {
+  return config ? EnvPool::configuredEnv() : new GyreEnv();
+}
+
+int BatchRunner::run() {
+  std::atomic<bool> ok(true);
+
+  if (files.isEmpty()) {
+    QTextStream in(stdin);
+    auto forms = readForms(in.readAll(), "<stdin>", ok);
+
+    return evalForms(makeEnv(), forms, "<stdin>", true) && ok ? 0 : 1;
+  }
+
+  /* workers make their env on their first job, so one file's
+     @independent forms can spread over all of them */
+  EnvPool pool(jobs, [this]() { return makeEnv(); });
+
+  for (auto& path : files) submitFile(pool, path, ok);
+  pool.wait();
+
+  return ok ? 0 : 1;
+}
+
+BatchRunner::BatchRunner(int argc, char** argv) : jobs(1), config(true) {
+  for (int i = 1; i < argc; ++i) {
+    if (!strcmp(argv[i], "--batch"))
+      continue;
+    else if (!strcmp(argv[i], "--no-config"))
+      config = false;
+    else if (!strcmp(argv[i], "-j") && i + 1 < argc && isdigit(*argv[i + 1]))
+      jobs = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "-j"))
+      jobs = std::thread::hardware_concurrency();
+    else
+      files << QString::fromLocal8Bit(argv[i]);
+  }
+}
+
+}  // namespace gyreui
@@ -0,0 +1,56 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  BatchRunner.h: headless batch evaluation
+ **
+ **/
+#ifndef GYREUI_UI_BATCHRUNNER_H_
+#define GYREUI_UI_BATCHRUNNER_H_
+
+#include <atomic>
+#include <mutex>
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "EnvPool.h"
+#include "FormReader.h"
+#include "GyreEnv.h"
+
+namespace gyreui {
+
+/** * gyre-ui --batch [-j [n]] [--no-config] [file ...] **/
+class BatchRunner {
+ public:
+  static bool isBatch(int, char**);
+
+  int run();
+
+  BatchRunner(int, char**);
+
+ private:
+  GyreEnv* makeEnv();
+  bool evalForms(GyreEnv*, const QVector<FormReader::Form>&, QString, bool);
+  QVector<FormReader::Form> readForms(const QString&, QString,
+                                      std::atomic<bool>&);
+  void submitFile(EnvPool&, QString, std::atomic<bool>&);
+
+  void output(FILE*, QString);
+
+  int jobs;
+  bool config;
+  QStringList files;
+  std::mutex outputLock;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_BATCHRUNNER_H_ */
@@ -0,0 +1,227 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Completer.cpp: symbol completion service implementation
+ **
+ **  libmu can only be asked about its symbols from the thread that owns
+ **  the env. the first time a completion is asked for after an eval, a
+ **  walk of the env's namespaces starts there, SLICE names at a time
+ **  from a zero timer, so typing never waits on more than one slice.
+ **  each slice is sorted and merged into the index on the worker, which
+ **  also answers the queries. an eval during a walk starts another once
+ **  it's done, a walk that fails is started over by the next query.
+ **
+ **/
+#include "Completer.h"
+
+#include <algorithm>
+
+#include <QCoreApplication>
+#include <QMetaObject>
+#include <QTimer>
+
+namespace gyreui {
+
+namespace {
+
+/* the reader's and the core forms' keywords, which aren't interned */
+const char* const KEYWORDS[] = {
+    ":char",   ":cons",     ":default", ":defcon",  ":defmacro", ":defsym",
+    ":fixnum", ":float",    ":func",    ":keyword", ":lambda",   ":macro",
+    ":nil",    ":ns",       ":quote",   ":stream",  ":string",   ":struct",
+    ":symbol", ":t",        ":vector"};
+
+QHash<GyreEnv*, Completer*>& completers() {
+  static QHash<GyreEnv*, Completer*> registry;
+
+  return registry;
+}
+
+}  // namespace
+
+Completer* Completer::forEnv(GyreEnv* env) {
+  auto completer = completers().value(env);
+  if (completer == nullptr) {
+    completer = new Completer(env);
+    completers().insert(env, completer);
+  }
+
+  return completer;
+}
+
+/** * the env is going away, pending replies still hold the index **/
+void Completer::release(GyreEnv* env) { delete completers().take(env); }
+
+bool Completer::isSymbolChar(QChar ch) {
+  return !ch.isSpace() && ch != '(' && ch != ')' && ch != '"' && ch != '\'' &&
+         ch != '`' && ch != ',' && ch != ';';
+}
+
+/** * the partial symbol ending at pos **/
+QString Completer::prefixOf(const QString& text, int pos) {
+  int start = pos;
+
+  while (start > 0 && isSymbolChar(text[start - 1])) --start;
+
+  return text.mid(start, pos - start);
+}
+
+std::shared_ptr<const Completer::Index> Completer::snapshot() {
+  return std::atomic_load(&index);
+}
+
+void Completer::post(std::function<void()> task) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  tasks.push_back(std::move(task));
+  ready.notify_one();
+}
+
+/** * names merged into a fresh index, readers keep whatever snapshot
+      they hold **/
+void Completer::merge(QStringList names) {
+  Index slice;
+
+  slice.reserve(names.size());
+  for (auto& name : names)
+    if (!name.startsWith("%gyre-")) slice.push_back(name);
+
+  std::sort(slice.begin(), slice.end());
+
+  auto current = snapshot();
+  auto fresh = std::make_shared<Index>();
+
+  fresh->reserve(current->size() + slice.size());
+  std::merge(current->begin(), current->end(), slice.begin(), slice.end(),
+             std::back_inserter(*fresh));
+  fresh->erase(std::unique(fresh->begin(), fresh->end()), fresh->end());
+
+  std::atomic_store(&index, std::shared_ptr<const Index>(fresh));
+}
+
+/** * a walk of the env's symbols, if an eval since the last one may have
+      interned more and none is under way **/
+void Completer::refresh() {
+  if (walk || env->generation() == seen) return;
+
+  walking = env->generation();
+  auto error = env->withException([this]() {
+    env->call("(:defsym %gyre-completing (%gyre-cursor (ns-current)))");
+  });
+  if (!error.isEmpty()) return;
+
+  walk = true;
+  QTimer::singleShot(0, timers.get(), [this]() { step(); });
+}
+
+/** * the next slice. seen only moves once the walk is through **/
+void Completer::step() {
+  QString names;
+  QString done;
+
+  auto error = env->withException([this, &names, &done]() {
+    env->call(QString("(:defsym %gyre-completed "
+                      "(%gyre-symbol-slice %gyre-completing %1))")
+                  .arg(SLICE));
+    names = env->call("(car %gyre-completed)");
+    env->call("(:defsym %gyre-completing (cdr %gyre-completed))");
+    done = env->call("(null %gyre-completing)");
+  });
+
+  if (!error.isEmpty()) {
+    walk = false;
+    return;
+  }
+
+  auto list = names.split('\n', QString::SkipEmptyParts);
+  post([this, list]() { merge(list); });
+
+  if (done == ":t") {
+    seen = walking;
+    walk = false;
+    return;
+  }
+
+  QTimer::singleShot(0, timers.get(), [this]() { step(); });
+}
+
+QStringList Completer::completeNow(QString prefix) {
+  auto current = snapshot();
+  QStringList out;
+
+  for (auto it = std::lower_bound(current->begin(), current->end(), prefix);
+       it != current->end() && it->startsWith(prefix) &&
+       out.size() < MAX_COMPLETIONS;
+       ++it)
+    out << *it;
+
+  return out;
+}
+
+/** * reply runs on the gui thread, dropped if receiver is gone by then **/
+void Completer::complete(QString prefix, QObject* receiver, Reply reply) {
+  QPointer<QObject> target(receiver);
+
+  refresh();
+
+  post([this, prefix, target, reply]() {
+    auto matches = completeNow(prefix);
+
+    QMetaObject::invokeMethod(
+        QCoreApplication::instance(),
+        [prefix, matches, target, reply]() {
+          if (target) reply(prefix, matches);
+        },
+        Qt::QueuedConnection);
+  });
+}
+
+void Completer::run() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      ready.wait(guard, [this]() { return stopping || !tasks.empty(); });
+      if (stopping) return;
+
+      task = std::move(tasks.front());
+      tasks.pop_front();
+    }
+
+    task();
+  }
+}
+
+Completer::Completer(GyreEnv* env)
+    : env(env),
+      seen(~quint64(0)),
+      walking(0),
+      walk(false),
+      timers(new QObject()),
+      index(std::shared_ptr<const Index>(new Index())),
+      stopping(false) {
+  QStringList keywords;
+  for (auto keyword : KEYWORDS) keywords << keyword;
+
+  merge(keywords);
+  worker = std::thread([this]() { run(); });
+}
+
+Completer::~Completer() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+    ready.notify_one();
+  }
+
+  worker.join();
+}
+
+}  // namespace gyreui
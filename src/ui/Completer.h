@@ -0,0 +1,83 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Completer.h: symbol completion service
+ **
+ **/
+#ifndef GYREUI_UI_COMPLETER_H_
+#define GYREUI_UI_COMPLETER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+
+#include "GyreEnv.h"
+
+namespace gyreui {
+
+/** * sorted symbol index per env, read from the env a slice at a time on
+      the gui thread when it's idle, merged and queried off it **/
+class Completer {
+ public:
+  typedef std::function<void(QString, QStringList)> Reply;
+
+  static const int MAX_COMPLETIONS = 200;
+  static const int SLICE = 1024;
+
+  static Completer* forEnv(GyreEnv*);
+  static void release(GyreEnv*);
+
+  static bool isSymbolChar(QChar);
+  static QString prefixOf(const QString&, int);
+
+  void refresh();
+  void complete(QString, QObject*, Reply);
+  QStringList completeNow(QString);
+
+  ~Completer();
+
+ private:
+  typedef std::vector<QString> Index;
+
+  explicit Completer(GyreEnv*);
+
+  void post(std::function<void()>);
+  void step();
+  void merge(QStringList);
+  void run();
+
+  std::shared_ptr<const Index> snapshot();
+
+  GyreEnv* env;
+  quint64 seen;
+  quint64 walking;
+  bool walk;
+  std::unique_ptr<QObject> timers;
+  std::shared_ptr<const Index> index;
+  std::mutex lock;
+  std::condition_variable ready;
+  std::deque<std::function<void()>> tasks;
+  bool stopping;
+  std::thread worker;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_COMPLETER_H_ */
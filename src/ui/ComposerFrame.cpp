@@ -11,8 +11,10 @@
  **  ComposerFrame.cpp: ComposerFrame implementation
  **
  **/
+#include <QElapsedTimer>
 #include <QFileDialog>
 #include <QLabel>
+#include <QMenu>
 #include <QSplitter>
 #include <QString>
 #include <QTextEdit>
@@ -21,26 +23,135 @@
 
 #include "ComposerFrame.h"
 #include "GyreEnv.h"
+#include "MacroExpander.h"
+#include "Profiler.h"
+#include "Watchdog.h"
+#include "XrefIndex.h"
 
 namespace gyreui {
 
 void ComposerFrame::clear() {
   editText->setText("");
-  evalText->setText("");
+  evalText->setResult("");
+}
+
+/** * complete the symbol before the cursor, ctrl-space **/
+void ComposerFrame::complete() {
+  auto cursor = editText->textCursor();
+  auto block = cursor.block().text();
+  auto prefix = Completer::prefixOf(block, cursor.positionInBlock());
+
+  if (prefix.isEmpty()) return;
+
+  Completer::forEnv(devEnv)->complete(
+      prefix, this, [this](QString prefix, QStringList matches) {
+        auto cursor = editText->textCursor();
+        if (matches.isEmpty() ||
+            prefix != Completer::prefixOf(cursor.block().text(),
+                                          cursor.positionInBlock()))
+          return;
+
+        static_cast<QStringListModel*>(completer->model())
+            ->setStringList(matches);
+        completer->setCompletionPrefix(prefix);
+
+        auto popup = completer->popup();
+        auto rect = editText->cursorRect();
+        rect.setWidth(popup->sizeHintForColumn(0) +
+                      popup->verticalScrollBar()->sizeHint().width());
+        completer->complete(rect);
+      });
+}
+
+void ComposerFrame::insertCompletion(const QString& completion) {
+  auto cursor = editText->textCursor();
+  auto prefix =
+      Completer::prefixOf(cursor.block().text(), cursor.positionInBlock());
+
+  cursor.insertText(completion.mid(prefix.size()));
+  editText->setTextCursor(cursor);
 }
 
 void ComposerFrame::load() {
-  loadFileName = QFileDialog::getOpenFileName(
-      this, tr("Load File"), mw->userInfo()->userdir(), tr("File (*)"));
+  loadFile(QFileDialog::getOpenFileName(
+      this, tr("Load File"), mw->userInfo()->userdir(), tr("File (*)")));
+}
+
+/** * the buffer becomes path's, saves go back to it **/
+bool ComposerFrame::loadFile(QString path) {
+  loadFileName = path;
+  saveFileName = loadFileName;
+  LayoutStore::instance()->changed();
 
   QFile f(loadFileName);
-  if (f.open(QFile::ReadOnly | QFile::Text)) {
-    QTextStream in(&f);
-    editText->setText(in.readAll());
-    f.close();
+  if (!f.open(QFile::ReadOnly | QFile::Text)) return false;
+
+  QTextStream in(&f);
+  editText->setText(in.readAll());
+  editText->document()->setModified(false);
+  f.close();
+
+  track(loadFileName);
+  return true;
+}
+
+/** * mu source opened here is cross referenced, just the file. opening
+      one doesn't make wherever it lives a tree to walk **/
+void ComposerFrame::track(QString path) {
+  if (path.endsWith(".l")) XrefIndex::instance()->addFile(path);
+}
+
+/** * lines count from 1, the scroll waits for the layout **/
+void ComposerFrame::gotoLine(int line) {
+  auto block = editText->document()->findBlockByNumber(qMax(0, line - 1));
+
+  editText->setTextCursor(QTextCursor(block));
+  editText->setFocus();
+
+  QTimer::singleShot(0, editText,
+                     [this]() { editText->ensureCursorVisible(); });
+}
+
+/** * the file alone when the buffer still matches it **/
+QJsonObject ComposerFrame::saveState() const {
+  QJsonObject state{{"cursor", editText->textCursor().position()},
+                    {"scroll", editText->verticalScrollBar()->value()},
+                    {"limits", QJsonArray{printLevel, printLength}}};
+
+  if (!saveFileName.isEmpty()) state["file"] = saveFileName;
+  if (saveFileName.isEmpty() || editText->document()->isModified())
+    state["text"] = editText->toPlainText();
+
+  return state;
+}
+
+void ComposerFrame::restoreState(const QJsonObject& state) {
+  if (state.contains("limits")) {
+    auto limits = state["limits"].toArray();
+
+    printLevel = qMax(1, limits[0].toInt());
+    printLength = qMax(1, limits[1].toInt());
+    devEnv->setPrintLimits(printLevel, printLength);
   }
 
-  saveFileName = loadFileName;
+  if (state.contains("text")) {
+    loadFileName = saveFileName = state["file"].toString();
+    editText->setPlainText(state["text"].toString());
+    editText->document()->setModified(true);
+  } else if (!loadFile(state["file"].toString())) {
+    log(";;; composer: can't reopen " + loadFileName);
+  }
+
+  auto cursor = editText->textCursor();
+  cursor.setPosition(qMin(state["cursor"].toInt(),
+                          editText->document()->characterCount() - 1));
+  editText->setTextCursor(cursor);
+
+  /* the scroll range isn't known until the text is laid out */
+  auto scroll = state["scroll"].toInt();
+  QTimer::singleShot(0, editText, [this, scroll]() {
+    editText->verticalScrollBar()->setValue(scroll);
+  });
 }
 
 void ComposerFrame::eval() {
@@ -48,26 +159,32 @@ void ComposerFrame::eval() {
 
   mw->setContextStatus(tr("eval"));
 
-  auto error = devEnv->withException(
-      [this, &out]() { out = devEnv->rep(editText->toPlainText()); });
+  Profiler::Scope profile;
+  Watchdog::Scope watch(name + " eval", editText->toPlainText());
+  auto error = devEnv->withException([this, &out]() {
+    out = devEnv->rep(editText->toPlainText(), GyreEnv::MARKED);
+  });
 
-  evalText->setText(out + error);
+  evalText->setResult(out + error);
 
   emit evalHappened(editText->toPlainText());
 }
 
+/** * the selection or the buffer, expanded here and in the browser **/
 void ComposerFrame::macroexpand() {
-  QString out;
+  auto cursor = editText->textCursor();
+  auto form = cursor.hasSelection()
+                  ? cursor.selectedText().replace(QChar::ParagraphSeparator,
+                                                  '\n')
+                  : editText->toPlainText();
 
   mw->setContextStatus(tr("macroexpand"));
 
-  auto error = devEnv->withException([this, &out]() {
-    auto mex = "(macroexpand (:quote " + editText->toPlainText() + "))";
+  Watchdog::Scope watch(name + " macroexpand", form);
+  auto expansion = MacroExpander::forEnv(devEnv)->expand(form, false);
 
-    out = devEnv->rep(mex);
-  });
-
-  evalText->setText(out + error);
+  evalText->setResult(expansion.text + expansion.error);
+  emit expandForm(form);
 }
 
 void ComposerFrame::describe() {
@@ -75,16 +192,104 @@ void ComposerFrame::describe() {
 
   mw->setContextStatus(tr("describe"));
 
+  Watchdog::Scope watch(name + " describe", editText->toPlainText());
   auto error = devEnv->withException([this, &out]() {
     auto mex = "(describe (:quote " + editText->toPlainText() + "))";
 
-    out = devEnv->rep(mex);
+    /* a description isn't a result, * and the history stay the user's */
+    out = devEnv->rep(mex, GyreEnv::ELIDED, GyreEnv::UNHELD);
   });
 
-  evalText->setText(out + error);
+  evalText->setResult(out + error);
 }
 
-void ComposerFrame::reset() { devEnv = new GyreEnv(); }
+/** * where the symbol under the cursor is defined, F12 **/
+void ComposerFrame::definition() { xref(false); }
+
+/** * where it's called from, shift-F12 **/
+void ComposerFrame::callers() { xref(true); }
+
+/** * a lone definition is jumped to, otherwise the sites are offered **/
+void ComposerFrame::xref(bool calls) {
+  auto cursor = editText->textCursor();
+  auto symbol =
+      XrefIndex::symbolAt(cursor.block().text(), cursor.positionInBlock());
+
+  if (symbol.isEmpty()) return;
+
+  auto index = XrefIndex::instance();
+
+  QElapsedTimer timer;
+  timer.start();
+  auto refs = calls ? index->callers(symbol) : index->definitions(symbol);
+  auto usecs = timer.nsecsElapsed() / 1000.0;
+
+  QStringList lines{QString(";;; %1: %2 %3, %4us (%5)")
+                        .arg(symbol)
+                        .arg(refs.size())
+                        .arg(calls ? "call sites" : "definitions")
+                        .arg(usecs, 0, 'f', 1)
+                        .arg(index->status())};
+
+  for (auto& ref : refs) {
+    auto& site = ref.site;
+    auto what = site.kind == XrefIndex::CALL
+                    ? (site.scope.isEmpty() ? "top level" : "in " + site.scope)
+                    : (site.kind == XrefIndex::FUNCTION ? "function"
+                                                        : "constant");
+
+    lines << QString("%1:%2: %3").arg(ref.path).arg(site.line).arg(what);
+  }
+
+  evalText->setResult(lines.join('\n'));
+
+  if (refs.size() == 1 && !calls) {
+    visit(refs[0]);
+  } else if (!refs.isEmpty()) {
+    QMenu menu;
+
+    for (int n = 0; n < refs.size(); ++n) {
+      auto ref = refs[n];
+      menu.addAction(lines[n + 1], [this, ref]() { visit(ref); });
+    }
+
+    menu.exec(editText->viewport()->mapToGlobal(
+        editText->cursorRect().bottomLeft()));
+  }
+}
+
+/** * in this buffer if it's the file, otherwise in a new composer **/
+void ComposerFrame::visit(const XrefIndex::Ref& ref) {
+  if (ref.path == saveFileName)
+    gotoLine(ref.site.line);
+  else
+    emit openFile(ref.path, ref.site.line);
+}
+
+/** * how deep and how long results print before they're cut off **/
+void ComposerFrame::limits() {
+  auto ok = false;
+  auto text = QInputDialog::getText(
+      this, tr("Print Limits"), tr("level and length:"), QLineEdit::Normal,
+      QString("%1 %2").arg(printLevel).arg(printLength), &ok);
+  auto fields = text.split(' ', QString::SkipEmptyParts);
+
+  if (!ok || fields.size() != 2 || fields[0].toInt() < 1 ||
+      fields[1].toInt() < 1)
+    return;
+
+  printLevel = fields[0].toInt();
+  printLength = fields[1].toInt();
+  devEnv->setPrintLimits(printLevel, printLength);
+
+  LayoutStore::instance()->changed();
+}
+
+void ComposerFrame::reset() {
+  devEnv = new GyreEnv();
+  devEnv->setPrintLimits(printLevel, printLength);
+  evalText->setEnv(devEnv);
+}
 
 void ComposerFrame::del() {}
 
@@ -100,7 +305,12 @@ void ComposerFrame::save() {
   QSaveFile file(saveFileName);
   file.open(QIODevice::WriteOnly);
   file.write(text.toUtf8());
-  file.commit();
+  if (file.commit()) {
+    editText->document()->setModified(false);
+    track(saveFileName);
+  }
+
+  LayoutStore::instance()->changed();
 }
 
 bool ComposerFrame::eventFilter(QObject *watched, QEvent *event) {
@@ -116,7 +326,11 @@ bool ComposerFrame::eventFilter(QObject *watched, QEvent *event) {
 }
 
 ComposerFrame::ComposerFrame(QString name, MainWindow *vf, GyreEnv *cn)
-    : mw(vf), devEnv(cn), name(name) {
+    : mw(vf),
+      devEnv(cn),
+      name(name),
+      printLevel(GyreEnv::PRINT_LEVEL),
+      printLength(GyreEnv::PRINT_LENGTH) {
   auto size = this->frameSize();
 
   toolBar = new QToolBar();
@@ -130,6 +344,12 @@ ComposerFrame::ComposerFrame(QString name, MainWindow *vf, GyreEnv *cn)
           &ComposerFrame::describe);
   connect(toolBar->addAction(tr("macroexpand")), &QAction::triggered, this,
           &ComposerFrame::macroexpand);
+  connect(toolBar->addAction(tr("definition")), &QAction::triggered, this,
+          &ComposerFrame::definition);
+  connect(toolBar->addAction(tr("callers")), &QAction::triggered, this,
+          &ComposerFrame::callers);
+  connect(toolBar->addAction(tr("limits")), &QAction::triggered, this,
+          &ComposerFrame::limits);
   connect(toolBar->addAction(tr("reset")), &QAction::triggered, this,
           &ComposerFrame::reset);
   connect(toolBar->addAction(tr("save")), &QAction::triggered, this,
@@ -141,17 +361,41 @@ ComposerFrame::ComposerFrame(QString name, MainWindow *vf, GyreEnv *cn)
 
   editText = new QTextEdit();
   editText->setMouseTracking(true);
+
+  auto store = LayoutStore::instance();
+  connect(editText, &QTextEdit::textChanged, store, &LayoutStore::changed);
+  connect(editText, &QTextEdit::cursorPositionChanged, store,
+          &LayoutStore::changed);
+  connect(editText->verticalScrollBar(), &QScrollBar::valueChanged, store,
+          &LayoutStore::changed);
+  connect(new QShortcut(QKeySequence(tr("Ctrl+Space")), editText, nullptr,
+                        nullptr, Qt::WidgetShortcut),
+          &QShortcut::activated, this, &ComposerFrame::complete);
+  connect(new QShortcut(QKeySequence(tr("F12")), editText, nullptr, nullptr,
+                        Qt::WidgetShortcut),
+          &QShortcut::activated, this, &ComposerFrame::definition);
+  connect(new QShortcut(QKeySequence(tr("Shift+F12")), editText, nullptr,
+                        nullptr, Qt::WidgetShortcut),
+          &QShortcut::activated, this, &ComposerFrame::callers);
+
+  completer = new QCompleter(this);
+  completer->setWidget(editText);
+  completer->setModel(new QStringListModel(completer));
+  completer->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+  connect(completer, QOverload<const QString&>::of(&QCompleter::activated),
+          this, &ComposerFrame::insertCompletion);
+
   editScroll = new QScrollArea();
   editScroll->setWidget(editText);
   editScroll->setWidgetResizable(true);
   editScroll->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
   editScroll->installEventFilter(this);
 
-  evalText = new QLabel();
+  evalText = new ResultView(devEnv);
+  evalText->setObjectName("evalText");
   evalText->setMargin(3);
   evalText->setAlignment(Qt::AlignTop);
   evalText->setMouseTracking(true);
-  evalText->setTextInteractionFlags(Qt::TextSelectableByMouse);
   evalScroll = new QScrollArea();
   evalScroll->setWidget(evalText);
   evalScroll->setWidgetResizable(true);
@@ -14,6 +14,7 @@
 #ifndef GYREUI_UI_COMPOSERFRAME_H_
 #define GYREUI_UI_COMPOSERFRAME_H_
 
+#include <QCompleter>
 #include <QFrame>
 #include <QLabel>
 #include <QScrollArea>
@@ -21,8 +22,12 @@
 #include <QToolBar>
 #include <QWidget>
 
+#include "Completer.h"
 #include "GyreEnv.h"
+#include "Layout.h"
 #include "MainWindow.h"
+#include "ResultView.h"
+#include "XrefIndex.h"
 
 QT_BEGIN_NAMESPACE
 class QLabel;
@@ -38,20 +43,36 @@ namespace gyreui {
 class MainWindow;
 class MainWindow;
 
-class ComposerFrame : public QFrame {
+class ComposerFrame : public QFrame, public FrameState {
   Q_OBJECT
 
  public:
   explicit ComposerFrame(QString, MainWindow*, GyreEnv*);
 
+  bool loadFile(QString);
+  void gotoLine(int);
+
+  QJsonObject saveState() const override;
+  void restoreState(const QJsonObject&) override;
+
  signals:
   void evalHappened(QString);
+  void openFile(QString, int);
+  void expandForm(QString);
 
  private:
   void clear();
+  void complete();
+  void insertCompletion(const QString&);
   void describe();
   void eval();
   void macroexpand();
+  void definition();
+  void callers();
+  void xref(bool);
+  void visit(const XrefIndex::Ref&);
+  void track(QString);
+  void limits();
   void load();
   void reset();
   void save();
@@ -76,8 +97,11 @@ class ComposerFrame : public QFrame {
   MainWindow* mw;
   GyreEnv* devEnv;
   QString name;
+  int printLevel;
+  int printLength;
+  QCompleter* completer;
   QTextEdit* editText;
-  QLabel* evalText;
+  ResultView* evalText;
   QToolBar* toolBar;
   QScrollArea* editScroll;
   QScrollArea* evalScroll;
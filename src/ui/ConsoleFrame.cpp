@@ -25,18 +25,118 @@ void ConsoleFrame::showEvent(QShowEvent* event) {
   mw->setContextStatus(name);
 }
 
+/** * rebuilt every time it opens. sessions come and go, a sweep can take
+      one while the menu is up, so actions find theirs by id **/
+void ConsoleFrame::sessionMenu() {
+  auto manager = SessionManager::instance();
+  auto current = ttyWidget->session();
+
+  sessions->clear();
+
+  sessions->addAction(tr("&new"), [this, manager]() {
+    ttyWidget->attach(manager->create());
+  });
+  sessions->addAction(tr("new on this &env"), [this, manager]() {
+    ttyWidget->attach(manager->create(ttyWidget->session()));
+  });
+  sessions->addAction(tr("&rename..."), this, &ConsoleFrame::rename);
+  sessions->addSeparator();
+
+  for (auto session : manager->sessions()) {
+    if (session == current) continue;
+
+    auto label = session->name;
+    if (session->tty != nullptr) label += tr(" (attached)");
+    if (!session->hasEnv()) label += tr(" (released)");
+
+    auto id = session->id;
+    sessions->addAction(tr("attach %1").arg(label), [this, manager, id]() {
+      if (auto session = manager->find(id)) ttyWidget->attach(session);
+    });
+  }
+}
+
+void ConsoleFrame::sessionChanged() {
+  auto session = ttyWidget->session();
+  if (session == nullptr) return;
+
+  QStringList sharing;
+  for (auto other : SessionManager::instance()->sessions())
+    if (session->sharesEnv(other)) sharing << other->name;
+
+  auto label = session->name;
+  if (!sharing.isEmpty())
+    label = tr("%1, env shared with %2").arg(label, sharing.join(", "));
+
+  sessionLabel->setText(label);
+  LayoutStore::instance()->changed();
+}
+
+/** * the session by name, envs don't outlive the process **/
+QJsonObject ConsoleFrame::saveState() const {
+  return QJsonObject{{"session", ttyWidget->session()->name}};
+}
+
+void ConsoleFrame::restoreState(const QJsonObject& state) {
+  auto manager = SessionManager::instance();
+  auto name = state["session"].toString();
+
+  for (auto session : manager->sessions())
+    if (session->name == name && session->tty == nullptr) {
+      ttyWidget->attach(session);
+      return;
+    }
+
+  manager->rename(ttyWidget->session(), name);
+}
+
+void ConsoleFrame::rename() {
+  auto session = ttyWidget->session();
+  auto ok = false;
+
+  auto text = QInputDialog::getText(this, tr("Rename Session"), tr("name:"),
+                                    QLineEdit::Normal, session->name, &ok);
+  if (ok) SessionManager::instance()->rename(session, text);
+}
+
 ConsoleFrame::ConsoleFrame(QString name, MainWindow* mw) : mw(mw), name(name) {
   ttyWidget = new TtyWidget(this);
 
+  toolBar = new QToolBar();
+
+  auto sessionButton = new QToolButton(toolBar);
+  sessionButton->setToolButtonStyle(Qt::ToolButtonTextOnly);
+  sessionButton->setText(tr("session"));
+  sessionButton->setPopupMode(QToolButton::InstantPopup);
+
+  sessions = new QMenu(sessionButton);
+  sessionButton->setMenu(sessions);
+  connect(sessions, &QMenu::aboutToShow, this, &ConsoleFrame::sessionMenu);
+
+  toolBar->addWidget(sessionButton);
+
+  sessionLabel = new QLabel();
+  toolBar->addWidget(sessionLabel);
+
+  connect(SessionManager::instance(), &SessionManager::sessionsChanged, this,
+          &ConsoleFrame::sessionChanged);
+  sessionChanged();
+
   QSizePolicy tty_policy = ttyWidget->sizePolicy();
   tty_policy.setVerticalStretch(1);
   ttyWidget->setSizePolicy(tty_policy);
 
   layout = new QVBoxLayout;
   layout->setContentsMargins(5, 5, 5, 5);
+  layout->addWidget(toolBar);
   layout->addWidget(ttyWidget);
 
   setLayout(layout);
 }
 
+/** * the console detaches as it goes, don't hear about it half destroyed **/
+ConsoleFrame::~ConsoleFrame() {
+  disconnect(SessionManager::instance(), nullptr, this, nullptr);
+}
+
 } /* namespace gyreui */
@@ -15,9 +15,12 @@
 #define GYREUI_UI_CONSOLEFRAME_H_
 
 #include <QFrame>
+#include <QMenu>
+#include <QToolBar>
 #include <QWidget>
 
 #include "GyreEnv.h"
+#include "Layout.h"
 #include "MainWindow.h"
 #include "TtyWidget.h"
 #include "user.h"
@@ -34,11 +37,15 @@ namespace gyreui {
 
 class MainWindow;
 
-class ConsoleFrame : public QFrame {
+class ConsoleFrame : public QFrame, public FrameState {
   Q_OBJECT
 
  public:
   explicit ConsoleFrame(QString, MainWindow*);
+  ~ConsoleFrame() override;
+
+  QJsonObject saveState() const override;
+  void restoreState(const QJsonObject&) override;
 
   void log(QString msg) { ttyWidget->writeTty(msg); }
 
@@ -48,9 +55,16 @@ class ConsoleFrame : public QFrame {
   void setContextStatus(QString);
   void showEvent(QShowEvent*);
 
+  void sessionMenu();
+  void sessionChanged();
+  void rename();
+
   MainWindow* mw;
   QString name;
   TtyWidget* ttyWidget;
+  QToolBar* toolBar;
+  QMenu* sessions;
+  QLabel* sessionLabel;
   QLabel* bannerLabel;
   QVBoxLayout* layout;
 };
@@ -0,0 +1,143 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  DiagnosticsFrame.cpp: DiagnosticsFrame implementation
+ **
+ **/
+#include <algorithm>
+
+#include <QDateTime>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QLabel>
+#include <QSplitter>
+#include <QString>
+#include <QTableWidget>
+#include <QToolBar>
+#include <QtWidgets>
+
+#include "DiagnosticsFrame.h"
+
+namespace gyreui {
+
+/** * newest stall first **/
+void DiagnosticsFrame::refresh() {
+  stalls = watchdog->stalls();
+  std::reverse(stalls.begin(), stalls.end());
+
+  stallTable->setRowCount(stalls.size());
+
+  qint64 longest = 0;
+  for (int row = 0; row < stalls.size(); ++row) {
+    auto& stall = stalls[row];
+
+    QStringList cells;
+    cells << QDateTime::fromMSecsSinceEpoch(stall.when).toString("hh:mm:ss")
+          << QString("%1ms").arg(stall.msecs)
+          << (stall.frame.isEmpty() ? tr("event loop") : stall.frame)
+          << stall.form.simplified().left(200);
+
+    for (int col = 0; col < cells.size(); ++col) {
+      auto item = stallTable->item(row, col);
+      if (item == nullptr) {
+        item = new QTableWidgetItem();
+        item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+        stallTable->setItem(row, col, item);
+      }
+      item->setText(cells[col]);
+    }
+
+    longest = qMax(longest, stall.msecs);
+  }
+
+  statusLabel->setText(tr("%1 stalls over %2ms, longest %3ms")
+                           .arg(stalls.size())
+                           .arg(Watchdog::DEADLINE_MSECS)
+                           .arg(longest));
+  select();
+}
+
+void DiagnosticsFrame::select() {
+  auto row = stallTable->currentRow();
+
+  if (row < 0 || row >= stalls.size()) {
+    stackText->clear();
+    return;
+  }
+
+  auto& stall = stalls[row];
+  auto text = stall.form.isEmpty() ? QString() : stall.form + "\n\n";
+
+  stackText->setPlainText(text + (stall.stack.isEmpty()
+                                      ? tr("no stack, the sample timed out")
+                                      : Watchdog::stackText(stall)));
+}
+
+void DiagnosticsFrame::clear() {
+  watchdog->clear();
+  refresh();
+}
+
+void DiagnosticsFrame::save_as() {
+  auto fileName = QFileDialog::getSaveFileName(
+      this, tr("Export Stall Log"), mw->userInfo()->userdir(),
+      tr("Log (*.log *.txt)"));
+
+  if (fileName.isEmpty()) return;
+
+  QSaveFile file(fileName);
+  file.open(QIODevice::WriteOnly);
+  file.write(watchdog->report().toUtf8());
+  file.commit();
+
+  log(";;; stall log exported to " + fileName);
+}
+
+DiagnosticsFrame::DiagnosticsFrame(QString name, MainWindow* tb)
+    : mw(tb), name(name), watchdog(Watchdog::instance()) {
+  toolBar = new QToolBar();
+  connect(toolBar->addAction(tr("clear")), &QAction::triggered, this,
+          &DiagnosticsFrame::clear);
+  connect(toolBar->addAction(tr("export")), &QAction::triggered, this,
+          &DiagnosticsFrame::save_as);
+
+  stallTable = new QTableWidget(0, 4);
+  stallTable->setHorizontalHeaderLabels(
+      {tr("time"), tr("stall"), tr("frame"), tr("form")});
+  stallTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+  stallTable->setSelectionMode(QAbstractItemView::SingleSelection);
+  stallTable->verticalHeader()->hide();
+  stallTable->horizontalHeader()->setStretchLastSection(true);
+  connect(stallTable, &QTableWidget::currentCellChanged, this,
+          &DiagnosticsFrame::select);
+
+  stackText = new QTextEdit();
+  stackText->setReadOnly(true);
+  stackText->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+  auto vs = new QSplitter(Qt::Vertical, this);
+  vs->addWidget(stallTable);
+  vs->addWidget(stackText);
+
+  statusLabel = new QLabel();
+
+  connect(watchdog, &Watchdog::stalled, this, &DiagnosticsFrame::refresh);
+
+  auto layout = new QVBoxLayout;
+  layout->setContentsMargins(5, 5, 5, 5);
+  layout->addWidget(toolBar);
+  layout->addWidget(vs);
+  layout->addWidget(statusLabel);
+
+  setLayout(layout);
+  refresh();
+}
+
+}  // namespace gyreui
@@ -0,0 +1,74 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  DiagnosticsFrame.h: DiagnosticsFrame class
+ **
+ **/
+#ifndef GYREUI_UI_DIAGNOSTICSFRAME_H_
+#define GYREUI_UI_DIAGNOSTICSFRAME_H_
+
+#include <QFrame>
+#include <QLabel>
+#include <QTableWidget>
+#include <QTextEdit>
+#include <QToolBar>
+#include <QWidget>
+
+#include "MainWindow.h"
+#include "Watchdog.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QTableWidget;
+class QTextEdit;
+class QToolBar;
+class QVBoxLayout;
+class QWidget;
+QT_END_NAMESPACE
+
+namespace gyreui {
+
+class MainWindow;
+
+/** * gui stalls the watchdog caught, with what was running **/
+class DiagnosticsFrame : public QFrame {
+  Q_OBJECT
+
+ public:
+  explicit DiagnosticsFrame(QString, MainWindow*);
+
+ private:
+  void refresh();
+  void select();
+  void clear();
+  void save_as();
+
+  void log(QString msg) { mw->log(msg); }
+
+  void setContextStatus(QString str) { mw->setContextStatus(str); }
+
+  void showEvent(QShowEvent* event) override {
+    QWidget::showEvent(event);
+    mw->setContextStatus(name);
+  }
+
+  MainWindow* mw;
+  QString name;
+  Watchdog* watchdog;
+  QList<Stall> stalls;
+  QTableWidget* stallTable;
+  QTextEdit* stackText;
+  QLabel* statusLabel;
+  QToolBar* toolBar;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_DIAGNOSTICSFRAME_H_ */
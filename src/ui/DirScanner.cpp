@@ -0,0 +1,198 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  DirScanner.cpp: background directory scanner implementation
+ **
+ **  readdir and a stat per entry on the worker thread. a listing goes
+ **  back in batches, the first as soon as it has a few entries or a
+ **  few milliseconds have passed, so a large directory fills in while
+ **  it is still being read.
+ **
+ **/
+#include "DirScanner.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMetaObject>
+
+#include "LogBus.h"
+
+namespace gyreui {
+
+namespace {
+
+/** * follows links, a dangling one is listed as itself **/
+bool statEntry(int fd, const char* name, DirEntry& entry) {
+  struct stat st;
+
+  if (fstatat(fd, name, &st, 0) != 0 &&
+      fstatat(fd, name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+    return false;
+
+  entry = {QFile::decodeName(name), S_ISDIR(st.st_mode),
+           static_cast<qint64>(st.st_size),
+           static_cast<qint64>(st.st_mtime)};
+
+  return true;
+}
+
+void warn(QString path) {
+  auto reason = QString::fromLocal8Bit(strerror(errno));
+
+  LogBus::instance()->post(LogEntry::WARNING, "filesystem",
+                           path + ": " + reason);
+}
+
+}  // namespace
+
+void DirScanner::scan(quint64 id, QString path, QStringList names) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  queue.push_back({id, path, names});
+  ready.notify_one();
+}
+
+void DirScanner::cancel() {
+  std::lock_guard<std::mutex> guard(lock);
+
+  queue.clear();
+  epoch++;
+}
+
+bool DirScanner::superseded(quint64 taken) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  return stopping || epoch != taken;
+}
+
+void DirScanner::post(Batch& batch) {
+  auto target = receiver;
+  auto fn = reply;
+
+  QMetaObject::invokeMethod(
+      QCoreApplication::instance(),
+      [target, fn, batch]() {
+        if (target) fn(batch);
+      },
+      Qt::QueuedConnection);
+
+  batch.entries.clear();
+}
+
+void DirScanner::list(const Request& request, quint64 taken) {
+  Batch batch{request.id, {}, {}, true, false};
+
+  auto dir = opendir(QFile::encodeName(request.path).constData());
+  if (dir == nullptr) {
+    warn(request.path);
+    batch.done = true;
+    post(batch);
+    return;
+  }
+
+  QElapsedTimer since;
+  since.start();
+
+  auto fd = dirfd(dir);
+  for (auto ent = readdir(dir); ent != nullptr; ent = readdir(dir)) {
+    if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0)
+      continue;
+
+    DirEntry entry;
+    if (statEntry(fd, ent->d_name, entry)) batch.entries << entry;
+
+    auto due = batch.entries.size() >= BATCH_SIZE ||
+               (!batch.entries.isEmpty() && since.elapsed() >= BATCH_MSECS);
+
+    if (due) {
+      if (superseded(taken)) {
+        closedir(dir);
+        return;
+      }
+
+      post(batch);
+      since.restart();
+    }
+  }
+
+  closedir(dir);
+
+  batch.done = true;
+  post(batch);
+}
+
+void DirScanner::stat(const Request& request) {
+  Batch batch{request.id, {}, {}, false, true};
+
+  auto fd = open(QFile::encodeName(request.path).constData(),
+                 O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    warn(request.path);
+    post(batch);
+    return;
+  }
+
+  for (auto& name : request.names) {
+    DirEntry entry;
+    if (statEntry(fd, QFile::encodeName(name).constData(), entry))
+      batch.entries << entry;
+    else
+      batch.missing << name;
+  }
+
+  ::close(fd);
+  post(batch);
+}
+
+void DirScanner::run() {
+  for (;;) {
+    Request request;
+    quint64 taken;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      ready.wait(guard, [this]() { return stopping || !queue.empty(); });
+      if (stopping) return;
+
+      request = std::move(queue.front());
+      queue.pop_front();
+      taken = epoch;
+    }
+
+    if (request.names.isEmpty())
+      list(request, taken);
+    else
+      stat(request);
+  }
+}
+
+DirScanner::DirScanner(QObject* receiver, Reply reply)
+    : receiver(receiver), reply(reply), epoch(0), stopping(false) {
+  worker = std::thread([this]() { run(); });
+}
+
+DirScanner::~DirScanner() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+    ready.notify_one();
+  }
+
+  worker.join();
+}
+
+}  // namespace gyreui
@@ -0,0 +1,89 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  DirScanner.h: background directory scanner
+ **
+ **/
+#ifndef GYREUI_UI_DIRSCANNER_H_
+#define GYREUI_UI_DIRSCANNER_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace gyreui {
+
+struct DirEntry {
+  QString name;
+  bool dir;
+  qint64 size;
+  qint64 mtime;
+};
+
+/** * requests run in order, each answered in batches on the gui thread **/
+class DirScanner {
+ public:
+  static const int BATCH_SIZE = 256;
+  static const int BATCH_MSECS = 20;
+
+  struct Batch {
+    quint64 id;
+    QVector<DirEntry> entries;
+    QStringList missing;
+    bool full;
+    bool done;
+  };
+
+  typedef std::function<void(const Batch&)> Reply;
+
+  /** * no names lists the directory, names are stated or reported gone **/
+  void scan(quint64, QString, QStringList = QStringList());
+
+  /** * drop queued requests and abandon the one in progress **/
+  void cancel();
+
+  DirScanner(QObject*, Reply);
+  ~DirScanner();
+
+ private:
+  struct Request {
+    quint64 id;
+    QString path;
+    QStringList names;
+  };
+
+  void run();
+  void list(const Request&, quint64);
+  void stat(const Request&);
+  void post(Batch&);
+  bool superseded(quint64);
+
+  QPointer<QObject> receiver;
+  Reply reply;
+
+  std::mutex lock;
+  std::condition_variable ready;
+  std::deque<Request> queue;
+  quint64 epoch;
+  bool stopping;
+  std::thread worker;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_DIRSCANNER_H_ */
@@ -0,0 +1,176 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  EnvPool.cpp: work-stealing pool implementation
+ **
+ **/
+#include "EnvPool.h"
+
+#include <cstdint>
+
+#include <QDir>
+#include <QFile>
+
+namespace gyreui {
+
+thread_local EnvPool::Worker* EnvPool::current = nullptr;
+
+/** * a fresh env with the user's ~/.gyre-ui loaded **/
+GyreEnv* EnvPool::configuredEnv() {
+  auto env = new GyreEnv();
+  auto rc = QDir::home().filePath(".gyre-ui");
+
+  if (QFile::exists(rc))
+    env->withException(
+        [env, rc]() { (void)env->rep(GyreEnv::loadForm(rc)); });
+
+  return env;
+}
+
+void EnvPool::once(GyreEnv* env, QString key, Job fn) {
+  if (current == nullptr || current->env != env) {
+    fn(env);
+    return;
+  }
+
+  if (current->prepared.contains(key)) return;
+
+  current->prepared.insert(key);
+  fn(env);
+}
+
+void EnvPool::mark(GyreEnv* env, QString key) {
+  if (current != nullptr && current->env == env) current->prepared.insert(key);
+}
+
+void EnvPool::submit(Job job) {
+  auto worker = workers[nextWorker++ % workers.size()].get();
+
+  pending++;
+  {
+    std::lock_guard<std::mutex> lock(worker->lock);
+    worker->jobs.push_back(std::move(job));
+  }
+
+  std::lock_guard<std::mutex> lock(idleLock);
+  queued++;
+  idle.notify_all();
+}
+
+void EnvPool::wait() {
+  std::unique_lock<std::mutex> lock(idleLock);
+  done.wait(lock, [this]() { return pending.load() == 0; });
+}
+
+void EnvPool::cancel() {
+  auto dropped = 0;
+
+  for (auto& worker : workers) {
+    std::lock_guard<std::mutex> lock(worker->lock);
+
+    dropped += static_cast<int>(worker->jobs.size());
+    queued -= static_cast<int>(worker->jobs.size());
+    worker->jobs.clear();
+  }
+
+  if (dropped > 0 && (pending -= dropped) == 0) {
+    std::lock_guard<std::mutex> lock(idleLock);
+    done.notify_all();
+  }
+}
+
+/** * own work comes off the front **/
+bool EnvPool::pop(Worker* self, Job& job) {
+  std::lock_guard<std::mutex> lock(self->lock);
+  if (self->jobs.empty()) return false;
+
+  job = std::move(self->jobs.front());
+  self->jobs.pop_front();
+  queued--;
+
+  return true;
+}
+
+/** * stolen work comes off the back of a victim **/
+bool EnvPool::steal(Worker* self, Job& job) {
+  auto n = workers.size();
+  auto start = reinterpret_cast<uintptr_t>(self) % n;
+
+  for (size_t i = 0; i < n; ++i) {
+    auto victim = workers[(start + i) % n].get();
+    if (victim == self) continue;
+
+    std::lock_guard<std::mutex> lock(victim->lock);
+    if (victim->jobs.empty()) continue;
+
+    job = std::move(victim->jobs.back());
+    victim->jobs.pop_back();
+    queued--;
+
+    return true;
+  }
+
+  return false;
+}
+
+void EnvPool::run(Worker* self) {
+  current = self;
+
+  for (;;) {
+    Job job;
+
+    if (pop(self, job) || steal(self, job)) {
+      if (self->env == nullptr) self->env = factory();
+      job(self->env);
+
+      if (--pending == 0) {
+        std::lock_guard<std::mutex> lock(idleLock);
+        done.notify_all();
+      }
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(idleLock);
+    idle.wait(lock, [this]() { return stopping || queued.load() > 0; });
+    if (stopping && queued.load() == 0) return;
+  }
+}
+
+EnvPool::EnvPool(int nworkers, Factory factory)
+    : factory(factory),
+      nextWorker(0),
+      queued(0),
+      pending(0),
+      stopping(false) {
+  if (nworkers <= 0)
+    nworkers = qMax(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+  for (int i = 0; i < nworkers; ++i) workers.emplace_back(new Worker());
+
+  for (auto& worker : workers) {
+    auto self = worker.get();
+    self->thread = std::thread([this, self]() { run(self); });
+  }
+}
+
+EnvPool::~EnvPool() {
+  {
+    std::lock_guard<std::mutex> lock(idleLock);
+    stopping = true;
+    idle.notify_all();
+  }
+
+  for (auto& worker : workers) {
+    worker->thread.join();
+    delete worker->env;
+  }
+}
+
+}  // namespace gyreui
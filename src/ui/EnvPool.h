@@ -0,0 +1,86 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  EnvPool.h: work-stealing pool of isolated GyreEnv workers
+ **
+ **/
+#ifndef GYREUI_UI_ENVPOOL_H_
+#define GYREUI_UI_ENVPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QSet>
+#include <QString>
+
+#include "GyreEnv.h"
+
+namespace gyreui {
+
+class EnvPool {
+ public:
+  typedef std::function<void(GyreEnv*)> Job;
+  typedef std::function<GyreEnv*()> Factory;
+
+  static GyreEnv* configuredEnv();
+
+  void submit(Job);
+  void wait();
+
+  /** * queued jobs dropped, the running ones left to finish **/
+  void cancel();
+  int size() { return static_cast<int>(workers.size()); }
+
+  /** * run fn once per worker env for key, from inside a job **/
+  static void once(GyreEnv*, QString, Job);
+
+  /** * key as done for the worker env, without running anything **/
+  static void mark(GyreEnv*, QString);
+
+  explicit EnvPool(int nworkers = 0, Factory factory = configuredEnv);
+  ~EnvPool();
+
+ private:
+  struct Worker {
+    std::mutex lock;
+    std::deque<Job> jobs;
+    GyreEnv* env;
+    QSet<QString> prepared;
+    std::thread thread;
+
+    Worker() : env(nullptr) {}
+  };
+
+  bool pop(Worker*, Job&);
+  bool steal(Worker*, Job&);
+  void run(Worker*);
+
+  static thread_local Worker* current;
+
+  Factory factory;
+  std::vector<std::unique_ptr<Worker>> workers;
+  std::atomic<unsigned> nextWorker;
+  std::atomic<int> queued;
+  std::atomic<int> pending;
+  bool stopping;
+  std::mutex idleLock;
+  std::condition_variable idle;
+  std::condition_variable done;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_ENVPOOL_H_ */
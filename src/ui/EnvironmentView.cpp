@@ -16,6 +16,7 @@
 
 #include "ConsoleFrame.h"
 #include "EnvironmentView.h"
+#include "LogBus.h"
 #include "MainWindow.h"
 #include "ScriptFrame.h"
 #include "SystemView.h"
@@ -24,6 +25,19 @@ namespace gyreui {
 
 void EnvironmentView::log(QString msg) { console->log(msg); }
 
+/** * the console shows the bus from info up, sources other than ui named **/
+void EnvironmentView::drained() {
+  auto bus = LogBus::instance();
+
+  for (logged = qMax(logged, bus->begin()); logged < bus->end(); ++logged) {
+    auto& entry = bus->at(logged);
+
+    if (entry.severity < LogEntry::INFO) continue;
+    log(entry.source == "ui" ? entry.text
+                             : entry.source + ": " + entry.text);
+  }
+}
+
 const char* EnvironmentView::configFile = "~/.gyre-ui";
 const char* EnvironmentView::version = "0.0.9";
 
@@ -39,7 +53,7 @@ void EnvironmentView::showEvent(QShowEvent* event) {
 GyreEnv* EnvironmentView::get_gyre() { return console->get_gyre(); }
 
 EnvironmentView::EnvironmentView(QString name, MainWindow* mw)
-    : mw(mw), name(name) {
+    : mw(mw), name(name), logged(0) {
   std::string html =
       "<html>"
       "  <body bgcolor=#c0c0c0>"
@@ -88,6 +102,9 @@ EnvironmentView::EnvironmentView(QString name, MainWindow* mw)
 
   setLayout(layout);
   setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
+
+  connect(LogBus::instance(), &LogBus::drained, this,
+          &EnvironmentView::drained);
 }
 
 } /* namespace gyreui */
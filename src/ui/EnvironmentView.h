@@ -49,6 +49,7 @@ class EnvironmentView : public QFrame {
   GyreEnv* get_gyre();
 
  private:
+  void drained();
   void setContextStatus(QString);
   void showEvent(QShowEvent*) override;
 
@@ -58,6 +59,7 @@ class EnvironmentView : public QFrame {
   SystemView* sv;
   QLabel* bannerLabel;
   QVBoxLayout* layout;
+  quint64 logged;
 };
 
 } /* namespace gyreui */
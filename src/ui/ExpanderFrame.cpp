@@ -0,0 +1,220 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  ExpanderFrame.cpp: ExpanderFrame implementation
+ **
+ **  items hold the text of their form and are split into subforms only
+ **  when opened. an expansion goes in as the first child of the item it
+ **  expands, itself a form to open or expand further.
+ **
+ **/
+#include <QApplication>
+#include <QClipboard>
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QMenu>
+#include <QString>
+#include <QToolBar>
+#include <QtWidgets>
+
+#include "ExpanderFrame.h"
+#include "FormReader.h"
+#include "Watchdog.h"
+
+namespace gyreui {
+
+namespace {
+
+const int LABEL_MAX = 120;
+
+bool isList(const QString& form) { return form.startsWith('('); }
+
+/** * the elements of a list form **/
+QStringList elements(const QString& form) {
+  QStringList out;
+
+  auto open = form.indexOf('(');
+  auto close = form.lastIndexOf(')');
+  if (open < 0 || close <= open) return out;
+
+  for (auto& element : FormReader::forms(form.mid(open + 1, close - open - 1)))
+    out << element.text;
+
+  return out;
+}
+
+}  // namespace
+
+QTreeWidgetItem* ExpanderFrame::makeItem(QString form, bool expansion) {
+  auto item = new QTreeWidgetItem();
+  auto text = MacroExpander::normalize(form);
+
+  if (text.size() > LABEL_MAX) text = text.left(LABEL_MAX) + "...";
+
+  item->setText(0, expansion ? "=> " + text : text);
+  item->setData(0, FORM, form);
+  item->setData(0, POPULATED, false);
+  item->setData(0, EXPANSION, expansion);
+  item->setChildIndicatorPolicy(isList(form)
+                                    ? QTreeWidgetItem::ShowIndicator
+                                    : QTreeWidgetItem::DontShowIndicator);
+
+  if (expansion) {
+    auto font = item->font(0);
+    font.setItalic(true);
+    item->setFont(0, font);
+  }
+
+  return item;
+}
+
+/** * the list subforms, the first time the item is opened **/
+void ExpanderFrame::populate(QTreeWidgetItem* item) {
+  if (item->data(0, POPULATED).toBool()) return;
+  item->setData(0, POPULATED, true);
+
+  for (auto& element : elements(item->data(0, FORM).toString()))
+    if (isList(element)) item->addChild(makeItem(element, false));
+
+  if (item->childCount() == 0)
+    item->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicator);
+}
+
+void ExpanderFrame::expand(bool once) {
+  auto item = treeView->currentItem();
+  if (item == nullptr) item = treeView->topLevelItem(0);
+  if (item == nullptr) return;
+
+  auto form = item->data(0, FORM).toString();
+
+  QElapsedTimer timer;
+  timer.start();
+
+  Watchdog::Scope watch(name + " macroexpand", form);
+  auto expansion = expander->expand(form, once);
+  auto usecs = timer.nsecsElapsed() / 1000;
+
+  if (!expansion.error.isEmpty()) {
+    statusLabel->setText(expansion.error.trimmed());
+    return;
+  }
+
+  if (MacroExpander::normalize(expansion.text) ==
+      MacroExpander::normalize(form)) {
+    statusLabel->setText(tr("not a macro form"));
+    return;
+  }
+
+  /* expanding again, the other way, replaces the last expansion */
+  for (int i = item->childCount() - 1; i >= 0; --i)
+    if (item->child(i)->data(0, EXPANSION).toBool()) delete item->takeChild(i);
+
+  auto child = makeItem(expansion.text, true);
+  item->insertChild(0, child);
+  item->setExpanded(true);
+  treeView->setCurrentItem(child);
+
+  statusLabel->setText(tr("%1 %2 in %3us | %4 cached, %5 hits %6 misses")
+                           .arg(once ? tr("one step") : tr("fully"))
+                           .arg(expansion.cached ? tr("from cache")
+                                                 : tr("expanded"))
+                           .arg(usecs)
+                           .arg(expander->size())
+                           .arg(expander->hits())
+                           .arg(expander->misses()));
+}
+
+void ExpanderFrame::contextMenu(const QPoint& at) {
+  auto item = treeView->itemAt(at);
+  if (item == nullptr) return;
+
+  treeView->setCurrentItem(item);
+
+  QMenu menu;
+  menu.addAction(tr("expand once"), [this]() { expand(true); });
+  menu.addAction(tr("expand fully"), [this]() { expand(false); });
+  menu.addAction(tr("copy"), [item]() {
+    QApplication::clipboard()->setText(item->data(0, FORM).toString());
+  });
+
+  menu.exec(treeView->viewport()->mapToGlobal(at));
+}
+
+/** * a new tree, rooted at form **/
+void ExpanderFrame::setForm(QString form) {
+  form = form.trimmed();
+
+  treeView->clear();
+  statusLabel->clear();
+  formEdit->setText(MacroExpander::normalize(form));
+
+  if (!form.isEmpty()) {
+    auto root = makeItem(form, false);
+    treeView->addTopLevelItem(root);
+    treeView->setCurrentItem(root);
+  }
+
+  LayoutStore::instance()->changed();
+}
+
+QJsonObject ExpanderFrame::saveState() const {
+  auto root = treeView->topLevelItem(0);
+
+  return QJsonObject{
+      {"form", root == nullptr ? QString() : root->data(0, FORM).toString()}};
+}
+
+void ExpanderFrame::restoreState(const QJsonObject& state) {
+  setForm(state["form"].toString());
+}
+
+ExpanderFrame::ExpanderFrame(QString name, MainWindow* tb, GyreEnv* env)
+    : mw(tb), devEnv(env), name(name), expander(MacroExpander::forEnv(env)) {
+  toolBar = new QToolBar();
+
+  formEdit = new QLineEdit();
+  formEdit->setPlaceholderText(tr("form"));
+  toolBar->addWidget(formEdit);
+
+  connect(toolBar->addAction(tr("once")), &QAction::triggered, this,
+          [this]() { expand(true); });
+  connect(toolBar->addAction(tr("fully")), &QAction::triggered, this,
+          [this]() { expand(false); });
+  connect(toolBar->addAction(tr("collapse")), &QAction::triggered, this,
+          [this]() { treeView->collapseAll(); });
+
+  treeView = new QTreeWidget();
+  treeView->setHeaderHidden(true);
+  treeView->setExpandsOnDoubleClick(false);
+  treeView->setContextMenuPolicy(Qt::CustomContextMenu);
+  treeView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+  statusLabel = new QLabel();
+  statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+  connect(formEdit, &QLineEdit::returnPressed, this,
+          [this]() { setForm(formEdit->text()); });
+  connect(treeView, &QTreeWidget::itemExpanded, this,
+          &ExpanderFrame::populate);
+  connect(treeView, &QTreeWidget::itemDoubleClicked, this,
+          [this]() { expand(true); });
+  connect(treeView, &QTreeWidget::customContextMenuRequested, this,
+          &ExpanderFrame::contextMenu);
+
+  auto layout = new QVBoxLayout;
+  layout->setContentsMargins(5, 5, 5, 5);
+  layout->addWidget(toolBar);
+  layout->addWidget(treeView);
+  layout->addWidget(statusLabel);
+
+  setLayout(layout);
+}
+
+}  // namespace gyreui
@@ -0,0 +1,83 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  ExpanderFrame.h: ExpanderFrame class
+ **
+ **/
+#ifndef GYREUI_UI_EXPANDERFRAME_H_
+#define GYREUI_UI_EXPANDERFRAME_H_
+
+#include <QFrame>
+#include <QLabel>
+#include <QLineEdit>
+#include <QToolBar>
+#include <QTreeWidget>
+#include <QWidget>
+
+#include "GyreEnv.h"
+#include "Layout.h"
+#include "MacroExpander.h"
+#include "MainWindow.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QLineEdit;
+class QToolBar;
+class QTreeWidget;
+class QTreeWidgetItem;
+class QVBoxLayout;
+class QWidget;
+QT_END_NAMESPACE
+
+namespace gyreui {
+
+class MainWindow;
+
+/** * a form as a tree of its subforms, any of which can be expanded a
+      step or all the way in place **/
+class ExpanderFrame : public QFrame, public FrameState {
+  Q_OBJECT
+
+ public:
+  explicit ExpanderFrame(QString, MainWindow*, GyreEnv*);
+
+  void setForm(QString);
+
+  QJsonObject saveState() const override;
+  void restoreState(const QJsonObject&) override;
+
+ private:
+  enum Role { FORM = Qt::UserRole, POPULATED, EXPANSION };
+
+  QTreeWidgetItem* makeItem(QString, bool);
+  void populate(QTreeWidgetItem*);
+  void expand(bool);
+  void contextMenu(const QPoint&);
+
+  void setContextStatus(QString str) { mw->setContextStatus(str); }
+
+  void showEvent(QShowEvent* event) override {
+    QWidget::showEvent(event);
+    mw->setContextStatus(name);
+  }
+
+  MainWindow* mw;
+  GyreEnv* devEnv;
+  QString name;
+  MacroExpander* expander;
+  QLineEdit* formEdit;
+  QTreeWidget* treeView;
+  QLabel* statusLabel;
+  QToolBar* toolBar;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_EXPANDERFRAME_H_ */
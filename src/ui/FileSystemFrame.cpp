@@ -0,0 +1,105 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  FileSystemFrame.cpp: FileSystemFrame implementation
+ **
+ **  the model does its reading on the scanner thread, the view only
+ **  fetches what is expanded, so nothing here waits on the disk.
+ **
+ **/
+#include <QDir>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QLabel>
+#include <QString>
+#include <QToolBar>
+#include <QtWidgets>
+
+#include "FileSystemFrame.h"
+
+namespace gyreui {
+
+void FileSystemFrame::setRoot(QString path) {
+  model->setRoot(path);
+  rootEdit->setText(model->root());
+  setContextStatus(name + ": " + model->root());
+}
+
+void FileSystemFrame::browse() {
+  auto path = QFileDialog::getExistingDirectory(this, tr("Root"),
+                                                model->root());
+
+  if (!path.isEmpty()) setRoot(path);
+}
+
+void FileSystemFrame::up() {
+  auto dir = QDir(model->root());
+
+  if (dir.cdUp()) setRoot(dir.absolutePath());
+}
+
+void FileSystemFrame::activated(const QModelIndex& index) {
+  if (!model->isDir(index)) emit openFile(model->path(index));
+}
+
+void FileSystemFrame::changed() {
+  auto status = tr("%1 entries, %2 watched")
+                    .arg(model->entries())
+                    .arg(model->watching());
+
+  if (model->scanning() > 0)
+    status += tr(", scanning %1").arg(model->scanning());
+
+  statusLabel->setText(status);
+}
+
+FileSystemFrame::FileSystemFrame(QString name, MainWindow* tb)
+    : mw(tb), name(name) {
+  toolBar = new QToolBar();
+
+  rootEdit = new QLineEdit();
+  toolBar->addWidget(rootEdit);
+
+  connect(toolBar->addAction(tr("up")), &QAction::triggered, this,
+          &FileSystemFrame::up);
+  connect(toolBar->addAction(tr("browse")), &QAction::triggered, this,
+          &FileSystemFrame::browse);
+  connect(toolBar->addAction(tr("collapse")), &QAction::triggered, this,
+          [this]() { treeView->collapseAll(); });
+
+  model = new FileSystemModel(this);
+
+  treeView = new QTreeView();
+  treeView->setModel(model);
+  treeView->setUniformRowHeights(true);
+  treeView->header()->setSectionResizeMode(FileSystemModel::NAME,
+                                           QHeaderView::Stretch);
+  treeView->header()->setStretchLastSection(false);
+
+  statusLabel = new QLabel();
+
+  connect(rootEdit, &QLineEdit::returnPressed, this,
+          [this]() { setRoot(rootEdit->text()); });
+  connect(treeView, &QTreeView::activated, this, &FileSystemFrame::activated);
+  connect(model, &FileSystemModel::changed, this, &FileSystemFrame::changed);
+
+  auto layout = new QVBoxLayout;
+  layout->setContentsMargins(5, 5, 5, 5);
+  layout->addWidget(toolBar);
+  layout->addWidget(treeView);
+  layout->addWidget(statusLabel);
+
+  setLayout(layout);
+
+  rootEdit->setText(model->root());
+  changed();
+}
+
+}  // namespace gyreui
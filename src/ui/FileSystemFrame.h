@@ -0,0 +1,74 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  FileSystemFrame.h: FileSystemFrame class
+ **
+ **/
+#ifndef GYREUI_UI_FILESYSTEMFRAME_H_
+#define GYREUI_UI_FILESYSTEMFRAME_H_
+
+#include <QFrame>
+#include <QLabel>
+#include <QLineEdit>
+#include <QToolBar>
+#include <QTreeView>
+#include <QWidget>
+
+#include "FileSystemModel.h"
+#include "MainWindow.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QLineEdit;
+class QToolBar;
+class QTreeView;
+class QVBoxLayout;
+class QWidget;
+QT_END_NAMESPACE
+
+namespace gyreui {
+
+class MainWindow;
+
+class FileSystemFrame : public QFrame {
+  Q_OBJECT
+
+ public:
+  explicit FileSystemFrame(QString, MainWindow*);
+
+ signals:
+  void openFile(QString);
+
+ private:
+  void browse();
+  void up();
+  void setRoot(QString);
+  void activated(const QModelIndex&);
+  void changed();
+
+  void setContextStatus(QString str) { mw->setContextStatus(str); }
+
+  void showEvent(QShowEvent* event) override {
+    QWidget::showEvent(event);
+    mw->setContextStatus(name);
+  }
+
+  MainWindow* mw;
+  QString name;
+  FileSystemModel* model;
+  QTreeView* treeView;
+  QLineEdit* rootEdit;
+  QLabel* statusLabel;
+  QToolBar* toolBar;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_FILESYSTEMFRAME_H_ */
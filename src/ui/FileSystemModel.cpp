@@ -0,0 +1,440 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  FileSystemModel.cpp: directory tree model implementation
+ **
+ **  a directory is listed by the scanner the first time the view asks
+ **  to fetch it, and its entries are appended as the batches come in
+ **  and sorted once the listing is done. a listed directory is then
+ **  watched: removals are applied as they are read, creations and
+ **  changes are collected for a moment and stated by the scanner in
+ **  one request. only a watch queue overflow lists anything again.
+ **
+ **/
+#include "FileSystemModel.h"
+
+#include <algorithm>
+
+#include <QDateTime>
+#include <QDir>
+#include <QLocale>
+
+namespace gyreui {
+
+/** * tree **/
+FileSystemModel::Node* FileSystemModel::nodeOf(const QModelIndex& index) const {
+  return index.isValid() ? static_cast<Node*>(index.internalPointer())
+                         : rootNode;
+}
+
+QModelIndex FileSystemModel::indexOf(Node* node) const {
+  return node == rootNode ? QModelIndex() : createIndex(node->row, 0, node);
+}
+
+QString FileSystemModel::pathOf(const Node* node) const {
+  QStringList names;
+
+  for (; node != rootNode; node = node->parent) names.prepend(node->name);
+  if (names.isEmpty()) return rootNode->name;
+
+  auto base = rootNode->name;
+  if (!base.endsWith('/')) base += '/';
+
+  return base + names.join('/');
+}
+
+FileSystemModel::Node* FileSystemModel::makeNode(Node* parent,
+                                                 const DirEntry& entry) {
+  auto node = new Node;
+
+  node->id = nextId++;
+  node->name = entry.name;
+  node->parent = parent;
+  node->row = parent == nullptr ? 0 : parent->children.size();
+  node->dir = entry.dir;
+  node->size = entry.size;
+  node->mtime = entry.mtime;
+  node->state = UNSCANNED;
+  node->watch = -1;
+  node->pass = 0;
+  node->seen = parent == nullptr ? 0 : parent->pass;
+
+  nodes[node->id] = node;
+  if (parent != nullptr) parent->named[node->name] = node;
+
+  return node;
+}
+
+void FileSystemModel::freeNode(Node* node) {
+  for (auto child : node->children) freeNode(child);
+
+  unwatch(node);
+  if (node->state == SCANNING) pending--;
+
+  touched.remove(node->id);
+  nodes.remove(node->id);
+  delete node;
+}
+
+/** * model **/
+QModelIndex FileSystemModel::index(int row, int column,
+                                   const QModelIndex& parent) const {
+  auto node = nodeOf(parent);
+
+  if (row < 0 || row >= node->children.size() || column < 0 ||
+      column >= COLUMNS)
+    return QModelIndex();
+
+  return createIndex(row, column, node->children[row]);
+}
+
+QModelIndex FileSystemModel::parent(const QModelIndex& index) const {
+  if (!index.isValid()) return QModelIndex();
+
+  return indexOf(nodeOf(index)->parent);
+}
+
+int FileSystemModel::rowCount(const QModelIndex& parent) const {
+  return parent.column() > 0 ? 0 : nodeOf(parent)->children.size();
+}
+
+int FileSystemModel::columnCount(const QModelIndex&) const { return COLUMNS; }
+
+QVariant FileSystemModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid()) return QVariant();
+
+  auto node = nodeOf(index);
+
+  switch (role) {
+    case Qt::DisplayRole:
+      switch (index.column()) {
+        case NAME:
+          return node->name;
+        case SIZE:
+          return node->dir ? QVariant()
+                           : QLocale().formattedDataSize(node->size);
+        case MODIFIED:
+          return QDateTime::fromSecsSinceEpoch(node->mtime)
+              .toString("yyyy-MM-dd hh:mm");
+        default:
+          return QVariant();
+      }
+    case Qt::DecorationRole:
+      if (index.column() != NAME) return QVariant();
+      return icons.icon(node->dir ? QFileIconProvider::Folder
+                                  : QFileIconProvider::File);
+    case Qt::TextAlignmentRole:
+      if (index.column() != SIZE) return QVariant();
+      return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+    case Qt::ToolTipRole:
+      return pathOf(node);
+    default:
+      return QVariant();
+  }
+}
+
+QVariant FileSystemModel::headerData(int section, Qt::Orientation orientation,
+                                     int role) const {
+  static const char* names[] = {QT_TR_NOOP("name"), QT_TR_NOOP("size"),
+                                QT_TR_NOOP("modified")};
+
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole ||
+      section < 0 || section >= COLUMNS)
+    return QVariant();
+
+  return tr(names[section]);
+}
+
+bool FileSystemModel::hasChildren(const QModelIndex& parent) const {
+  auto node = nodeOf(parent);
+
+  if (parent.column() > 0 || !node->dir) return false;
+
+  return node->state != SCANNED || !node->children.isEmpty();
+}
+
+bool FileSystemModel::canFetchMore(const QModelIndex& parent) const {
+  auto node = nodeOf(parent);
+
+  return node->dir && node->state == UNSCANNED;
+}
+
+void FileSystemModel::fetchMore(const QModelIndex& parent) {
+  scan(nodeOf(parent));
+}
+
+void FileSystemModel::setRoot(QString path) {
+  scanner->cancel();
+  settleTimer->stop();
+  touched.clear();
+
+  beginResetModel();
+
+  if (rootNode != nullptr) freeNode(rootNode);
+  pending = 0;
+
+  rootNode = makeNode(
+      nullptr, {QDir::cleanPath(QDir(path).absolutePath()), true, 0, 0});
+
+  endResetModel();
+
+  scan(rootNode);
+}
+
+QString FileSystemModel::root() const { return rootNode->name; }
+
+QString FileSystemModel::path(const QModelIndex& index) const {
+  return pathOf(nodeOf(index));
+}
+
+bool FileSystemModel::isDir(const QModelIndex& index) const {
+  return nodeOf(index)->dir;
+}
+
+/** * listings **/
+void FileSystemModel::scan(Node* node) {
+  if (!node->dir || node->state == SCANNING) return;
+
+  node->state = SCANNING;
+  node->pass++;
+  pending++;
+
+  /* watched first, so nothing changes unseen behind the listing */
+  watch(node);
+  scanner->scan(node->id, pathOf(node));
+  emit changed();
+}
+
+void FileSystemModel::received(const DirScanner::Batch& batch) {
+  auto node = nodes.value(batch.id);
+  if (node == nullptr) return;
+
+  QVector<DirEntry> added;
+  for (auto& entry : batch.entries) {
+    auto child = node->named.value(entry.name);
+
+    if (child == nullptr)
+      added << entry;
+    else
+      update(node, child, entry);
+  }
+
+  insert(node, added);
+
+  for (auto& name : batch.missing) {
+    auto child = node->named.value(name);
+    if (child != nullptr) remove(node, child->row);
+  }
+
+  if (batch.done) {
+    /* whatever a full listing didn't see is gone */
+    if (batch.full && node->state == SCANNING) {
+      for (int row = node->children.size() - 1; row >= 0; --row)
+        if (node->children[row]->seen != node->pass) remove(node, row);
+
+      node->state = SCANNED;
+      pending--;
+    }
+
+    sort(node);
+  }
+
+  emit changed();
+}
+
+void FileSystemModel::update(Node* parent, Node* child, const DirEntry& entry) {
+  if (child->dir != entry.dir) {
+    remove(parent, child->row);
+    insert(parent, {entry});
+    return;
+  }
+
+  child->size = entry.size;
+  child->mtime = entry.mtime;
+  child->seen = parent->pass;
+
+  emit dataChanged(createIndex(child->row, SIZE, child),
+                   createIndex(child->row, MODIFIED, child));
+}
+
+void FileSystemModel::insert(Node* parent, const QVector<DirEntry>& entries) {
+  if (entries.isEmpty()) return;
+
+  auto first = parent->children.size();
+
+  beginInsertRows(indexOf(parent), first, first + entries.size() - 1);
+  for (auto& entry : entries) parent->children << makeNode(parent, entry);
+  endInsertRows();
+}
+
+void FileSystemModel::remove(Node* parent, int row) {
+  beginRemoveRows(indexOf(parent), row, row);
+
+  auto child = parent->children.takeAt(row);
+  parent->named.remove(child->name);
+  for (int i = row; i < parent->children.size(); ++i)
+    parent->children[i]->row = i;
+
+  endRemoveRows();
+
+  freeNode(child);
+}
+
+/** * directories first, then by name **/
+void FileSystemModel::sort(Node* node) {
+  auto less = [](const Node* a, const Node* b) {
+    if (a->dir != b->dir) return a->dir;
+    return a->name.compare(b->name, Qt::CaseInsensitive) < 0;
+  };
+
+  auto& children = node->children;
+  if (std::is_sorted(children.begin(), children.end(), less)) return;
+
+  QList<QPersistentModelIndex> parents;
+  if (node != rootNode) parents << indexOf(node);
+
+  emit layoutAboutToBeChanged(parents, VerticalSortHint);
+
+  std::stable_sort(children.begin(), children.end(), less);
+  for (int i = 0; i < children.size(); ++i) children[i]->row = i;
+
+  for (auto& from : persistentIndexList()) {
+    auto child = nodeOf(from);
+
+    if (from.isValid() && child->parent == node)
+      changePersistentIndex(from,
+                            createIndex(child->row, from.column(), child));
+  }
+
+  emit layoutChanged(parents, VerticalSortHint);
+}
+
+/** * watches **/
+void FileSystemModel::watch(Node* node) {
+  if (node->watch >= 0) return;
+
+  auto path = pathOf(node);
+
+  if (watcher->available()) {
+    node->watch = watcher->watch(path);
+    if (node->watch < 0) return;
+  } else {
+    fallback->addPath(path);
+    node->watch = 0;
+  }
+
+  watchedPaths[path] = node->id;
+}
+
+void FileSystemModel::unwatch(Node* node) {
+  if (node->watch < 0) return;
+
+  auto path = pathOf(node);
+
+  if (watcher->available())
+    watcher->unwatch(node->watch);
+  else
+    fallback->removePath(path);
+
+  watchedPaths.remove(path);
+  node->watch = -1;
+}
+
+void FileSystemModel::notified(TreeWatcher::Change change, QString path) {
+  /* events were lost, list everything we have listed again */
+  if (change == TreeWatcher::OVERFLOWED) {
+    touched.clear();
+    for (auto node : nodes)
+      if (node->state == SCANNED) scan(node);
+
+    return;
+  }
+
+  auto slash = path.lastIndexOf('/');
+  auto node = nodes.value(watchedPaths.value(path.left(slash)));
+  if (node == nullptr) return;
+
+  auto name = path.mid(slash + 1);
+
+  /* a listing in progress may or may not have seen it, ask after */
+  if (change != TreeWatcher::CHANGED && node->state == SCANNED) {
+    touched[node->id].remove(name);
+
+    auto child = node->named.value(name);
+    if (child != nullptr) remove(node, child->row);
+    emit changed();
+  } else {
+    touched[node->id] << name;
+  }
+
+  /* a steady stream of events doesn't hold the batch back */
+  if (!touched.isEmpty() && !settleTimer->isActive()) settleTimer->start();
+}
+
+void FileSystemModel::settle() {
+  QHash<quint64, QSet<QString>> later;
+
+  for (auto it = touched.begin(); it != touched.end(); ++it) {
+    auto node = nodes.value(it.key());
+
+    if (node == nullptr || it.value().isEmpty()) continue;
+
+    if (node->state == SCANNED)
+      scanner->scan(node->id, pathOf(node), it.value().values());
+    else
+      later.insert(it.key(), it.value());
+  }
+
+  touched = later;
+  if (!touched.isEmpty()) settleTimer->start();
+}
+
+FileSystemModel::FileSystemModel(QObject* parent)
+    : QAbstractItemModel(parent),
+      rootNode(nullptr),
+      nextId(1),
+      pending(0),
+      fallback(nullptr) {
+  scanner.reset(new DirScanner(
+      this, [this](const DirScanner::Batch& batch) { received(batch); }));
+
+  settleTimer = new QTimer(this);
+  settleTimer->setSingleShot(true);
+  settleTimer->setInterval(SETTLE_MSECS);
+  connect(settleTimer, &QTimer::timeout, this, &FileSystemModel::settle);
+
+  /* events come in on the watcher's thread, the tree belongs to the gui */
+  watcher.reset(new TreeWatcher(
+      [this](TreeWatcher::Change change, QString path) {
+        QMetaObject::invokeMethod(
+            this, [this, change, path]() { notified(change, path); },
+            Qt::QueuedConnection);
+      },
+      TreeWatcher::LISTED));
+
+  if (!watcher->available()) {
+    fallback = new QFileSystemWatcher(this);
+    connect(fallback, &QFileSystemWatcher::directoryChanged, this,
+            [this](QString path) {
+              auto node = nodes.value(watchedPaths.value(path));
+              if (node != nullptr && node->state == SCANNED) scan(node);
+            });
+  }
+
+  setRoot(QDir::currentPath());
+}
+
+FileSystemModel::~FileSystemModel() {
+  scanner.reset();
+  freeNode(rootNode);
+  watcher.reset();
+}
+
+}  // namespace gyreui
@@ -0,0 +1,125 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  FileSystemModel.h: lazily scanned, watched directory tree
+ **
+ **/
+#ifndef GYREUI_UI_FILESYSTEMMODEL_H_
+#define GYREUI_UI_FILESYSTEMMODEL_H_
+
+#include <memory>
+
+#include <QAbstractItemModel>
+#include <QFileIconProvider>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+#include "DirScanner.h"
+#include "TreeWatcher.h"
+
+namespace gyreui {
+
+class FileSystemModel : public QAbstractItemModel {
+  Q_OBJECT
+
+ public:
+  enum Column { NAME, SIZE, MODIFIED, COLUMNS };
+
+  static const int SETTLE_MSECS = 50;
+
+  QModelIndex index(int, int, const QModelIndex&) const override;
+  QModelIndex parent(const QModelIndex&) const override;
+  int rowCount(const QModelIndex&) const override;
+  int columnCount(const QModelIndex&) const override;
+  QVariant data(const QModelIndex&, int) const override;
+  QVariant headerData(int, Qt::Orientation, int) const override;
+
+  /** * directories are listed the first time they are expanded **/
+  bool hasChildren(const QModelIndex&) const override;
+  bool canFetchMore(const QModelIndex&) const override;
+  void fetchMore(const QModelIndex&) override;
+
+  void setRoot(QString);
+  QString root() const;
+  QString path(const QModelIndex&) const;
+  bool isDir(const QModelIndex&) const;
+
+  int entries() const { return nodes.size() - 1; }
+  int scanning() const { return pending; }
+  int watching() const { return watchedPaths.size(); }
+
+  explicit FileSystemModel(QObject*);
+  ~FileSystemModel();
+
+ signals:
+  void changed();
+
+ private:
+  enum State { UNSCANNED, SCANNING, SCANNED };
+
+  struct Node {
+    quint64 id;
+    QString name;
+    Node* parent;
+    int row;
+    bool dir;
+    qint64 size;
+    qint64 mtime;
+    State state;
+    int watch;
+    quint64 pass;
+    quint64 seen;
+    QVector<Node*> children;
+    QHash<QString, Node*> named;
+  };
+
+  Node* nodeOf(const QModelIndex&) const;
+  QModelIndex indexOf(Node*) const;
+  QString pathOf(const Node*) const;
+
+  Node* makeNode(Node*, const DirEntry&);
+  void freeNode(Node*);
+
+  void scan(Node*);
+  void received(const DirScanner::Batch&);
+  void update(Node*, Node*, const DirEntry&);
+  void insert(Node*, const QVector<DirEntry>&);
+  void remove(Node*, int);
+  void sort(Node*);
+
+  void watch(Node*);
+  void unwatch(Node*);
+  void notified(TreeWatcher::Change, QString);
+  void settle();
+
+  Node* rootNode;
+  QHash<quint64, Node*> nodes;
+  quint64 nextId;
+  int pending;
+
+  std::unique_ptr<DirScanner> scanner;
+  QFileIconProvider icons;
+
+  /* inotify where there is one, QFileSystemWatcher otherwise */
+  std::unique_ptr<TreeWatcher> watcher;
+  QFileSystemWatcher* fallback;
+  QHash<QString, quint64> watchedPaths;
+
+  QHash<quint64, QSet<QString>> touched;
+  QTimer* settleTimer;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_FILESYSTEMMODEL_H_ */
@@ -0,0 +1,146 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  FlameGraph.cpp: FlameGraph implementation
+ **
+ **/
+#include "FlameGraph.h"
+
+#include <QPainter>
+#include <QToolTip>
+
+namespace gyreui {
+
+namespace {
+
+/** * stable warm color per frame name **/
+QColor frameColor(const QString& name) {
+  auto hash = qHash(name);
+
+  return QColor::fromHsv(10 + hash % 40, 140 + hash % 80, 230);
+}
+
+} /* anonymous namespace */
+
+int FlameGraph::treeDepth(const ProfileNode* node) {
+  int depth = 0;
+
+  for (auto& child : node->children)
+    depth = qMax(depth, treeDepth(child.second.get()));
+
+  return depth + 1;
+}
+
+void FlameGraph::layoutNode(const ProfileNode* node, int depth, double x,
+                            double width) {
+  if (width < 1.0) return;
+
+  boxes.push_back({QRect(int(x), height() - (depth + 1) * ROW_HEIGHT,
+                         qMax(1, int(width) - 1), ROW_HEIGHT - 1),
+                   node});
+
+  for (auto& child : node->children) {
+    auto cw = width * child.second->total / qMax(1, node->total);
+
+    layoutNode(child.second.get(), depth + 1, x, cw);
+    x += cw;
+  }
+}
+
+void FlameGraph::setTree(const ProfileNode* tree) {
+  root = tree;
+  zoom = tree;
+  seen = Profiler::instance()->generation();
+
+  setMinimumHeight(treeDepth(root) * ROW_HEIGHT);
+  update();
+}
+
+/** * any frame can clear the profiler, the zoom and the boxes laid out
+      from the tree it freed go back to the root **/
+void FlameGraph::sync() {
+  auto generation = Profiler::instance()->generation();
+  if (generation == seen) return;
+
+  seen = generation;
+  zoom = root;
+  boxes.clear();
+}
+
+const ProfileNode* FlameGraph::nodeAt(const QPoint& pos) {
+  sync();
+
+  for (auto& box : boxes)
+    if (box.rect.contains(pos)) return box.node;
+
+  return nullptr;
+}
+
+void FlameGraph::paintEvent(QPaintEvent*) {
+  QPainter painter(this);
+  painter.fillRect(rect(), Qt::white);
+
+  sync();
+  boxes.clear();
+  if (zoom == nullptr || zoom->total == 0) return;
+
+  layoutNode(zoom, 0, 0.0, width());
+
+  auto m = painter.fontMetrics();
+  for (auto& box : boxes) {
+    auto name = box.node == root ? tr("all") : box.node->name;
+
+    painter.fillRect(box.rect, frameColor(name));
+    if (box.rect.width() > m.averageCharWidth() * 3)
+      painter.drawText(box.rect.adjusted(2, 0, -2, 0),
+                       Qt::AlignVCenter | Qt::AlignLeft,
+                       m.elidedText(name, Qt::ElideRight, box.rect.width() - 4));
+  }
+}
+
+void FlameGraph::mouseMoveEvent(QMouseEvent* event) {
+  auto node = nodeAt(event->pos());
+
+  if (node == nullptr || root->total == 0) {
+    QToolTip::hideText();
+    return;
+  }
+
+  QToolTip::showText(event->globalPos(),
+                     QString("%1\n%2 samples (%3%), %4 self")
+                         .arg(node->name)
+                         .arg(node->total)
+                         .arg(100.0 * node->total / root->total, 0, 'f', 1)
+                         .arg(node->self),
+                     this);
+}
+
+/** * click zooms into a frame, double click zooms back out **/
+void FlameGraph::mousePressEvent(QMouseEvent* event) {
+  auto node = nodeAt(event->pos());
+
+  if (node != nullptr) {
+    zoom = node;
+    update();
+  }
+}
+
+void FlameGraph::mouseDoubleClickEvent(QMouseEvent*) {
+  zoom = root;
+  update();
+}
+
+FlameGraph::FlameGraph(QWidget* parent)
+    : QWidget(parent), root(nullptr), zoom(nullptr), seen(0) {
+  setMouseTracking(true);
+  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+}  // namespace gyreui
@@ -0,0 +1,61 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  FlameGraph.h: FlameGraph class
+ **
+ **/
+#ifndef GYREUI_UI_FLAMEGRAPH_H_
+#define GYREUI_UI_FLAMEGRAPH_H_
+
+#include <QMouseEvent>
+#include <QPaintEvent>
+#include <QVector>
+#include <QWidget>
+
+#include "Profiler.h"
+
+namespace gyreui {
+
+class FlameGraph : public QWidget {
+  Q_OBJECT
+
+ public:
+  explicit FlameGraph(QWidget*);
+
+  void setTree(const ProfileNode*);
+
+ protected:
+  void paintEvent(QPaintEvent*) override;
+  void mouseMoveEvent(QMouseEvent*) override;
+  void mousePressEvent(QMouseEvent*) override;
+  void mouseDoubleClickEvent(QMouseEvent*) override;
+
+ private:
+  static const int ROW_HEIGHT = 16;
+
+  struct Box {
+    QRect rect;
+    const ProfileNode* node;
+  };
+
+  void layoutNode(const ProfileNode*, int, double, double);
+  int treeDepth(const ProfileNode*);
+  const ProfileNode* nodeAt(const QPoint&);
+  void sync();
+
+  const ProfileNode* root;
+  const ProfileNode* zoom;
+  quint64 seen;
+  QVector<Box> boxes;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_FLAMEGRAPH_H_ */
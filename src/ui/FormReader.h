@@ -0,0 +1,180 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  FormReader.h: top-level form splitter
+ **
+ **/
+#ifndef GYREUI_UI_FORMREADER_H_
+#define GYREUI_UI_FORMREADER_H_
+
+#include <QString>
+#include <QVector>
+
+namespace gyreui {
+
+/** * split mu source text into top-level forms without evaluating it **/
+class FormReader {
+ public:
+  /** * a form whose preceding comment says @independent may run in any env **/
+  struct Form {
+    QString text;
+    int line;
+    bool independent;
+  };
+
+  /** * the forms up to the end of the text or an unterminated one, whose
+        line goes in unterminated, 0 if there's none **/
+  static QVector<Form> forms(const QString& src, int* unterminated = nullptr) {
+    QVector<Form> out;
+    FormReader reader(src);
+    Form form;
+
+    while (reader.next(form)) out.push_back(form);
+    if (unterminated != nullptr) *unterminated = reader.openLine;
+
+    return out;
+  }
+
+  /** * true unless some form is still open at the end of the text **/
+  static bool complete(const QString& src) {
+    FormReader reader(src);
+
+    for (;;) {
+      reader.skipWhitespace();
+      if (reader.pos >= reader.src.size()) return true;
+      if (!reader.skipForm()) return false;
+    }
+  }
+
+  /** * next form, false at end of text or on an unterminated form, which
+        unterminated() tells apart **/
+  bool next(Form& form) {
+    marked = false;
+    skipWhitespace();
+    if (pos >= src.size()) return false;
+
+    auto start = pos;
+    form.line = line;
+    form.independent = marked;
+
+    if (!skipForm()) {
+      openLine = form.line;
+      return false;
+    }
+
+    form.text = src.mid(start, pos - start);
+    return true;
+  }
+
+  /** * the line the form next() gave up on starts, 0 at a clean end **/
+  int unterminated() const { return openLine; }
+
+  explicit FormReader(const QString& text)
+      : src(text), pos(0), line(1), marked(false), openLine(0) {}
+
+ private:
+  QChar at(int n) { return n < src.size() ? src[n] : QChar(); }
+
+  void advance() {
+    if (src[pos] == '\n') line++;
+    pos++;
+  }
+
+  void skipWhitespace() {
+    while (pos < src.size()) {
+      auto ch = src[pos];
+
+      if (ch.isSpace()) {
+        advance();
+      } else if (ch == ';') {
+        auto start = pos;
+        while (pos < src.size() && src[pos] != '\n') advance();
+        marked = src.midRef(start, pos - start).contains("@independent");
+      } else if (ch == '#' && at(pos + 1) == '|') {
+        pos += 2;
+        while (pos < src.size() && !(src[pos] == '|' && at(pos + 1) == '#'))
+          advance();
+        pos = qMin(pos + 2, src.size());
+      } else {
+        break;
+      }
+    }
+  }
+
+  bool skipString() {
+    for (advance(); pos < src.size(); advance()) {
+      if (src[pos] == '\\') {
+        advance();
+        if (pos >= src.size()) return false;
+      } else if (src[pos] == '"') {
+        advance();
+        return true;
+      }
+    }
+
+    return false;
+  }
+
+  bool skipAtom() {
+    while (pos < src.size()) {
+      auto ch = src[pos];
+
+      if (ch.isSpace() || ch == '(' || ch == ')' || ch == '"' || ch == ';')
+        break;
+      if (ch == '#' && at(pos + 1) == '\\') {
+        pos += 2;
+        if (pos >= src.size()) return false;
+      }
+      advance();
+    }
+
+    return true;
+  }
+
+  bool skipForm() {
+    auto ch = src[pos];
+
+    if (ch == '\'' || ch == '`' || ch == ',') {
+      advance();
+      if (pos < src.size() && src[pos] == '@') advance();
+      skipWhitespace();
+      return pos < src.size() && skipForm();
+    }
+
+    if (ch == '"') return skipString();
+    if (ch == '#' && at(pos + 1) == '(') advance();
+    if (src[pos] == ')') {
+      advance();
+      return true;
+    }
+    if (src[pos] != '(') return skipAtom();
+
+    advance();
+    for (;;) {
+      skipWhitespace();
+      if (pos >= src.size()) return false;
+      if (src[pos] == ')') {
+        advance();
+        return true;
+      }
+      if (!skipForm()) return false;
+    }
+  }
+
+  QString src;
+  int pos;
+  int line;
+  bool marked;
+  int openLine;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_FORMREADER_H_ */
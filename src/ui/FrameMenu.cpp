@@ -14,24 +14,36 @@
 #include <QtWidgets>
 
 #include "EnvironmentView.h"
-#include "FileView.h"
+#include "FileSystemFrame.h"
 #include "MainMenuBar.h"
 #include "MainWindow.h"
+#include "NotificationsFrame.h"
 #include "SystemView.h"
 
 namespace gyreui {
 
+/** * views are pages, setCentralWidget would delete the one it replaced **/
 void FrameMenu::envFrame() {
   mw->setContextStatus("<b>Frame|Env</b>");
-  mw->setCentralWidget(ev);
+  views->setCurrentWidget(ev);
+}
+
+void FrameMenu::fsiFrame() {
+  mw->setContextStatus("<b>Frame|File System</b>");
+  views->setCurrentWidget(fs);
+}
+
+void FrameMenu::notFrame() {
+  mw->setContextStatus("<b>Frame|Notifications</b>");
+  views->setCurrentWidget(nv);
 }
 
 void FrameMenu::sysFrame() {
   mw->setContextStatus("<b>Frame|Sys</b>");
-  mw->setCentralWidget(sv);
+  views->setCurrentWidget(sv);
 }
 
-QWidget* FrameMenu::defaultView() { return ev; }
+QWidget* FrameMenu::defaultView() { return views; }
 
 FrameMenu::FrameMenu(MainMenuBar* mb) : mb(mb) {
   mw = mb->mw;
@@ -39,8 +51,21 @@ FrameMenu::FrameMenu(MainMenuBar* mb) : mb(mb) {
   auto devEnv = new GyreEnv();
 
   ev = new EnvironmentView("environment", mw);
+  fs = new FileSystemFrame("file system", mw);
+  nv = new NotificationsFrame("notifications", mw);
   sv = new SystemView("system", mw, devEnv);
-  fv = new FileView("file system", mw);
+
+  /* files open in a composer on the system view */
+  connect(fs, &FileSystemFrame::openFile, this, [this](QString path) {
+    sv->openFile(path);
+    sysFrame();
+  });
+
+  views = new QStackedWidget();
+  views->addWidget(ev);
+  views->addWidget(fs);
+  views->addWidget(nv);
+  views->addWidget(sv);
 
 #if 0
   add(new ScriptFrame("script", this, devEnv, uiDev), "scripts");
@@ -16,9 +16,10 @@
 
 #include <QMainWindow>
 #include <QMenu>
+#include <QStackedWidget>
 
 #include "EnvironmentView.h"
-#include "FileView.h"
+#include "FileSystemFrame.h"
 #include "MainMenuBar.h"
 #include "MainWindow.h"
 #include "SystemView.h"
@@ -36,13 +37,16 @@ class MainMenuBar;
 class MainWindow;
 class EnvironmentView;
 class SystemView;
-class FileView;
+class FileSystemFrame;
+class NotificationsFrame;
 
 class FrameMenu : public QMenu {
   Q_OBJECT
 
  public:
   void envFrame();
+  void fsiFrame();
+  void notFrame();
   void sysFrame();
 
   QWidget* defaultView();
@@ -50,10 +54,12 @@ class FrameMenu : public QMenu {
   explicit FrameMenu(MainMenuBar*);
 
  private:
-  FileView* fv;
   MainMenuBar* mb;
   MainWindow* mw;
+  QStackedWidget* views;
   EnvironmentView* ev;
+  FileSystemFrame* fs;
+  NotificationsFrame* nv;
   SystemView* sv;
 };
 
@@ -14,24 +14,248 @@
 #ifndef GYREUI_UI_GYREENV_H_
 #define GYREUI_UI_GYREENV_H_
 
+#include <algorithm>
+#include <chrono>
+
 #include <QString>
+#include <QStringList>
+#include <QVector>
 
+#include "FormReader.h"
+#include "LatencyHistogram.h"
+#include "MuPrelude.h"
 #include "libmu/libmu.h"
 
 namespace gyreui {
 
 using libmu::platform::Platform;
 
+/** * a result in the history, the symbol it's held in **/
+struct HeldResult {
+  QString symbol;
+  QString source;
+  quint64 serial;
+  qint64 weight;
+};
+
+/** * phase timings of the last rep, nanoseconds **/
+struct RepTiming {
+  uint64_t read;
+  uint64_t eval;
+  uint64_t print;
+  size_t bytesIn;
+  size_t bytesOut;
+};
+
 class GyreEnv {
  public:
   QString version() { return QString(libmu::api::version()); }
 
-  QString rep(QString form) {
-    auto rval =
-        libmu::api::eval(env, libmu::api::read_string(env, form.toStdString()));
+  static const int PRINT_LEVEL = 4;
+  static const int PRINT_LENGTH = 64;
+  static const int HANDLES = 16;
+  static const qint64 HISTORY_CAP = 1 << 20;
+
+  /** * what's cut off a print, a marker for expand() in a view that can
+        follow one, or a plain ... **/
+  enum Print { ELIDED, MARKED };
+
+  /** * whether the value takes a history slot, a lookup the user didn't
+        ask the value of is UNHELD and printed ELIDED **/
+  enum Hold { HELD, UNHELD };
+
+  /** * the value of form, printed no deeper than the level, no longer
+        than the length and without following a cycle. the result stays
+        live in one of HANDLES slots, the newest as * **/
+  QString rep(QString form, Print print = ELIDED, Hold hold = HELD) {
+    typedef std::chrono::steady_clock clock;
+
+    FormReader::Form first;
+    auto slot = int(serial % HANDLES);
+    auto held = hold == HELD && FormReader(form).next(first) &&
+                holdable(first.text);
+    auto src = (held ? QString("(:defsym %1\n%2\n)")
+                           .arg(holder(slot), first.text)
+                     : form)
+                   .toStdString();
+
+    last = -1;
+
+    /* start, read, eval and print, each as its phase ends */
+    clock::time_point at[4];
+    std::string out;
+    auto phase = 0;
+
+    at[0] = clock::now();
+    try {
+      auto obj = libmu::api::read_string(env, src);
+      at[++phase] = clock::now();
+      auto rval = libmu::api::eval(env, obj);
+      at[++phase] = clock::now();
+
+      if (held) {
+        serials[slot] = ++serial;
+        last = slot;
+      }
+
+      /* a definition isn't held, its value is the symbol it defined */
+      auto str = held ? printHeld(slot, ":nil", ":nil", print == MARKED)
+                      : libmu::api::print_cstr(env, rval, true);
+
+      out = Platform::GetStdString(stdout) + str;
+
+      /* keeping the result is part of printing it */
+      if (held) remember(slot, first.text);
+      at[++phase] = clock::now();
+    } catch (...) {
+      /* the phase that raised ends here, and the timing is this form's,
+         not left over from the last one. it isn't a sample, though */
+      for (auto i = phase + 1; i < 4; ++i) at[i] = clock::now();
+
+      timing = {nsecs(at[1] - at[0]), nsecs(at[2] - at[1]),
+                nsecs(at[3] - at[2]), src.size(), 0};
+      gen++;
+      throw;
+    }
+
+    timing = {nsecs(at[1] - at[0]), nsecs(at[2] - at[1]),
+              nsecs(at[3] - at[2]), src.size(), out.size()};
+
+    readHist.record(timing.read);
+    evalHist.record(timing.eval);
+    printHist.record(timing.print);
+    gen++;
+
+    return QString::fromStdString(out);
+  }
+
+  /** * a form loading path, quoted as the reader reads a string **/
+  static QString loadForm(QString path) {
+    path.replace('\\', "\\\\").replace('"', "\\\"");
+    return "(load \"" + path + "\")";
+  }
 
+  /** * bumped by every rep, whatever it evaluated may have redefined a
+        macro **/
+  quint64 generation() const { return gen; }
+
+  /** * the expansion of form, one step or all the way, evaluating only
+        the expansion itself, so the generation stands **/
+  QString macroexpand(QString form, bool once) {
+    auto src = QString(once ? "(macroexpand-1 (:quote %1))"
+                            : "(macroexpand (:quote %1))")
+                   .arg(form)
+                   .toStdString();
+
+    auto rval = libmu::api::eval(env, libmu::api::read_string(env, src));
     auto str = std::string(libmu::api::print_cstr(env, rval, true));
-    return QString::fromStdString(Platform::GetStdString(stdout) + str);
+
+    /* whatever the expander printed isn't the next rep's output */
+    (void)Platform::GetStdString(stdout);
+    return QString::fromStdString(str);
+  }
+
+  void setPrintLimits(int level, int length) {
+    printLevel = level;
+    printLength = length;
+  }
+
+  /** * what a #<gyre:...> marker in printed output stands for, printed
+        within the limits. a slot reused since comes back as gone **/
+  QString expand(QString marker) {
+    auto fields = marker.mid(7, marker.size() - 8).split(':');
+    if (!marker.startsWith("#<gyre:") || fields.size() < 3) return marker;
+
+    auto tag = fields[0].split('.');
+    auto slot = tag[0].toInt();
+    if (tag.size() != 2 || slot < 0 || slot >= HANDLES ||
+        serials[slot] == 0 || tag[1].toULongLong() != serials[slot])
+      return "#<gyre:gone>";
+
+    QStringList rpath;
+    for (auto& step : fields[2].split('.', QString::SkipEmptyParts))
+      rpath.prepend(QString::number(step.toInt()));
+
+    auto start = fields[1] == "more" ? QString::number(fields.value(3).toInt())
+                                     : QString(":nil");
+
+    return QString::fromStdString(printHeld(
+        slot, rpath.isEmpty() ? ":nil" : "(:quote (" + rpath.join(' ') + "))",
+        start));
+  }
+
+  /** * the symbol the last rep's value is held in, empty if it wasn't **/
+  QString lastHeld() const { return last < 0 ? QString() : holder(last); }
+
+  /** * the held results, newest first **/
+  QVector<HeldResult> history() const {
+    QVector<HeldResult> out;
+
+    for (int i = 0; i < HANDLES; ++i)
+      if (serials[i] != 0)
+        out << HeldResult{holder(i), sources[i], serials[i], weights[i]};
+
+    std::sort(out.begin(), out.end(),
+              [](const HeldResult& a, const HeldResult& b) {
+                return a.serial > b.serial;
+              });
+
+    return out;
+  }
+
+  qint64 historyWeight() const {
+    qint64 total = 0;
+
+    for (int i = 0; i < HANDLES; ++i)
+      if (serials[i] != 0) total += weights[i];
+
+    return total;
+  }
+
+  /** * results are evicted oldest first while the history weighs more **/
+  void setHistoryLimit(qint64 cap) { historyCap = cap; }
+  qint64 historyLimit() const { return historyCap; }
+
+  /** * the value of form, kept live until it's unpinned. pinned() names
+        it in later forms **/
+  int pin(QString form) {
+    auto pin = freePins.isEmpty() ? pins : freePins.last();
+    evalSource(QString("(:defsym %1 %2)").arg(pinned(pin), form));
+
+    if (pin == pins)
+      pins++;
+    else
+      freePins.removeLast();
+
+    return pin;
+  }
+
+  void unpin(int pin) {
+    evalSource(QString("(:defsym %1 :nil)").arg(pinned(pin)));
+    freePins << pin;
+  }
+
+  static QString pinned(int pin) { return QString("%gyre-pin-%1").arg(pin); }
+
+  int pinCount() const { return pins - freePins.size(); }
+
+  /** * the string form evaluates to, as it reads **/
+  QString call(QString form) {
+    auto rval = libmu::api::eval(
+        env, libmu::api::read_string(env, form.toStdString()));
+
+    return QString::fromStdString(libmu::api::print_cstr(env, rval, false));
+  }
+
+  const RepTiming& lastTiming() { return timing; }
+  const LatencyHistogram& readHistogram() { return readHist; }
+  const LatencyHistogram& evalHistogram() { return evalHist; }
+  const LatencyHistogram& printHistogram() { return printHist; }
+
+  void resetHistograms() {
+    readHist.reset();
+    evalHist.reset();
+    printHist.reset();
   }
 
   QString withException(std::function<void()> fn) {
@@ -39,7 +263,19 @@ class GyreEnv {
     return QString::fromStdString(Platform::GetStdString(stderr));
   }
 
-  GyreEnv() : platform(new Platform()) {
+  GyreEnv()
+      : platform(new Platform()),
+        timing(),
+        gen(0),
+        printLevel(PRINT_LEVEL),
+        printLength(PRINT_LENGTH),
+        serial(0),
+        serials(),
+        weights(),
+        stars{-1, -1, -1},
+        historyCap(HISTORY_CAP),
+        last(-1),
+        pins(0) {
     stdout = Platform::OpenOutputString("");
     stderr = Platform::OpenOutputString("");
 
@@ -47,13 +283,128 @@ class GyreEnv {
 
     libmu::api::eval(env, libmu::api::read_string(
                               env, "(load \"/opt/gyre/src/core/mu.l\")"));
+
+    for (auto& form : FormReader::forms(MU_PRELUDE))
+      libmu::api::eval(
+          env, libmu::api::read_string(env, form.text.toStdString()));
   }
 
+  ~GyreEnv() { delete platform; }
+
  private:
+  template <typename DURATION>
+  static uint64_t nsecs(DURATION d) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+  }
+
+  /** * definitions keep their top level, anything else is held **/
+  static bool holdable(const QString& form) {
+    return !(form.startsWith('(') &&
+             form.midRef(1).trimmed().startsWith(":def"));
+  }
+
+  static QString holder(int slot) {
+    return QString("%gyre-held-%1").arg(slot);
+  }
+
+  void evalSource(const QString& src) {
+    libmu::api::eval(env, libmu::api::read_string(env, src.toStdString()));
+  }
+
+  /** * the newest result, now *. the oldest others go while the history
+        weighs more than the cap **/
+  void remember(int slot, const QString& source) {
+    static const char* const rotate[] = {"(:defsym *** **)", "(:defsym ** *)"};
+
+    for (auto src : rotate) evalSource(src);
+    evalSource(QString("(:defsym * %1)").arg(holder(slot)));
+
+    stars[2] = stars[1];
+    stars[1] = stars[0];
+    stars[0] = slot;
+
+    sources[slot] = source.trimmed().section('\n', 0, 0);
+    weights[slot] = weigh(slot);
+
+    for (auto total = historyWeight(); total > historyCap;) {
+      auto oldest = -1;
+
+      for (int i = 0; i < HANDLES; ++i)
+        if (i != slot && serials[i] != 0 &&
+            (oldest < 0 || serials[i] < serials[oldest]))
+          oldest = i;
+
+      if (oldest < 0) break;
+
+      total -= weights[oldest];
+      evict(oldest);
+    }
+  }
+
+  /** * the slot's result let go, and any of *, ** and *** that was it **/
+  void evict(int slot) {
+    static const char* const names[] = {"*", "**", "***"};
+
+    evalSource(QString("(:defsym %1 :nil)").arg(holder(slot)));
+
+    for (int i = 0; i < 3; ++i)
+      if (stars[i] == slot) {
+        evalSource(QString("(:defsym %1 :nil)").arg(names[i]));
+        stars[i] = -1;
+      }
+
+    serials[slot] = 0;
+    weights[slot] = 0;
+    sources[slot].clear();
+  }
+
+  /** * what the slot's result reaches, walked in one call and no further
+        than the cap. cycles aren't followed, and parts shared close
+        together count once **/
+  qint64 weigh(int slot) {
+    auto status =
+        call(QString("(%gyre-weight %1 %2)").arg(holder(slot)).arg(historyCap));
+
+    return status.section(' ', 0, 0).toLongLong();
+  }
+
+  /** * the held object at rpath, a mu form for the path innermost first.
+        unmarked, what's cut off is just ... **/
+  std::string printHeld(int slot, QString rpath, QString start,
+                        bool marked = true) {
+    auto tag = marked ? QString("\"%1.%2\"").arg(slot).arg(serials[slot])
+                      : QString(":nil");
+    auto src = QString("(%gyre-print %1 %2 %3 %4 %5 %6)")
+                   .arg(holder(slot), rpath, start, tag,
+                        QString::number(printLevel),
+                        QString::number(printLength));
+
+    auto rval = libmu::api::eval(
+        env, libmu::api::read_string(env, src.toStdString()));
+
+    return libmu::api::print_cstr(env, rval, false);
+  }
+
   Platform* platform;
   Platform::StreamId stdout;
   Platform::StreamId stderr;
   void* env;
+  RepTiming timing;
+  quint64 gen;
+  int printLevel;
+  int printLength;
+  quint64 serial;
+  quint64 serials[HANDLES];
+  qint64 weights[HANDLES];
+  QString sources[HANDLES];
+  int stars[3];
+  qint64 historyCap;
+  int last;
+  int pins;
+  QVector<int> freePins;
+  LatencyHistogram readHist;
+  LatencyHistogram evalHist;
+  LatencyHistogram printHist;
 };
 
 }  // namespace gyreui
@@ -0,0 +1,161 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  History.cpp: persistent repl history implementation
+ **
+ **  one entry per line, newlines and backslashes escaped. writers
+ **  append under flock and then read their own line back with
+ **  everybody else's, so every console sees one order.
+ **
+ **/
+#include "History.h"
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+
+namespace gyreui {
+
+namespace {
+
+QByteArray escape(const QString& text) {
+  QByteArray out;
+
+  for (auto ch : text.toUtf8()) {
+    if (ch == '\\')
+      out += "\\\\";
+    else if (ch == '\n')
+      out += "\\n";
+    else
+      out += ch;
+  }
+
+  return out + '\n';
+}
+
+QString unescape(const QByteArray& line) {
+  QByteArray out;
+
+  for (int i = 0; i < line.size(); ++i) {
+    if (line[i] == '\\' && i + 1 < line.size()) {
+      out += line[++i] == 'n' ? '\n' : line[i];
+    } else {
+      out += line[i];
+    }
+  }
+
+  return QString::fromUtf8(out);
+}
+
+}  // namespace
+
+History* History::instance() {
+  static History history(QDir::home().filePath(".gyre-ui-history"));
+
+  return &history;
+}
+
+/** * one bit per folded character class, for cheap rejection **/
+quint64 History::charMask(const QString& folded) {
+  quint64 mask = 0;
+
+  for (auto ch : folded) mask |= 1ULL << (ch.unicode() % 64);
+
+  return mask;
+}
+
+/** * query characters appear in order in text **/
+bool History::fuzzy(const QString& query, const QString& text) {
+  int qp = 0;
+
+  for (int tp = 0; tp < text.size() && qp < query.size(); ++tp)
+    if (text[tp] == query[qp]) qp++;
+
+  return qp == query.size();
+}
+
+/** * pick up complete lines appended since the last look **/
+void History::refresh() {
+  QFile f(path);
+
+  if (QFileInfo(path).size() <= loaded || !f.open(QFile::ReadOnly)) return;
+
+  f.seek(loaded);
+  auto tail = f.readAll();
+
+  int start = 0;
+  for (int nl = tail.indexOf('\n'); nl >= 0; nl = tail.indexOf('\n', start)) {
+    auto text = unescape(tail.mid(start, nl - start));
+    auto folded = text.toCaseFolded();
+
+    if (!text.isEmpty() && (entries.isEmpty() || entries.last().text != text))
+      entries.push_back({text, folded, charMask(folded)});
+
+    start = nl + 1;
+  }
+
+  loaded += start;
+}
+
+void History::append(QString text) {
+  if (text.trimmed().isEmpty()) return;
+
+  std::lock_guard<std::mutex> guard(lock);
+
+  auto fd = open(QFile::encodeName(path).constData(),
+                 O_WRONLY | O_APPEND | O_CREAT, 0600);
+  if (fd >= 0) {
+    auto line = escape(text);
+
+    flock(fd, LOCK_EX);
+    (void)write(fd, line.constData(), line.size());
+    flock(fd, LOCK_UN);
+    close(fd);
+  }
+
+  refresh();
+}
+
+int History::size() {
+  std::lock_guard<std::mutex> guard(lock);
+
+  refresh();
+  return entries.size();
+}
+
+QString History::at(int index) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  return (index >= 0 && index < entries.size()) ? entries[index].text
+                                                 : QString();
+}
+
+int History::search(QString query, int before) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  auto folded = query.toCaseFolded();
+  auto mask = charMask(folded);
+
+  for (int i = qMin(before, entries.size()) - 1; i >= 0; --i) {
+    auto& entry = entries[i];
+
+    if ((entry.mask & mask) == mask && fuzzy(folded, entry.folded)) return i;
+  }
+
+  return -1;
+}
+
+History::History(QString path) : path(path), loaded(0) { refresh(); }
+
+}  // namespace gyreui
@@ -0,0 +1,58 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  History.h: persistent repl history
+ **
+ **/
+#ifndef GYREUI_UI_HISTORY_H_
+#define GYREUI_UI_HISTORY_H_
+
+#include <mutex>
+
+#include <QString>
+#include <QVector>
+
+namespace gyreui {
+
+/** * append-only log in ~/.gyre-ui-history, shared by every console **/
+class History {
+ public:
+  static History* instance();
+
+  void append(QString);
+  int size();
+  QString at(int);
+
+  /** * newest entry before index that fuzzy-matches query, or -1 **/
+  int search(QString, int);
+
+ private:
+  struct Entry {
+    QString text;
+    QString folded;
+    quint64 mask;
+  };
+
+  static quint64 charMask(const QString&);
+  static bool fuzzy(const QString&, const QString&);
+
+  void refresh();
+
+  explicit History(QString);
+
+  std::mutex lock;
+  QString path;
+  qint64 loaded;
+  QVector<Entry> entries;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_HISTORY_H_ */
@@ -11,11 +11,15 @@
  **  InspectorFrame.cpp: InspectorFrame implementation
  **
  **/
+#include <QApplication>
+#include <QClipboard>
 #include <QFileDialog>
 #include <QLabel>
+#include <QMenu>
 #include <QString>
 #include <QTextEdit>
 #include <QToolBar>
+#include <QToolButton>
 #include <QtWidgets>
 
 #include "ComposerFrame.h"
@@ -24,21 +28,186 @@
 
 namespace gyreui {
 
+namespace {
+
+QString nsTime(uint64_t ns) {
+  if (ns < 1000) return QString("%1ns").arg(ns);
+  if (ns < 1000000) return QString("%1us").arg(ns / 1000.0, 0, 'f', 1);
+  if (ns < 1000000000) return QString("%1ms").arg(ns / 1000000.0, 0, 'f', 1);
+
+  return QString("%1s").arg(ns / 1000000000.0, 0, 'f', 2);
+}
+
+QString byteCount(size_t nbytes) {
+  if (nbytes < 1024) return QString("%1B").arg(nbytes);
+  if (nbytes < 1024 * 1024)
+    return QString("%1KB").arg(nbytes / 1024.0, 0, 'f', 1);
+
+  return QString("%1MB").arg(nbytes / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+QString quantiles(const char* phase, const LatencyHistogram& hist) {
+  return QString("%1 %2/%3/%4")
+      .arg(phase, nsTime(hist.percentile(0.50)), nsTime(hist.percentile(0.99)),
+           nsTime(hist.max()));
+}
+
+const int NAME_MAX = 60;
+
+} /* anonymous namespace */
+
+void InspectorFrame::showTiming() {
+  auto timing = devEnv->lastTiming();
+
+  timeLabel->setText(QString("read %1  eval %2  print %3  in %4  out %5")
+                         .arg(nsTime(timing.read), nsTime(timing.eval),
+                              nsTime(timing.print), byteCount(timing.bytesIn),
+                              byteCount(timing.bytesOut)));
+
+  viewLabel->setText(
+      QString("p50/p99/max  %1  %2  %3  (%4 evals)")
+          .arg(quantiles("read", devEnv->readHistogram()),
+               quantiles("eval", devEnv->evalHistogram()),
+               quantiles("print", devEnv->printHistogram()))
+          .arg(devEnv->evalHistogram().count()));
+}
+
+/** * the value of form, under the first line of name **/
+void InspectorFrame::inspect(QString form, QString name) {
+  name = name.trimmed().section('\n', 0, 0).left(NAME_MAX);
+
+  if (form.trimmed().isEmpty()) {
+    objectModel->clear();
+  } else if (objectModel->inspect(name, form)) {
+    statusLabel->clear();
+    objectView->expand(objectModel->index(0, 0, QModelIndex()));
+  }
+
+  showObjects();
+}
+
+/** * the results the env still holds, newest first **/
+void InspectorFrame::historyMenu() {
+  static const char* const stars[] = {"*", "**", "***"};
+  auto held = devEnv->history();
+
+  results->clear();
+
+  for (int i = 0; i < held.size(); ++i) {
+    auto result = held[i];
+    auto label = i < 3 ? QString(stars[i]) : QString("#%1").arg(result.serial);
+
+    results->addAction(
+        tr("%1  %2  (%3%4 units)")
+            .arg(label, result.source.left(NAME_MAX))
+            .arg(qMin(result.weight, devEnv->historyLimit()))
+            .arg(result.weight > devEnv->historyLimit() ? "+" : ""),
+        [this, label, result]() {
+          inspect(result.symbol, label + " " + result.source);
+        });
+  }
+
+  if (!held.isEmpty()) results->addSeparator();
+
+  results->addAction(tr("%1 results, %2 of %3 units")
+                         .arg(held.size())
+                         .arg(devEnv->historyWeight())
+                         .arg(devEnv->historyLimit()))
+      ->setEnabled(false);
+}
+
+void InspectorFrame::showObjects() {
+  mw->setContextStatus(tr("%1 objects, %2 pinned")
+                           .arg(objectModel->objects())
+                           .arg(objectModel->pins()));
+}
+
+void InspectorFrame::contextMenu(const QPoint& at) {
+  auto index = objectView->indexAt(at);
+  if (!index.isValid()) return;
+
+  auto form = objectModel->form(index);
+  auto name =
+      objectModel->data(index.sibling(index.row(), InspectorModel::NAME),
+                        Qt::DisplayRole)
+          .toString();
+
+  QMenu menu;
+  menu.addAction(tr("inspect"),
+                 [this, form, name]() { inspect(form, name); });
+  menu.addAction(tr("copy value"), [this, index]() {
+    QApplication::clipboard()->setText(
+        objectModel
+            ->data(index.sibling(index.row(), InspectorModel::VALUE),
+                   Qt::DisplayRole)
+            .toString());
+  });
+
+  menu.exec(objectView->viewport()->mapToGlobal(at));
+}
+
 void InspectorFrame::clear() {
-  //  edit_text->setText("");
+  devEnv->resetHistograms();
+  timeLabel->setText("");
+  viewLabel->setText("");
 }
 
 InspectorFrame::InspectorFrame(QString name, MainWindow* tb, GyreEnv* env)
     : mw(tb), devEnv(env), name(name) {
   composerFrame = new ComposerFrame("inspector", tb, env);
-  viewLabel = new QLabel("view info");
-  timeLabel = new QLabel("time info");
+  viewLabel = new QLabel();
+  timeLabel = new QLabel();
   toolBar = new QToolBar();
+  connect(toolBar->addAction(tr("clear timing")), &QAction::triggered, this,
+          &InspectorFrame::clear);
+
+  formEdit = new QLineEdit();
+  formEdit->setPlaceholderText(tr("inspect form"));
+  toolBar->addWidget(formEdit);
+
+  auto historyButton = new QToolButton(toolBar);
+  historyButton->setToolButtonStyle(Qt::ToolButtonTextOnly);
+  historyButton->setText(tr("history"));
+  historyButton->setPopupMode(QToolButton::InstantPopup);
+
+  results = new QMenu(historyButton);
+  historyButton->setMenu(results);
+  connect(results, &QMenu::aboutToShow, this, &InspectorFrame::historyMenu);
+
+  toolBar->addWidget(historyButton);
+
+  connect(toolBar->addAction(tr("collapse")), &QAction::triggered, this,
+          [this]() { objectView->collapseAll(); });
+
+  objectModel = new InspectorModel(env, this);
+  objectView = new QTreeView();
+  objectView->setModel(objectModel);
+  objectView->setUniformRowHeights(true);
+  objectView->setContextMenuPolicy(Qt::CustomContextMenu);
+  objectView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+  statusLabel = new QLabel();
+  statusLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+
+  connect(composerFrame, &ComposerFrame::evalHappened, this,
+          [this](QString text) {
+            showTiming();
+            inspect(devEnv->lastHeld(), text);
+          });
+  connect(formEdit, &QLineEdit::returnPressed, this,
+          [this]() { inspect(formEdit->text(), formEdit->text()); });
+  connect(objectModel, &InspectorModel::failed, statusLabel, &QLabel::setText);
+  connect(objectModel, &QAbstractItemModel::rowsInserted, this,
+          &InspectorFrame::showObjects);
+  connect(objectView, &QTreeView::customContextMenuRequested, this,
+          &InspectorFrame::contextMenu);
 
   auto layout = new QVBoxLayout;
   layout->setContentsMargins(5, 5, 5, 5);
   layout->addWidget(toolBar);
   layout->addWidget(composerFrame);
+  layout->addWidget(objectView);
+  layout->addWidget(statusLabel);
   layout->addWidget(timeLabel);
   layout->addWidget(viewLabel);
 
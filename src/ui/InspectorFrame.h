@@ -16,18 +16,25 @@
 
 #include <QFrame>
 #include <QLabel>
+#include <QLineEdit>
+#include <QMenu>
 #include <QTextEdit>
 #include <QToolBar>
+#include <QTreeView>
 #include <QWidget>
 
 #include "ComposerFrame.h"
 #include "GyreEnv.h"
+#include "InspectorModel.h"
 #include "MainWindow.h"
 
 QT_BEGIN_NAMESPACE
 class QLabel;
+class QLineEdit;
+class QMenu;
 class QTextEdit;
 class QToolBar;
+class QTreeView;
 class QVBoxLayout;
 class QWidget;
 QT_END_NAMESPACE
@@ -37,6 +44,8 @@ namespace gyreui {
 class MainWindow;
 class MainWindow;
 
+/** * eval timings, and the last result or any form's value as a tree of
+      its parts, fetched a page at a time as they're opened **/
 class InspectorFrame : public QFrame {
   Q_OBJECT
 
@@ -46,6 +55,11 @@ class InspectorFrame : public QFrame {
  private:
   void clear();
   void eval();
+  void showTiming();
+  void inspect(QString, QString);
+  void historyMenu();
+  void showObjects();
+  void contextMenu(const QPoint&);
 
   void log(QString msg) { mw->log(msg); }
 
@@ -55,7 +69,11 @@ class InspectorFrame : public QFrame {
   GyreEnv* devEnv;
   QString name;
   ComposerFrame* composerFrame;
-  ;
+  InspectorModel* objectModel;
+  QTreeView* objectView;
+  QLineEdit* formEdit;
+  QMenu* results;
+  QLabel* statusLabel;
   QLabel* viewLabel;
   QLabel* timeLabel;
   QToolBar* toolBar;
@@ -0,0 +1,378 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  InspectorModel.cpp: live object tree model implementation
+ **
+ **  a node is a mu form for its object, a step from its parent's pin. it
+ **  is pinned itself only when it's opened, and its parts are fetched a
+ **  page of records at a time. a list is paged from a pin on the tail
+ **  the last page stopped at, so a page costs its own length wherever
+ **  it starts. the pins are dropped with the tree.
+ **
+ **/
+#include "InspectorModel.h"
+
+#include <QByteArray>
+#include <QList>
+
+namespace gyreui {
+
+namespace {
+
+struct Record {
+  int step;
+  QString type;
+  bool opens;
+  QString value;
+};
+
+/** * the record at at, step type opens length:value. the length is mu's,
+      in bytes of utf-8, so records are read from the encoded text **/
+bool nextRecord(const QByteArray& text, int& at, Record& record) {
+  QList<QByteArray> fields;
+
+  for (int i = 0; i < 3; ++i) {
+    auto space = text.indexOf(' ', at);
+    if (space < 0) return false;
+
+    fields << text.mid(at, space - at);
+    at = space + 1;
+  }
+
+  auto colon = text.indexOf(':', at);
+  if (colon < 0) return false;
+
+  bool ok;
+  auto length = text.mid(at, colon - at).toInt(&ok);
+  if (!ok || length < 0 || colon + 1 + length > text.size()) return false;
+
+  record = {fields[0].toInt(), QString::fromUtf8(fields[1]), fields[2] == "1",
+            QString::fromUtf8(text.mid(colon + 1, length))};
+  at = colon + 1 + length;
+
+  return true;
+}
+
+}  // namespace
+
+/** * tree **/
+InspectorModel::Node* InspectorModel::nodeOf(const QModelIndex& index) const {
+  return index.isValid() ? static_cast<Node*>(index.internalPointer())
+                         : rootNode;
+}
+
+QModelIndex InspectorModel::indexOf(Node* node) const {
+  return node == rootNode ? QModelIndex() : createIndex(node->row, 0, node);
+}
+
+InspectorModel::Node* InspectorModel::makeNode(Node* parent, QString name,
+                                               QString ref) {
+  auto node = new Node;
+
+  node->name = name;
+  node->parent = parent;
+  node->row = parent == nullptr ? 0 : parent->children.size();
+  node->ref = ref;
+  node->opens = false;
+  node->pin = -1;
+  node->cursor = -1;
+  node->base = 0;
+  node->size = -1;
+  node->more = false;
+
+  nodes++;
+  return node;
+}
+
+void InspectorModel::freeNode(Node* node) {
+  for (auto child : node->children) freeNode(child);
+
+  nodes--;
+  delete node;
+}
+
+/** * model **/
+QModelIndex InspectorModel::index(int row, int column,
+                                  const QModelIndex& parent) const {
+  auto node = nodeOf(parent);
+
+  if (row < 0 || row >= node->children.size() || column < 0 ||
+      column >= COLUMNS)
+    return QModelIndex();
+
+  return createIndex(row, column, node->children[row]);
+}
+
+QModelIndex InspectorModel::parent(const QModelIndex& index) const {
+  if (!index.isValid()) return QModelIndex();
+
+  return indexOf(nodeOf(index)->parent);
+}
+
+int InspectorModel::rowCount(const QModelIndex& parent) const {
+  return parent.column() > 0 ? 0 : nodeOf(parent)->children.size();
+}
+
+int InspectorModel::columnCount(const QModelIndex&) const { return COLUMNS; }
+
+QVariant InspectorModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid()) return QVariant();
+
+  auto node = nodeOf(index);
+
+  switch (role) {
+    case Qt::DisplayRole:
+      switch (index.column()) {
+        case NAME:
+          return node->name;
+        case TYPE:
+          return node->type;
+        case SIZE:
+          if (node->pin < 0 || (!node->opens && node->size <= 0))
+            return QVariant();
+          if (node->size >= 0) return node->size;
+          return QString("%1%2")
+              .arg(node->children.size())
+              .arg(node->more ? "+" : "");
+        case VALUE:
+          return node->value;
+        default:
+          return QVariant();
+      }
+    case Qt::TextAlignmentRole:
+      if (index.column() != SIZE) return QVariant();
+      return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+    case Qt::ToolTipRole:
+      return node->value;
+    default:
+      return QVariant();
+  }
+}
+
+QVariant InspectorModel::headerData(int section, Qt::Orientation orientation,
+                                    int role) const {
+  static const char* names[] = {QT_TR_NOOP("name"), QT_TR_NOOP("type"),
+                                QT_TR_NOOP("size"), QT_TR_NOOP("value")};
+
+  if (orientation != Qt::Horizontal || role != Qt::DisplayRole ||
+      section < 0 || section >= COLUMNS)
+    return QVariant();
+
+  return tr(names[section]);
+}
+
+bool InspectorModel::hasChildren(const QModelIndex& parent) const {
+  auto node = nodeOf(parent);
+
+  if (parent.column() > 0) return false;
+  if (node == rootNode) return !node->children.isEmpty();
+
+  return node->opens && (node->more || !node->children.isEmpty());
+}
+
+bool InspectorModel::canFetchMore(const QModelIndex& parent) const {
+  auto node = nodeOf(parent);
+
+  return node != rootNode && node->opens && node->more;
+}
+
+void InspectorModel::fetchMore(const QModelIndex& parent) {
+  page(nodeOf(parent));
+}
+
+bool InspectorModel::inspect(QString name, QString form) {
+  auto node = makeNode(rootNode, name, form);
+  auto old = pinned;
+
+  /* pinned now, before whatever form names can change, and before the
+     tree it may be part of goes */
+  pinned.clear();
+  if (!open(node)) {
+    freeNode(node);
+    pinned = old + pinned;
+    return false;
+  }
+
+  beginResetModel();
+
+  for (auto child : rootNode->children) freeNode(child);
+  rootNode->children = {node};
+  node->row = 0;
+  release(old);
+
+  endResetModel();
+
+  return true;
+}
+
+void InspectorModel::clear() {
+  beginResetModel();
+
+  for (auto child : rootNode->children) freeNode(child);
+  rootNode->children.clear();
+  release(pinned);
+  pinned.clear();
+
+  endResetModel();
+}
+
+QString InspectorModel::form(const QModelIndex& index) const {
+  auto node = nodeOf(index);
+
+  return node->pin < 0 ? node->ref : GyreEnv::pinned(node->pin);
+}
+
+/** * objects **/
+int InspectorModel::pin(QString form) {
+  int pin = -1;
+
+  auto error = devEnv->withException(
+      [this, &form, &pin]() { pin = devEnv->pin(form); });
+
+  if (!error.isEmpty() || pin < 0) {
+    emit failed(error.trimmed());
+    return -1;
+  }
+
+  pinned << pin;
+  return pin;
+}
+
+void InspectorModel::release(const QVector<int>& pins) {
+  for (auto pin : pins)
+    devEnv->withException([this, pin]() { devEnv->unpin(pin); });
+}
+
+bool InspectorModel::call(QString form, QString& out) {
+  auto error = devEnv->withException(
+      [this, &form, &out]() { out = devEnv->call(form); });
+
+  if (!error.isEmpty()) emit failed(error.trimmed());
+
+  return error.isEmpty();
+}
+
+/** * pinned, with its size and print, the first time it's opened **/
+bool InspectorModel::open(Node* node) {
+  if (node->pin >= 0) return true;
+
+  /* one that can't be opened shows as a leaf */
+  node->opens = node->more = false;
+
+  auto pin = this->pin(node->ref);
+  if (pin < 0) return false;
+
+  QString text;
+  if (!call(QString("(%gyre-describe %1)").arg(GyreEnv::pinned(pin)), text))
+    return false;
+
+  Record record;
+  auto bytes = text.toUtf8();
+  auto space = bytes.indexOf(' ');
+  auto at = space + 1;
+
+  if (space < 0 || !nextRecord(bytes, at, record)) {
+    emit failed(tr("can't describe %1: %2").arg(node->name, text));
+    return false;
+  }
+
+  bool counted;
+  node->size = bytes.left(space).toInt(&counted);
+  if (!counted) node->size = -1;
+
+  node->pin = node->cursor = pin;
+  node->type = record.type;
+  node->value = record.value;
+  node->opens = record.opens;
+  node->more = record.opens && node->size != 0;
+
+  return true;
+}
+
+void InspectorModel::page(Node* node) {
+  if (!open(node) || !node->more) return;
+
+  auto list = node->size < 0;
+  auto start = node->children.size();
+  auto from = GyreEnv::pinned(list ? node->cursor : node->pin);
+
+  QString text;
+  if (!call(QString("(%gyre-page %1 %2 %3)")
+                .arg(from)
+                .arg(list ? 0 : start)
+                .arg(PAGE),
+            text)) {
+    node->more = false;
+    return;
+  }
+
+  QVector<Node*> added;
+  auto more = false;
+  auto bytes = text.toUtf8();
+  Record record;
+
+  for (int at = 0; at < bytes.size();) {
+    if (bytes.mid(at) == "more") {
+      more = true;
+      break;
+    }
+
+    if (!nextRecord(bytes, at, record)) break;
+
+    auto name = !list ? QString::number(record.step)
+                : record.step < 0 ? QString(".")
+                                  : QString::number(node->base + record.step);
+    auto child = makeNode(
+        node, name, QString("(%gyre-step %1 %2)").arg(from).arg(record.step));
+
+    child->row = start + added.size();
+    child->type = record.type;
+    child->value = record.value;
+    child->opens = record.opens;
+    child->more = record.opens;
+
+    added << child;
+  }
+
+  if (!added.isEmpty()) {
+    beginInsertRows(indexOf(node), start, start + added.size() - 1);
+    node->children += added;
+    endInsertRows();
+  }
+
+  if (list && more) {
+    auto tail = pin(QString("(%gyre-nthcdr %1 %2)").arg(PAGE).arg(from));
+
+    more = tail >= 0;
+    if (more) {
+      node->cursor = tail;
+      node->base += PAGE;
+    }
+  }
+
+  if (added.isEmpty())
+    node->more = false;
+  else
+    node->more = list ? more : node->children.size() < node->size;
+
+  auto index = indexOf(node);
+  emit dataChanged(index.sibling(index.row(), SIZE),
+                   index.sibling(index.row(), SIZE));
+}
+
+InspectorModel::InspectorModel(GyreEnv* env, QObject* parent)
+    : QAbstractItemModel(parent), devEnv(env), nodes(0) {
+  rootNode = makeNode(nullptr, QString(), QString());
+}
+
+/** * what's still pinned goes with the env **/
+InspectorModel::~InspectorModel() { freeNode(rootNode); }
+
+}  // namespace gyreui
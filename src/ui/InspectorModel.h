@@ -0,0 +1,98 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  InspectorModel.h: live object tree model
+ **
+ **/
+#ifndef GYREUI_UI_INSPECTORMODEL_H_
+#define GYREUI_UI_INSPECTORMODEL_H_
+
+#include <QAbstractItemModel>
+#include <QString>
+#include <QVector>
+
+#include "GyreEnv.h"
+
+namespace gyreui {
+
+class InspectorModel : public QAbstractItemModel {
+  Q_OBJECT
+
+ public:
+  enum Column { NAME, TYPE, SIZE, VALUE, COLUMNS };
+
+  static const int PAGE = 256;
+
+  QModelIndex index(int, int, const QModelIndex&) const override;
+  QModelIndex parent(const QModelIndex&) const override;
+  int rowCount(const QModelIndex&) const override;
+  int columnCount(const QModelIndex&) const override;
+  QVariant data(const QModelIndex&, int) const override;
+  QVariant headerData(int, Qt::Orientation, int) const override;
+
+  /** * parts are fetched a page at a time as the view asks for them **/
+  bool hasChildren(const QModelIndex&) const override;
+  bool canFetchMore(const QModelIndex&) const override;
+  void fetchMore(const QModelIndex&) override;
+
+  /** * the value of a mu form, named **/
+  bool inspect(QString, QString);
+  void clear();
+
+  /** * the form for the object at index, valid while it's inspected **/
+  QString form(const QModelIndex&) const;
+
+  int objects() const { return nodes - 1; }
+  int pins() const { return pinned.size(); }
+
+  explicit InspectorModel(GyreEnv*, QObject*);
+  ~InspectorModel();
+
+ signals:
+  void failed(QString);
+
+ private:
+  struct Node {
+    QString name;
+    Node* parent;
+    int row;
+    QString ref;
+    QString type;
+    QString value;
+    bool opens;
+    int pin;
+    int cursor;
+    int base;
+    int size;
+    bool more;
+    QVector<Node*> children;
+  };
+
+  Node* nodeOf(const QModelIndex&) const;
+  QModelIndex indexOf(Node*) const;
+
+  Node* makeNode(Node*, QString, QString);
+  void freeNode(Node*);
+
+  bool open(Node*);
+  void page(Node*);
+  int pin(QString);
+  void release(const QVector<int>&);
+  bool call(QString, QString&);
+
+  GyreEnv* devEnv;
+  Node* rootNode;
+  int nodes;
+  QVector<int> pinned;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_INSPECTORMODEL_H_ */
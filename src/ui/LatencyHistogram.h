@@ -0,0 +1,87 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  LatencyHistogram.h: log-linear latency histogram
+ **
+ **/
+#ifndef GYREUI_UI_LATENCYHISTOGRAM_H_
+#define GYREUI_UI_LATENCYHISTOGRAM_H_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+namespace gyreui {
+
+/** * HDR-style buckets: power of two magnitude, 32 linear sub-buckets **/
+class LatencyHistogram {
+ public:
+  static const int SUB_BITS = 5;
+  static const int SUB_BUCKETS = 1 << SUB_BITS;
+  static const int MAGNITUDES = 64 - SUB_BITS;
+
+  void record(uint64_t ns) {
+    counts[index(ns)]++;
+    total++;
+    maxValue = std::max(maxValue, ns);
+  }
+
+  void reset() {
+    counts.fill(0);
+    total = 0;
+    maxValue = 0;
+  }
+
+  uint64_t count() const { return total; }
+  uint64_t max() const { return maxValue; }
+
+  /** * upper bound of the bucket holding the q-quantile **/
+  uint64_t percentile(double q) const {
+    if (total == 0) return 0;
+
+    auto rank = static_cast<uint64_t>(q * total + 0.5);
+    rank = std::max<uint64_t>(1, std::min(rank, total));
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+      seen += counts[i];
+      if (seen >= rank) return std::min(upper(i), maxValue);
+    }
+
+    return maxValue;
+  }
+
+  LatencyHistogram() : total(0), maxValue(0) { counts.fill(0); }
+
+ private:
+  static size_t index(uint64_t v) {
+    if (v < SUB_BUCKETS) return v;
+
+    int mag = 63 - __builtin_clzll(v) - SUB_BITS;
+    return (mag + 1) * SUB_BUCKETS + ((v >> mag) - SUB_BUCKETS);
+  }
+
+  static uint64_t upper(size_t i) {
+    if (i < SUB_BUCKETS) return i;
+
+    size_t mag = i / SUB_BUCKETS - 1;
+    uint64_t sub = i % SUB_BUCKETS;
+
+    return ((SUB_BUCKETS + sub) << mag) + ((1ULL << mag) - 1);
+  }
+
+  std::array<uint64_t, (MAGNITUDES + 1) * SUB_BUCKETS> counts;
+  uint64_t total;
+  uint64_t maxValue;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_LATENCYHISTOGRAM_H_ */
@@ -0,0 +1,138 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Layout.cpp: persistent tile layout implementation
+ **
+ **  the tile tree goes to ~/.gyre-ui-layout as compact json. a frame
+ **  is its type plus whatever FrameState it keeps. frames come back
+ **  as PendingFrames, which build the real frame when first shown, so
+ **  a view nobody opens costs nothing at startup.
+ **
+ **/
+#include "Layout.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QVBoxLayout>
+
+namespace gyreui {
+
+namespace {
+
+const char* FRAME_TYPE = "gyreFrameType";
+
+}  // namespace
+
+/** * pending frame **/
+QJsonObject PendingFrame::state() const {
+  return frame == nullptr ? saved : LayoutStore::frameState(frame);
+}
+
+void PendingFrame::showEvent(QShowEvent* event) {
+  QFrame::showEvent(event);
+
+  if (frame != nullptr) return;
+
+  frame = factory(type());
+  if (frame == nullptr) return;
+
+  if (auto state = dynamic_cast<FrameState*>(frame))
+    state->restoreState(saved);
+
+  layout()->addWidget(frame);
+}
+
+PendingFrame::PendingFrame(const QJsonObject& saved, Factory factory)
+    : saved(saved), factory(factory), frame(nullptr) {
+  auto layout = new QVBoxLayout;
+  layout->setContentsMargins(0, 0, 0, 0);
+
+  setLayout(layout);
+}
+
+/** * store **/
+LayoutStore* LayoutStore::instance() {
+  static LayoutStore store;
+
+  return &store;
+}
+
+void LayoutStore::setFrameType(QFrame* frame, QString type) {
+  frame->setProperty(FRAME_TYPE, type);
+}
+
+QString LayoutStore::frameType(QFrame* frame) {
+  if (auto pending = qobject_cast<PendingFrame*>(frame))
+    return pending->type();
+
+  return frame->property(FRAME_TYPE).toString();
+}
+
+/** * empty for frames with no type **/
+QJsonObject LayoutStore::frameState(QFrame* frame) {
+  if (auto pending = qobject_cast<PendingFrame*>(frame))
+    return pending->state();
+
+  auto type = frameType(frame);
+  if (type.isEmpty()) return QJsonObject();
+
+  auto state = dynamic_cast<FrameState*>(frame);
+  auto out = state == nullptr ? QJsonObject() : state->saveState();
+
+  out["type"] = type;
+  return out;
+}
+
+/** * nullptr for an empty pane **/
+QFrame* LayoutStore::restoreFrame(const QJsonObject& state,
+                                  PendingFrame::Factory factory) {
+  if (!state.contains("type")) return nullptr;
+
+  return new PendingFrame(state, factory);
+}
+
+QJsonObject LayoutStore::load() {
+  QFile file(path);
+
+  if (!file.open(QFile::ReadOnly)) return QJsonObject();
+
+  written = file.readAll();
+  return QJsonDocument::fromJson(written).object();
+}
+
+/** * unchanged layouts aren't rewritten **/
+void LayoutStore::save() {
+  saveTimer->stop();
+  if (!source) return;
+
+  auto bytes = QJsonDocument(source()).toJson(QJsonDocument::Compact);
+  if (bytes == written) return;
+
+  QSaveFile file(path);
+  if (!file.open(QIODevice::WriteOnly)) return;
+
+  file.write(bytes);
+  if (file.commit()) written = bytes;
+}
+
+LayoutStore::LayoutStore() : path(QDir::home().filePath(".gyre-ui-layout")) {
+  saveTimer = new QTimer(this);
+  saveTimer->setSingleShot(true);
+  saveTimer->setInterval(SAVE_MSECS);
+  connect(saveTimer, &QTimer::timeout, this, &LayoutStore::save);
+
+  connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this,
+          &LayoutStore::save);
+}
+
+}  // namespace gyreui
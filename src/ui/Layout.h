@@ -0,0 +1,91 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Layout.h: persistent tile layout
+ **
+ **/
+#ifndef GYREUI_UI_LAYOUT_H_
+#define GYREUI_UI_LAYOUT_H_
+
+#include <functional>
+
+#include <QByteArray>
+#include <QFrame>
+#include <QJsonObject>
+#include <QObject>
+#include <QShowEvent>
+#include <QString>
+#include <QTimer>
+
+namespace gyreui {
+
+/** * frames with more to keep than their type **/
+class FrameState {
+ public:
+  virtual QJsonObject saveState() const = 0;
+  virtual void restoreState(const QJsonObject&) = 0;
+
+  virtual ~FrameState() = default;
+};
+
+/** * a saved frame, built the first time it is shown **/
+class PendingFrame : public QFrame {
+  Q_OBJECT
+
+ public:
+  typedef std::function<QFrame*(QString)> Factory;
+
+  QString type() const { return saved["type"].toString(); }
+  QJsonObject state() const;
+
+  PendingFrame(const QJsonObject&, Factory);
+
+ protected:
+  void showEvent(QShowEvent*) override;
+
+ private:
+  QJsonObject saved;
+  Factory factory;
+  QFrame* frame;
+};
+
+/** * the layout file, rewritten a little after the last change **/
+class LayoutStore : public QObject {
+  Q_OBJECT
+
+ public:
+  static const int SAVE_MSECS = 2000;
+
+  static LayoutStore* instance();
+
+  /** * frame types are factory keys **/
+  static void setFrameType(QFrame*, QString);
+  static QString frameType(QFrame*);
+  static QJsonObject frameState(QFrame*);
+  static QFrame* restoreFrame(const QJsonObject&, PendingFrame::Factory);
+
+  QJsonObject load();
+  void setSource(std::function<QJsonObject()> fn) { source = fn; }
+
+  void changed() { saveTimer->start(); }
+  void save();
+
+ private:
+  LayoutStore();
+
+  QString path;
+  QByteArray written;
+  std::function<QJsonObject()> source;
+  QTimer* saveTimer;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_LAYOUT_H_ */
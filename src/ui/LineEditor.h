@@ -0,0 +1,166 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  LineEditor.h: gap buffer for the console input line
+ **
+ **/
+#ifndef GYREUI_UI_LINEEDITOR_H_
+#define GYREUI_UI_LINEEDITOR_H_
+
+#include <algorithm>
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace gyreui {
+
+/** * the gap sits at the cursor, so typing and pasting are O(inserted) **/
+class LineEditor {
+ public:
+  static const int GAP_MIN = 64;
+
+  int size() const { return buf.size() - (gapEnd - gapStart); }
+  bool isEmpty() const { return size() == 0; }
+  int cursor() const { return gapStart; }
+
+  /** * bumped on every edit, for caches keyed on the text **/
+  quint64 generation() const { return gen; }
+
+  QChar at(int n) const {
+    return buf[n < gapStart ? n : n + gapEnd - gapStart];
+  }
+
+  QString left() const { return QString(buf.constData(), gapStart); }
+  QString right() const {
+    return QString(buf.constData() + gapEnd, buf.size() - gapEnd);
+  }
+  QString text() const { return left() + right(); }
+
+  void setText(const QString& text) {
+    buf.resize(text.size() + GAP_MIN);
+    std::copy(text.begin(), text.end(), buf.begin());
+    gapStart = text.size();
+    gapEnd = buf.size();
+    gen++;
+  }
+
+  void clear() { setText(QString()); }
+
+  void insert(const QString& text) {
+    if (text.isEmpty()) return;
+
+    reserve(text.size());
+    std::copy(text.begin(), text.end(), buf.begin() + gapStart);
+    gapStart += text.size();
+    gen++;
+  }
+
+  void backspace() {
+    if (gapStart == 0) return;
+
+    gapStart--;
+    gen++;
+  }
+
+  void erase() {
+    if (gapEnd == buf.size()) return;
+
+    gapEnd++;
+    gen++;
+  }
+
+  void moveTo(int pos) {
+    pos = qBound(0, pos, size());
+
+    if (pos < gapStart) {
+      std::copy_backward(buf.begin() + pos, buf.begin() + gapStart,
+                         buf.begin() + gapEnd);
+      gapEnd -= gapStart - pos;
+      gapStart = pos;
+    } else if (pos > gapStart) {
+      auto count = pos - gapStart;
+
+      std::copy(buf.begin() + gapEnd, buf.begin() + gapEnd + count,
+                buf.begin() + gapStart);
+      gapStart += count;
+      gapEnd += count;
+    }
+  }
+
+  void moveBy(int delta) { moveTo(gapStart + delta); }
+
+  /** * multi-line input **/
+  int lineStart(int pos) const {
+    while (pos > 0 && at(pos - 1) != '\n') --pos;
+
+    return pos;
+  }
+
+  int lineEnd(int pos) const {
+    auto end = size();
+
+    while (pos < end && at(pos) != '\n') ++pos;
+
+    return pos;
+  }
+
+  int row() const {
+    return std::count(buf.begin(), buf.begin() + gapStart, QChar('\n'));
+  }
+
+  int column() const { return gapStart - lineStart(gapStart); }
+
+  /** * keep the column, false if there is no line in that direction **/
+  bool moveLine(int delta) {
+    auto start = lineStart(gapStart);
+    auto col = gapStart - start;
+
+    if (delta < 0) {
+      if (start == 0) return false;
+
+      auto prev = lineStart(start - 1);
+      moveTo(qMin(prev + col, start - 1));
+    } else {
+      auto end = lineEnd(gapStart);
+      if (end == size()) return false;
+
+      moveTo(qMin(end + 1 + col, lineEnd(end + 1)));
+    }
+
+    return true;
+  }
+
+  QStringList lines() const { return text().split('\n'); }
+
+  LineEditor() : gapStart(0), gapEnd(0), gen(0) {}
+
+ private:
+  void reserve(int count) {
+    if (gapEnd - gapStart >= count) return;
+
+    auto tail = buf.size() - gapEnd;
+    auto grown = qMax(buf.size() * 2, size() + count + GAP_MIN);
+
+    buf.resize(grown);
+    std::copy_backward(buf.begin() + gapEnd, buf.begin() + gapEnd + tail,
+                       buf.end());
+    gapEnd = grown - tail;
+  }
+
+  QVector<QChar> buf;
+  int gapStart;
+  int gapEnd;
+  quint64 gen;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_LINEEDITOR_H_ */
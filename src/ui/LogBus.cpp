@@ -0,0 +1,122 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  LogBus.cpp: multi-producer log bus implementation
+ **
+ **  a bounded ring of sequenced slots. a producer claims a slot with
+ **  one compare-exchange on the tail and publishes it by bumping the
+ **  slot's sequence, the single consumer on the gui thread takes
+ **  slots in order and hands them back a lap ahead. the first post
+ **  after a drain asks the gui thread for the next one.
+ **
+ **/
+#include "LogBus.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+
+namespace gyreui {
+
+LogBus* LogBus::instance() {
+  static LogBus bus;
+
+  return &bus;
+}
+
+QString LogBus::severityName(LogEntry::Severity severity) {
+  static const char* names[] = {"debug", "info", "warning", "error"};
+
+  return names[severity];
+}
+
+bool LogBus::post(LogEntry::Severity severity, QString source, QString text) {
+  auto pos = tail.load(std::memory_order_relaxed);
+  Slot* slot;
+
+  for (;;) {
+    slot = &ring[pos % RING_SIZE];
+
+    auto diff = static_cast<qint64>(
+        slot->sequence.load(std::memory_order_acquire) - pos);
+
+    if (diff == 0) {
+      if (tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        break;
+    } else if (diff < 0) {
+      droppedCount.fetch_add(1);
+      return false;
+    } else {
+      pos = tail.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->entry = {QDateTime::currentMSecsSinceEpoch(), severity, source, text};
+  slot->sequence.store(pos + 1, std::memory_order_release);
+
+  if (!scheduled.exchange(true))
+    QMetaObject::invokeMethod(
+        this, [this]() { drainTimer->start(); }, Qt::QueuedConnection);
+
+  return true;
+}
+
+/** * gui thread **/
+void LogBus::drain() {
+  scheduled.store(false);
+
+  auto count = 0;
+  for (;; ++head, ++count) {
+    auto& slot = ring[head % RING_SIZE];
+    if (slot.sequence.load(std::memory_order_acquire) != head + 1) break;
+
+    auto& entry = slot.entry;
+    if (!sourceList.contains(entry.source)) sourceList << entry.source;
+
+    history << std::move(entry);
+    entry = LogEntry();
+    slot.sequence.store(head + RING_SIZE, std::memory_order_release);
+  }
+
+  /* trimmed a quarter at a time */
+  if (history.size() > HISTORY_MAX) {
+    auto trim = HISTORY_MAX / 4;
+
+    history.remove(0, trim);
+    base += trim;
+  }
+
+  if (count > 0) emit drained();
+}
+
+void LogBus::clear() {
+  base += history.size();
+  history.clear();
+  emit drained();
+}
+
+LogBus::LogBus()
+    : ring(new Slot[RING_SIZE]),
+      tail(0),
+      droppedCount(0),
+      scheduled(false),
+      head(0),
+      base(0) {
+  for (int i = 0; i < RING_SIZE; ++i) ring[i].sequence.store(i);
+
+  drainTimer = new QTimer(this);
+  drainTimer->setSingleShot(true);
+  drainTimer->setInterval(DRAIN_MSECS);
+  connect(drainTimer, &QTimer::timeout, this, &LogBus::drain);
+
+  /* the first post may come from a worker, drains belong to the gui */
+  moveToThread(QCoreApplication::instance()->thread());
+}
+
+}  // namespace gyreui
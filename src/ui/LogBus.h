@@ -0,0 +1,89 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  LogBus.h: multi-producer log bus
+ **
+ **/
+#ifndef GYREUI_UI_LOGBUS_H_
+#define GYREUI_UI_LOGBUS_H_
+
+#include <atomic>
+#include <memory>
+
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <QVector>
+
+namespace gyreui {
+
+struct LogEntry {
+  enum Severity { DEBUG, INFO, WARNING, ERROR };
+
+  qint64 when;
+  Severity severity;
+  QString source;
+  QString text;
+};
+
+/** * any thread posts, the gui thread drains in batches **/
+class LogBus : public QObject {
+  Q_OBJECT
+
+ public:
+  static const int RING_SIZE = 4096;
+  static const int HISTORY_MAX = 50000;
+  static const int DRAIN_MSECS = 30;
+
+  static LogBus* instance();
+
+  /** * never blocks, false if the ring was full and the entry dropped **/
+  bool post(LogEntry::Severity, QString, QString);
+
+  /** * drained entries by sequence number, gui thread **/
+  quint64 begin() const { return base; }
+  quint64 end() const { return base + history.size(); }
+  const LogEntry& at(quint64 seq) const { return history[seq - base]; }
+  const QStringList& sources() const { return sourceList; }
+  quint64 dropped() const { return droppedCount.load(); }
+
+  void clear();
+
+  static QString severityName(LogEntry::Severity);
+
+ signals:
+  void drained();
+
+ private:
+  struct Slot {
+    std::atomic<quint64> sequence;
+    LogEntry entry;
+  };
+
+  LogBus();
+
+  void drain();
+
+  std::unique_ptr<Slot[]> ring;
+  std::atomic<quint64> tail;
+  std::atomic<quint64> droppedCount;
+  std::atomic<bool> scheduled;
+  quint64 head;
+
+  QTimer* drainTimer;
+  QVector<LogEntry> history;
+  quint64 base;
+  QStringList sourceList;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_LOGBUS_H_ */
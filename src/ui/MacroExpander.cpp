@@ -0,0 +1,112 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  MacroExpander.cpp: cached macroexpansion implementation
+ **
+ **  the cache key is the step, one or all, and the normalized form. a
+ **  rep in the env may have defined or redefined a macro, so the cache
+ **  is dropped whenever the env's generation has moved on. expansions
+ **  that raised aren't kept.
+ **
+ **/
+#include "MacroExpander.h"
+
+#include <QHash>
+
+namespace gyreui {
+
+namespace {
+
+QHash<GyreEnv*, MacroExpander*>& expanders() {
+  static QHash<GyreEnv*, MacroExpander*> registry;
+
+  return registry;
+}
+
+}  // namespace
+
+MacroExpander* MacroExpander::forEnv(GyreEnv* env) {
+  auto expander = expanders().value(env);
+  if (expander == nullptr) {
+    expander = new MacroExpander(env);
+    expanders().insert(env, expander);
+  }
+
+  return expander;
+}
+
+void MacroExpander::release(GyreEnv* env) { delete expanders().take(env); }
+
+QString MacroExpander::normalize(const QString& form) {
+  QString out;
+  bool space = false;
+
+  out.reserve(form.size());
+  for (int i = 0; i < form.size(); ++i) {
+    auto ch = form[i];
+
+    if (ch == ';') {
+      while (i < form.size() && form[i] != '\n') ++i;
+      space = true;
+    } else if (ch.isSpace()) {
+      space = true;
+    } else if (ch == '"') {
+      if (space && !out.isEmpty() && !out.endsWith('(')) out += ' ';
+      space = false;
+
+      auto start = i;
+      for (++i; i < form.size() && form[i] != '"'; ++i)
+        if (form[i] == '\\') ++i;
+
+      out += form.midRef(start, i - start + 1);
+    } else {
+      if (space && !out.isEmpty() && !out.endsWith('(') && ch != ')')
+        out += ' ';
+      space = false;
+
+      out += ch;
+    }
+  }
+
+  return out;
+}
+
+MacroExpander::Expansion MacroExpander::expand(QString form, bool once) {
+  if (env->generation() != generation) {
+    cache.clear();
+    generation = env->generation();
+  }
+
+  auto key = (once ? "1 " : "* ") + normalize(form);
+
+  if (auto hit = cache.object(key)) {
+    hitCount++;
+    return Expansion{*hit, QString(), true};
+  }
+
+  missCount++;
+
+  QString text;
+  auto error = env->withException(
+      [this, &form, &text, once]() { text = env->macroexpand(form, once); });
+
+  if (error.isEmpty()) cache.insert(key, new QString(text));
+
+  return Expansion{text, error, false};
+}
+
+MacroExpander::MacroExpander(GyreEnv* env)
+    : env(env),
+      generation(env->generation()),
+      cache(CACHE_SIZE),
+      hitCount(0),
+      missCount(0) {}
+
+}  // namespace gyreui
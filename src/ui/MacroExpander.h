@@ -0,0 +1,59 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  MacroExpander.h: cached macroexpansion
+ **
+ **/
+#ifndef GYREUI_UI_MACROEXPANDER_H_
+#define GYREUI_UI_MACROEXPANDER_H_
+
+#include <QCache>
+#include <QString>
+
+#include "GyreEnv.h"
+
+namespace gyreui {
+
+/** * expansions per env, good until the env evaluates something else **/
+class MacroExpander {
+ public:
+  static const int CACHE_SIZE = 4096;
+
+  struct Expansion {
+    QString text;
+    QString error;
+    bool cached;
+  };
+
+  static MacroExpander* forEnv(GyreEnv*);
+  static void release(GyreEnv*);
+
+  /** * whitespace and comments don't make a different form **/
+  static QString normalize(const QString&);
+
+  Expansion expand(QString, bool);
+
+  int size() const { return cache.size(); }
+  quint64 hits() const { return hitCount; }
+  quint64 misses() const { return missCount; }
+
+ private:
+  explicit MacroExpander(GyreEnv*);
+
+  GyreEnv* env;
+  quint64 generation;
+  QCache<QString, QString> cache;
+  quint64 hitCount;
+  quint64 missCount;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_MACROEXPANDER_H_ */
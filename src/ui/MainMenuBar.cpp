@@ -15,6 +15,7 @@
 
 #include "FileView.h"
 #include "FrameMenu.h"
+#include "Layout.h"
 #include "MainMenuBar.h"
 #include "MainWindow.h"
 
@@ -26,11 +27,11 @@ void MainMenuBar::saveFile() { fv->saveFile(); }
 void MainMenuBar::printFile() { fv->printFile(); }
 
 void MainMenuBar::envFrame() { fm->envFrame(); }
-void MainMenuBar::fsiFrame() { fm->envFrame(); }
+void MainMenuBar::fsiFrame() { fm->fsiFrame(); }
 void MainMenuBar::dbgFrame() { fm->envFrame(); }
 void MainMenuBar::insFrame() { fm->envFrame(); }
 void MainMenuBar::lstFrame() { fm->envFrame(); }
-void MainMenuBar::notFrame() { fm->envFrame(); }
+void MainMenuBar::notFrame() { fm->notFrame(); }
 void MainMenuBar::sysFrame() { fm->sysFrame(); }
 
 void MainMenuBar::undoEdit() {
@@ -79,7 +80,10 @@ MainMenuBar::MainMenuBar(MainWindow* mw)
                                 "Print the document", &MainMenuBar::printFile));
   fileMenu->addSeparator();
   fileMenu->addAction(defAction("&Exit", QKeySequence::Quit,
-                                "Exit the application", []() { exit(0); }));
+                                "Exit the application", []() {
+                                  LayoutStore::instance()->save();
+                                  exit(0);
+                                }));
 
   editMenu = addMenu(tr("&Edit"));
   editMenu->addAction(defAction("&Undo", QKeySequence::Undo,
@@ -107,7 +111,7 @@ MainMenuBar::MainMenuBar(MainWindow* mw)
   frameMenu->addAction(defAction("&environment", QKeySequence(tr("Ctrl+1", "")),
                                  "environment", &MainMenuBar::envFrame));
   frameMenu->addAction(defAction("&file system", QKeySequence(tr("Ctrl+2", "")),
-                                 "file system", []() {}));
+                                 "file system", &MainMenuBar::fsiFrame));
   frameMenu->addAction(defAction("&debugger", QKeySequence(tr("Ctrl+3", "")),
                                  "debugger", []() {}));
   frameMenu->addAction(defAction("&inspector", QKeySequence(tr("Ctrl+4", "")),
@@ -116,7 +120,7 @@ MainMenuBar::MainMenuBar(MainWindow* mw)
                                  "listener", []() {}));
   frameMenu->addAction(defAction("&notifications",
                                  QKeySequence(tr("Ctrl+6", "")),
-                                 "notifications", []() {}));
+                                 "notifications", &MainMenuBar::notFrame));
   frameMenu->addAction(defAction("&system", QKeySequence(tr("Ctrl+7", "")),
                                  "system inspector", &MainMenuBar::sysFrame));
 
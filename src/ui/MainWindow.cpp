@@ -18,13 +18,18 @@
 #include "ComposerFrame.h"
 #include "ConsoleFrame.h"
 #include "EnvironmentView.h"
+#include "LogBus.h"
 #include "MainMenuBar.h"
 #include "MainWindow.h"
+#include "Watchdog.h"
+#include "XrefIndex.h"
 #include "user.h"
 
 namespace gyreui {
 
-void MainWindow::log(QString msg) { envView->log(msg); }
+void MainWindow::log(QString msg) {
+  LogBus::instance()->post(LogEntry::INFO, "ui", msg);
+}
 
 void MainWindow::contextMenuEvent(QContextMenuEvent *event) {
   QMenu menu(this);
@@ -75,6 +80,9 @@ MainWindow::MainWindow() : user(new User()) {
 
   resize(QDesktopWidget().availableGeometry(this).size() * 0.8);
   setWindowTitle(tr("Software Knife and Tool Gyre UI"));
+
+  Watchdog::instance()->start();
+  XrefIndex::instance()->addRoots(user->userdir());
 }
 
 } /* namespace gyreui */
@@ -59,7 +59,6 @@ class MainWindow : public QMainWindow {
   void createStatusBar();
 
  private:
-  EnvironmentView* envView;
   User* user;
   QLabel* contextLabel;
   MainMenuBar* menuBar;
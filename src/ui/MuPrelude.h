@@ -0,0 +1,363 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  MuPrelude.h: mu the ui loads into every env after mu.l
+ **
+ **/
+#ifndef GYREUI_UI_MUPRELUDE_H_
+#define GYREUI_UI_MUPRELUDE_H_
+
+namespace gyreui {
+
+/** * read a form at a time, see GyreEnv **/
+static const char* const MU_PRELUDE = R"mu(
+;;;
+;;; bounded printing. a path is a list of indices kept innermost first,
+;;; a negative index -1-n is the tail after n elements of a list
+;;;
+(:defcon %gyre-nthcdr (:lambda (n tail)
+  (if (eq n 0) tail (%gyre-nthcdr (fixnum- n 1) (cdr tail)))))
+
+;;; an object with a view opens onto the view's slots, as ide-printex
+;;; takes an exception apart
+(:defcon %gyre-viewable (:lambda (obj)
+  (let ((type (type-of obj)))
+    (or (eq type :except) (or (eq type :func) (eq type :struct))))))
+
+(:defcon %gyre-slots (:lambda (obj)
+  (if (%gyre-viewable obj) (view obj) obj)))
+
+(:defcon %gyre-step (:lambda (obj n)
+  (if (eq (type-of obj) :cons)
+      (if (fixnum< n 0)
+          (%gyre-nthcdr (fixnum- -1 n) obj)
+          (car (%gyre-nthcdr n obj)))
+      (svref (%gyre-slots obj) n))))
+
+(:defcon %gyre-at (:lambda (obj rpath)
+  (if (null rpath)
+      obj
+      (%gyre-step (%gyre-at obj (cdr rpath)) (car rpath)))))
+
+(:defcon %gyre-seen (:lambda (obj seen)
+  (if (null seen)
+      :nil
+      (if (eq obj (car seen)) :t (%gyre-seen obj (cdr seen))))))
+
+;;; strings print whole, lists and other vectors are bounded
+(:defcon %gyre-container (:lambda (obj)
+  (if (eq (type-of obj) :cons)
+      :t
+      (if (eq (type-of obj) :vector)
+          (null (eq (vector-type obj) :char))
+          :nil))))
+
+(:defcon %gyre-path (:lambda (stream rpath)
+  (if (null rpath)
+      :nil
+      (let ()
+        (%gyre-path stream (cdr rpath))
+        (fmt stream ".~A" (car rpath))))))
+
+;;; #<gyre:tag:kind:path[:start]>, what was cut off and where it was
+;;; without a tag, just what kind of cut it was
+(:defcon %gyre-marker (:lambda (stream tag kind rpath start)
+  (if (null tag)
+      (fmt stream (if start "..." "#<...>"))
+      (let ()
+        (fmt stream "#<gyre:~A:~A:" tag kind)
+        (%gyre-path stream rpath)
+        (if start (fmt stream ":~A" start) :nil)
+        (fmt stream ">")))))
+
+(:defcon %gyre-print-obj (:lambda (obj stream tag rpath seen level width)
+  (if (null (%gyre-container obj))
+      (fmt stream "~S" obj)
+      (if (%gyre-seen obj seen)
+          (fmt stream "#<gyre:cycle>")
+          (if (eq level 0)
+              (%gyre-marker stream tag "deep" rpath :nil)
+              (let ((vec (eq (type-of obj) :vector)))
+                (fmt stream (if vec "#(" "("))
+                (%gyre-print-seq obj stream tag rpath (cons obj seen)
+                                 (fixnum- level 1) width 0)
+                (fmt stream ")")))))))
+
+(:defcon %gyre-print-seq
+  (:lambda (obj stream tag rpath seen level width start)
+    (if (eq (type-of obj) :cons)
+        (let ((tail (%gyre-nthcdr start obj)))
+          (%gyre-print-list tail tail :nil stream tag rpath seen level width
+                            width start))
+        (%gyre-print-vector obj stream tag rpath seen level width width
+                            start))))
+
+;;; the cdr chain is checked for a cycle against a second pointer going
+;;; at half its pace
+(:defcon %gyre-print-list
+  (:lambda (tail slow odd stream tag rpath seen level width left n)
+    (if (null tail)
+        :nil
+        (if (eq left 0)
+            (%gyre-marker stream tag "more" rpath n)
+            (let ((next (cdr tail))
+                  (slow (if odd (cdr slow) slow)))
+              (%gyre-print-obj (car tail) stream tag (cons n rpath) seen
+                               level width)
+              (if (null next)
+                  :nil
+                  (if (eq next slow)
+                      (fmt stream " #<gyre:cycle>")
+                      (if (eq (type-of next) :cons)
+                          (let ()
+                            (fmt stream " ")
+                            (%gyre-print-list next slow (null odd) stream tag
+                                              rpath seen level width
+                                              (fixnum- left 1)
+                                              (fixnum+ n 1)))
+                          (let ()
+                            (fmt stream " . ")
+                            (%gyre-print-obj next stream tag
+                                             (cons (fixnum- -2 n) rpath)
+                                             seen level width))))))))))
+
+(:defcon %gyre-print-vector
+  (:lambda (vec stream tag rpath seen level width left n)
+    (if (eq n (vector-length vec))
+        :nil
+        (if (eq left 0)
+            (%gyre-marker stream tag "more" rpath n)
+            (let ()
+              (%gyre-print-obj (svref vec n) stream tag (cons n rpath) seen
+                               level width)
+              (if (eq (fixnum+ n 1) (vector-length vec))
+                  :nil
+                  (let ()
+                    (fmt stream " ")
+                    (%gyre-print-vector vec stream tag rpath seen level
+                                        width (fixnum- left 1)
+                                        (fixnum+ n 1)))))))))
+
+;;; the object at rpath in root, whole or its elements from start
+(:defcon %gyre-print (:lambda (root rpath start tag level width)
+  (let ((obj (%gyre-at root rpath))
+        (stream (make-output-string "")))
+    (if start
+        (%gyre-print-seq obj stream tag rpath :nil level width start)
+        (%gyre-print-obj obj stream tag rpath :nil level width))
+    (get-output-string-stream stream))))
+
+;;;
+;;; inspection. a record is the step to a part from its container, the
+;;; part's type, 1 if it opens, and a short print of it prefixed with its
+;;; length, so the print can hold anything
+;;;
+(:defcon %gyre-inspectable (:lambda (obj)
+  (if (%gyre-container obj) :t (%gyre-viewable obj))))
+
+(:defcon %gyre-summary (:lambda (obj)
+  (let ((stream (make-output-string "")))
+    (%gyre-print-obj obj stream :nil :nil :nil 1 8)
+    (get-output-string-stream stream))))
+
+(:defcon %gyre-record (:lambda (stream step obj)
+  (let ((summary (%gyre-summary obj)))
+    (fmt stream "~A ~A ~A ~A:~A" step (type-of obj)
+         (if (%gyre-inspectable obj) 1 0) (vector-length summary) summary))))
+
+;;; a list isn't counted, it's paged until it ends
+(:defcon %gyre-size (:lambda (obj)
+  (if (eq (type-of obj) :cons)
+      :nil
+      (if (eq (type-of obj) :vector)
+          (vector-length obj)
+          (if (%gyre-viewable obj) (vector-length (view obj)) 0)))))
+
+;;; the size, - for a list, and the object's own record
+(:defcon %gyre-describe (:lambda (obj)
+  (let ((stream (make-output-string ""))
+        (size (%gyre-size obj)))
+    (fmt stream "~A " (if size size "-"))
+    (%gyre-record stream 0 obj)
+    (get-output-string-stream stream))))
+
+;;; a list is paged from a tail the ui holds, and ends with more if it
+;;; goes on past the page
+(:defcon %gyre-page-list (:lambda (stream tail n left)
+  (if (null tail)
+      :nil
+      (if (eq (type-of tail) :cons)
+          (if (eq left 0)
+              (fmt stream "more")
+              (let ()
+                (%gyre-record stream n (car tail))
+                (%gyre-page-list stream (cdr tail) (fixnum+ n 1)
+                                 (fixnum- left 1))))
+          (%gyre-record stream (fixnum- -1 n) tail)))))
+
+(:defcon %gyre-page-vector (:lambda (stream vec n left)
+  (if (eq n (vector-length vec))
+      :nil
+      (if (eq left 0)
+          :nil
+          (let ()
+            (%gyre-record stream n (svref vec n))
+            (%gyre-page-vector stream vec (fixnum+ n 1)
+                               (fixnum- left 1)))))))
+
+;;; records for count parts of obj from start, a list from its head
+(:defcon %gyre-page (:lambda (obj start count)
+  (let ((stream (make-output-string "")))
+    (if (eq (type-of obj) :cons)
+        (%gyre-page-list stream obj 0 count)
+        (%gyre-page-vector stream (%gyre-slots obj) start count))
+    (get-output-string-stream stream))))
+;;;
+;;; result history. the newest three results are *, ** and ***. a result
+;;; weighs a unit for each cons, vector slot and string character it
+;;; reaches. the walk keeps its own stack of (:obj . object), (:vec vector
+;;; . index) and (:spine head cell slow odd) items, so it never recurses
+;;; on the result's depth. a cycle isn't followed: a list's tail is
+;;; checked against a pointer at half its pace, and a container inside
+;;; itself is found on the stack. one of the last few containers entered
+;;; isn't counted again
+;;;
+(:defsym * :nil)
+(:defsym ** :nil)
+(:defsym *** :nil)
+
+(:defcon %gyre-inside (:lambda (obj stack)
+  (if (null stack)
+      :nil
+      (let ((item (car stack)))
+        (if (if (eq (car item) :obj) :nil (eq (car (cdr item)) obj))
+            :t
+            (%gyre-inside obj (cdr stack)))))))
+
+(:defcon %gyre-met (:lambda (obj seen k)
+  (if (null seen)
+      :nil
+      (if (eq k 0)
+          :nil
+          (if (eq obj (car seen))
+              :t
+              (%gyre-met obj (cdr seen) (fixnum- k 1)))))))
+
+(:defcon %gyre-enter (:lambda (obj n stack seen left)
+  (if (%gyre-container obj)
+      (if (if (%gyre-inside obj stack) :t (%gyre-met obj seen 8))
+          (%gyre-weigh n stack seen left)
+          (if (eq (type-of obj) :cons)
+              (%gyre-weigh n (cons (list :spine obj obj obj :nil) stack)
+                           (cons obj seen) left)
+              (%gyre-weigh (fixnum+ n (vector-length obj))
+                           (cons (cons :vec (cons obj 0)) stack)
+                           (cons obj seen) left)))
+      (%gyre-weigh (if (eq (type-of obj) :vector)
+                       (fixnum+ n (vector-length obj))
+                       n)
+                   stack seen left))))
+
+(:defcon %gyre-weigh-slot (:lambda (item n rest seen left)
+  (let ((vec (car (cdr item)))
+        (at (cdr (cdr item))))
+    (if (eq at (vector-length vec))
+        (%gyre-weigh n rest seen left)
+        (%gyre-weigh n
+                     (cons (cons :obj (svref vec at))
+                           (cons (cons :vec (cons vec (fixnum+ at 1))) rest))
+                     seen left)))))
+
+;;; the list stays on the stack while its cars are walked
+(:defcon %gyre-weigh-cell (:lambda (item n rest seen left)
+  (let ((head (car (%gyre-nthcdr 1 item)))
+        (cell (car (%gyre-nthcdr 2 item)))
+        (slow (car (%gyre-nthcdr 3 item)))
+        (odd (car (%gyre-nthcdr 4 item))))
+    (if (eq (type-of cell) :cons)
+        (let ((next (cdr cell))
+              (slow (if odd (cdr slow) slow)))
+          (%gyre-weigh (fixnum+ n 1)
+                       (cons (cons :obj (car cell))
+                             (cons (list :spine head
+                                         (if (eq next slow) :nil next)
+                                         slow (null odd))
+                                   rest))
+                       seen left))
+        (if (null cell)
+            (%gyre-weigh n rest seen left)
+            (%gyre-enter cell n rest seen left))))))
+
+;;; state is (weight stack seen), after at most left items
+(:defcon %gyre-weigh (:lambda (n stack seen left)
+  (if (null stack)
+      (list n :nil :nil)
+      (if (eq left 0)
+          (list n stack seen)
+          (let ((item (car stack))
+                (rest (cdr stack))
+                (left (fixnum- left 1)))
+            (if (eq (car item) :obj)
+                (%gyre-enter (cdr item) n rest seen left)
+                (if (eq (car item) :vec)
+                    (%gyre-weigh-slot item n rest seen left)
+                    (%gyre-weigh-cell item n rest seen left))))))))
+
+;;; a chunk at a time, so neither recursion goes deep, until the walk is
+;;; done or past the budget
+(:defcon %gyre-weigh-on (:lambda (state budget)
+  (if (null (car (cdr state)))
+      state
+      (if (fixnum< budget (car state))
+          state
+          (%gyre-weigh-on (%gyre-weigh (car state) (car (cdr state))
+                                       (car (cdr (cdr state))) 1024)
+                          budget)))))
+
+;;; the weight, and 1 if the walk finished
+(:defcon %gyre-weight (:lambda (obj budget)
+  (let ((state (%gyre-weigh-on (list 0 (list (cons :obj obj)) :nil) budget)))
+    (fmt :nil "~A ~A" (car state) (if (null (car (cdr state))) 1 0)))))
+
+;;;
+;;; completion. the names interned in the current namespace and the
+;;; namespaces it imports are read a slice at a time from a cursor, a
+;;; namespace and the symbols of it left, so no one call walks them all
+;;;
+(:defsym %gyre-completing :nil)
+(:defsym %gyre-completed :nil)
+
+(:defcon %gyre-cursor (:lambda (ns)
+  (if (null ns) :nil (cons ns (ns-symbols ns)))))
+
+;;; where the next slice starts, :nil once every namespace is done
+(:defcon %gyre-slice-names (:lambda (stream cursor n)
+  (if (null cursor)
+      :nil
+      (if (null (cdr cursor))
+          (%gyre-slice-names stream (%gyre-cursor (ns-import (car cursor))) n)
+          (if (eq n 0)
+              cursor
+              (let ()
+                (fmt stream "~A~%" (symbol-name (car (cdr cursor))))
+                (%gyre-slice-names stream
+                                   (cons (car cursor) (cdr (cdr cursor)))
+                                   (fixnum- n 1))))))))
+
+;;; a line for each of up to n names, and the cursor after them
+(:defcon %gyre-symbol-slice (:lambda (cursor n)
+  (let ((stream (make-output-string "")))
+    (let ((next (%gyre-slice-names stream cursor n)))
+      (cons (get-output-string-stream stream) next)))))
+)mu";
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_MUPRELUDE_H_ */
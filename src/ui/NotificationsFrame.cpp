@@ -0,0 +1,185 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  NotificationsFrame.cpp: NotificationsFrame implementation
+ **
+ **  the list view asks only for the rows it shows, so the model keeps
+ **  nothing but the sequence numbers that pass the filter and scans
+ **  each drained batch once.
+ **
+ **/
+#include <QDateTime>
+#include <QFontDatabase>
+#include <QLabel>
+#include <QScrollBar>
+#include <QString>
+#include <QToolBar>
+#include <QtWidgets>
+
+#include "NotificationsFrame.h"
+
+namespace gyreui {
+
+/** * model **/
+int LogModel::rowCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : rows.size();
+}
+
+QVariant LogModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid() || index.row() >= rows.size()) return QVariant();
+
+  auto& entry = bus->at(rows[index.row()]);
+
+  switch (role) {
+    case Qt::DisplayRole:
+      return QString("%1 %2 %3: %4")
+          .arg(QDateTime::fromMSecsSinceEpoch(entry.when)
+                   .toString("hh:mm:ss.zzz"))
+          .arg(LogBus::severityName(entry.severity), -7)
+          .arg(entry.source)
+          .arg(entry.text.section('\n', 0, 0));
+    case Qt::ToolTipRole:
+      return entry.text;
+    case Qt::ForegroundRole:
+      if (entry.severity == LogEntry::ERROR) return QColor(Qt::red);
+      if (entry.severity == LogEntry::WARNING) return QColor(0xb0, 0x60, 0);
+      if (entry.severity == LogEntry::DEBUG) return QColor(Qt::gray);
+      return QVariant();
+    default:
+      return QVariant();
+  }
+}
+
+bool LogModel::matches(const LogEntry& entry) const {
+  return entry.severity >= minSeverity &&
+         (source.isEmpty() || entry.source == source) &&
+         (text.isEmpty() || entry.text.contains(text, Qt::CaseInsensitive));
+}
+
+void LogModel::setFilter(int severity, QString inSource, QString inText) {
+  beginResetModel();
+
+  minSeverity = severity;
+  source = inSource;
+  text = inText;
+
+  rows.clear();
+  scanned = bus->begin();
+  for (; scanned < bus->end(); ++scanned)
+    if (matches(bus->at(scanned))) rows << scanned;
+
+  endResetModel();
+}
+
+void LogModel::update() {
+  /* entries the bus has trimmed or cleared */
+  auto gone = 0;
+  while (gone < rows.size() && rows[gone] < bus->begin()) ++gone;
+
+  if (gone > 0) {
+    beginRemoveRows(QModelIndex(), 0, gone - 1);
+    rows.remove(0, gone);
+    endRemoveRows();
+  }
+
+  QVector<quint64> added;
+  for (scanned = qMax(scanned, bus->begin()); scanned < bus->end(); ++scanned)
+    if (matches(bus->at(scanned))) added << scanned;
+
+  if (added.isEmpty()) return;
+
+  beginInsertRows(QModelIndex(), rows.size(), rows.size() + added.size() - 1);
+  rows += added;
+  endInsertRows();
+}
+
+LogModel::LogModel(QObject* parent)
+    : QAbstractListModel(parent),
+      bus(LogBus::instance()),
+      scanned(0),
+      minSeverity(LogEntry::DEBUG) {}
+
+/** * frame **/
+void NotificationsFrame::drained() {
+  auto scrollBar = logView->verticalScrollBar();
+  auto follow = scrollBar->value() == scrollBar->maximum();
+
+  for (int i = sourceBox->count() - 1; i < bus->sources().size(); ++i)
+    sourceBox->addItem(bus->sources()[i]);
+
+  model->update();
+  if (follow) logView->scrollToBottom();
+
+  statusLabel->setText(tr("%1 of %2 entries, %3 dropped")
+                           .arg(model->rowCount(QModelIndex()))
+                           .arg(bus->end() - bus->begin())
+                           .arg(bus->dropped()));
+}
+
+void NotificationsFrame::filter() {
+  model->setFilter(severityBox->currentIndex(),
+                   sourceBox->currentIndex() == 0 ? QString()
+                                                  : sourceBox->currentText(),
+                   filterEdit->text());
+  logView->scrollToBottom();
+  drained();
+}
+
+void NotificationsFrame::clear() { bus->clear(); }
+
+NotificationsFrame::NotificationsFrame(QString name, MainWindow* tb)
+    : mw(tb), name(name), bus(LogBus::instance()) {
+  toolBar = new QToolBar();
+
+  severityBox = new QComboBox();
+  severityBox->addItems({tr("debug"), tr("info"), tr("warning"), tr("error")});
+  toolBar->addWidget(severityBox);
+
+  sourceBox = new QComboBox();
+  sourceBox->addItem(tr("all sources"));
+  toolBar->addWidget(sourceBox);
+
+  filterEdit = new QLineEdit();
+  filterEdit->setPlaceholderText(tr("filter"));
+  filterEdit->setClearButtonEnabled(true);
+  toolBar->addWidget(filterEdit);
+
+  connect(toolBar->addAction(tr("clear")), &QAction::triggered, this,
+          &NotificationsFrame::clear);
+
+  model = new LogModel(this);
+
+  logView = new QListView();
+  logView->setModel(model);
+  logView->setUniformItemSizes(true);
+  logView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+  logView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+  statusLabel = new QLabel();
+
+  connect(severityBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+          this, &NotificationsFrame::filter);
+  connect(sourceBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+          this, &NotificationsFrame::filter);
+  connect(filterEdit, &QLineEdit::textChanged, this,
+          &NotificationsFrame::filter);
+  connect(bus, &LogBus::drained, this, &NotificationsFrame::drained);
+
+  auto layout = new QVBoxLayout;
+  layout->setContentsMargins(5, 5, 5, 5);
+  layout->addWidget(toolBar);
+  layout->addWidget(logView);
+  layout->addWidget(statusLabel);
+
+  setLayout(layout);
+  filter();
+}
+
+}  // namespace gyreui
@@ -0,0 +1,102 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  NotificationsFrame.h: NotificationsFrame class
+ **
+ **/
+#ifndef GYREUI_UI_NOTIFICATIONSFRAME_H_
+#define GYREUI_UI_NOTIFICATIONSFRAME_H_
+
+#include <QAbstractListModel>
+#include <QComboBox>
+#include <QFrame>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
+#include <QToolBar>
+#include <QWidget>
+
+#include "LogBus.h"
+#include "MainWindow.h"
+
+QT_BEGIN_NAMESPACE
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QListView;
+class QToolBar;
+class QVBoxLayout;
+class QWidget;
+QT_END_NAMESPACE
+
+namespace gyreui {
+
+class MainWindow;
+
+/** * sequence numbers of the bus entries passing the filter **/
+class LogModel : public QAbstractListModel {
+  Q_OBJECT
+
+ public:
+  int rowCount(const QModelIndex&) const override;
+  QVariant data(const QModelIndex&, int) const override;
+
+  void setFilter(int, QString, QString);
+
+  /** * take in what the bus drained since the last update **/
+  void update();
+
+  explicit LogModel(QObject*);
+
+ private:
+  bool matches(const LogEntry&) const;
+
+  LogBus* bus;
+  QVector<quint64> rows;
+  quint64 scanned;
+
+  int minSeverity;
+  QString source;
+  QString text;
+};
+
+class NotificationsFrame : public QFrame {
+  Q_OBJECT
+
+ public:
+  explicit NotificationsFrame(QString, MainWindow*);
+
+ private:
+  void drained();
+  void filter();
+  void clear();
+
+  void setContextStatus(QString str) { mw->setContextStatus(str); }
+
+  void showEvent(QShowEvent* event) override {
+    QWidget::showEvent(event);
+    mw->setContextStatus(name);
+  }
+
+  MainWindow* mw;
+  QString name;
+  LogBus* bus;
+  LogModel* model;
+  QListView* logView;
+  QComboBox* severityBox;
+  QComboBox* sourceBox;
+  QLineEdit* filterEdit;
+  QLabel* statusLabel;
+  QToolBar* toolBar;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_NOTIFICATIONSFRAME_H_ */
@@ -0,0 +1,185 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Profiler.cpp: sampling profiler implementation
+ **
+ **/
+#include "Profiler.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <cstdlib>
+
+#include <QFileInfo>
+
+namespace gyreui {
+
+Profiler* Profiler::self = nullptr;
+
+/** * runs on the eval thread, async-signal-safe work only **/
+void Profiler::onSignal(int) {
+  auto prof = self;
+
+  if (prof == nullptr || prof->depth.load() == 0) return;
+
+  auto& sample = prof->ring[prof->head.fetch_add(1) % RING_SIZE];
+  if (sample.ready.load()) {
+    prof->dropped.fetch_add(1);
+    return;
+  }
+
+  sample.depth = backtrace(sample.frames, MAX_DEPTH);
+  sample.ready.store(true);
+}
+
+Profiler* Profiler::instance() {
+  static Profiler profiler;
+
+  return &profiler;
+}
+
+void Profiler::enter() {
+  target.store(pthread_self());
+  depth.fetch_add(1);
+}
+
+void Profiler::leave() { depth.fetch_sub(1); }
+
+void Profiler::start(int usec) {
+  if (sampling.load()) return;
+
+  /* backtrace may allocate on first use, get that out of the way here */
+  void* warm[2];
+  (void)backtrace(warm, 2);
+
+  struct sigaction sa;
+  sa.sa_handler = &Profiler::onSignal;
+  sa.sa_flags = SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGPROF, &sa, nullptr);
+
+  sampling.store(true);
+  sampler = std::thread([this, usec]() {
+    while (sampling.load()) {
+      usleep(usec);
+      if (depth.load() > 0) pthread_kill(target.load(), SIGPROF);
+    }
+  });
+}
+
+void Profiler::stop() {
+  if (!sampling.load()) return;
+
+  sampling.store(false);
+  sampler.join();
+  drain();
+}
+
+void Profiler::clear() {
+  drain();
+  root.children.clear();
+  root.total = 0;
+  root.self = 0;
+  dropped.store(0);
+  clears++;
+}
+
+QString Profiler::symbolize(void* addr) {
+  auto sym = symbols.find(addr);
+  if (sym != symbols.end()) return sym.value();
+
+  QString name;
+  Dl_info info;
+  auto found = dladdr(addr, &info) != 0;
+
+  if (found && info.dli_sname != nullptr) {
+    int status;
+    auto demangled =
+        abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+
+    name = QString(status == 0 ? demangled : info.dli_sname);
+    std::free(demangled);
+  } else if (found && info.dli_fname != nullptr) {
+    name = QFileInfo(info.dli_fname).fileName() + "+" +
+           QString::number(reinterpret_cast<quintptr>(addr) -
+                               reinterpret_cast<quintptr>(info.dli_fbase),
+                           16);
+  } else {
+    name = "0x" + QString::number(reinterpret_cast<quintptr>(addr), 16);
+  }
+
+  /* keep folded-stack output parseable */
+  name.replace(';', ':');
+  symbols.insert(addr, name);
+
+  return name;
+}
+
+/** * fold collected samples into the call tree, gui thread **/
+int Profiler::drain() {
+  static const int SKIP = 2; /* onSignal and the signal trampoline */
+  int ndrained = 0;
+
+  for (int i = 0; i < RING_SIZE; ++i) {
+    auto& sample = ring[i];
+    if (!sample.ready.load()) continue;
+
+    auto node = &root;
+    node->total++;
+
+    for (int fp = sample.depth - 1; fp >= SKIP; --fp) {
+      node = node->child(symbolize(sample.frames[fp]));
+      node->total++;
+    }
+
+    node->self++;
+    sample.ready.store(false);
+    ndrained++;
+  }
+
+  return ndrained;
+}
+
+void Profiler::fold(const ProfileNode* node, QString stack,
+                    QStringList& lines) {
+  if (node->self > 0)
+    lines << stack + " " + QString::number(node->self);
+
+  for (auto& child : node->children)
+    fold(child.second.get(),
+         stack.isEmpty() ? child.first : stack + ";" + child.first, lines);
+}
+
+/** * folded-stack text, one line per unique stack **/
+QString Profiler::folded() {
+  QStringList lines;
+
+  for (auto& child : root.children)
+    fold(child.second.get(), child.first, lines);
+
+  return lines.join("\n") + "\n";
+}
+
+Profiler::Profiler()
+    : sampling(false),
+      depth(0),
+      head(0),
+      dropped(0),
+      ring(new Sample[RING_SIZE]()),
+      clears(0) {
+  for (int i = 0; i < RING_SIZE; ++i) ring[i].ready.store(false);
+  self = this;
+}
+
+}  // namespace gyreui
@@ -0,0 +1,112 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Profiler.h: sampling profiler class
+ **
+ **/
+#ifndef GYREUI_UI_PROFILER_H_
+#define GYREUI_UI_PROFILER_H_
+
+#include <pthread.h>
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <thread>
+
+#include <QHash>
+#include <QString>
+#include <QStringList>
+
+namespace gyreui {
+
+/** * call tree built from folded samples **/
+struct ProfileNode {
+  QString name;
+  int total;
+  int self;
+  std::map<QString, std::unique_ptr<ProfileNode>> children;
+
+  ProfileNode* child(const QString& nm) {
+    auto& node = children[nm];
+    if (!node) {
+      node.reset(new ProfileNode());
+      node->name = nm;
+    }
+
+    return node.get();
+  }
+
+  ProfileNode() : total(0), self(0) {}
+};
+
+class Profiler {
+ public:
+  static const int MAX_DEPTH = 64;
+  static const int RING_SIZE = 4096;
+
+  /** * marks the calling thread as the eval thread for its lifetime **/
+  class Scope {
+   public:
+    Scope() { Profiler::instance()->enter(); }
+    ~Scope() { Profiler::instance()->leave(); }
+  };
+
+  static Profiler* instance();
+
+  void start(int usec);
+  void stop();
+  void clear();
+  bool running() { return sampling.load(); }
+
+  int drain();
+  int samples() { return root.total; }
+  const ProfileNode* tree() { return &root; }
+
+  /** * bumped by clear(), which frees every node but the root **/
+  quint64 generation() { return clears; }
+  QString folded();
+
+  /** * gui thread, names are cached **/
+  QString symbolize(void*);
+
+ private:
+  struct Sample {
+    std::atomic<bool> ready;
+    int depth;
+    void* frames[MAX_DEPTH];
+  };
+
+  Profiler();
+
+  void enter();
+  void leave();
+
+  void fold(const ProfileNode*, QString, QStringList&);
+
+  static void onSignal(int);
+
+  static Profiler* self;
+
+  std::atomic<bool> sampling;
+  std::atomic<int> depth;
+  std::atomic<unsigned> head;
+  std::atomic<unsigned> dropped;
+  std::atomic<pthread_t> target;
+  std::thread sampler;
+  std::unique_ptr<Sample[]> ring;
+  QHash<void*, QString> symbols;
+  ProfileNode root;
+  quint64 clears;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_PROFILER_H_ */
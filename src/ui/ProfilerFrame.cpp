@@ -0,0 +1,109 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  ProfilerFrame.cpp: ProfilerFrame implementation
+ **
+ **/
+#include <QFileDialog>
+#include <QLabel>
+#include <QScrollArea>
+#include <QString>
+#include <QToolBar>
+#include <QtWidgets>
+
+#include "FlameGraph.h"
+#include "Profiler.h"
+#include "ProfilerFrame.h"
+
+namespace gyreui {
+
+void ProfilerFrame::refresh() {
+  profiler->drain();
+  flameGraph->update();
+
+  statusLabel->setText(QString("%1 samples%2")
+                           .arg(profiler->samples())
+                           .arg(profiler->running() ? tr(", sampling") : ""));
+}
+
+void ProfilerFrame::start() {
+  setContextStatus(tr("profile"));
+
+  profiler->start(SAMPLE_USEC);
+  drainTimer->start();
+  refresh();
+}
+
+void ProfilerFrame::stop() {
+  profiler->stop();
+  drainTimer->stop();
+  refresh();
+}
+
+void ProfilerFrame::clear() {
+  profiler->clear();
+  flameGraph->setTree(profiler->tree());
+  refresh();
+}
+
+void ProfilerFrame::save_as() {
+  auto fileName = QFileDialog::getSaveFileName(
+      this, tr("Export Folded Stacks"), mw->userInfo()->userdir(),
+      tr("Folded stacks (*.folded *.txt)"));
+
+  if (fileName.isEmpty()) return;
+
+  profiler->drain();
+
+  QSaveFile file(fileName);
+  file.open(QIODevice::WriteOnly);
+  file.write(profiler->folded().toUtf8());
+  file.commit();
+
+  log(";;; profile exported to " + fileName);
+}
+
+ProfilerFrame::ProfilerFrame(QString name, MainWindow* tb)
+    : mw(tb), name(name), profiler(Profiler::instance()) {
+  toolBar = new QToolBar();
+  connect(toolBar->addAction(tr("start")), &QAction::triggered, this,
+          &ProfilerFrame::start);
+  connect(toolBar->addAction(tr("stop")), &QAction::triggered, this,
+          &ProfilerFrame::stop);
+  connect(toolBar->addAction(tr("clear")), &QAction::triggered, this,
+          &ProfilerFrame::clear);
+  connect(toolBar->addAction(tr("export")), &QAction::triggered, this,
+          &ProfilerFrame::save_as);
+
+  flameGraph = new FlameGraph(this);
+  flameGraph->setTree(profiler->tree());
+
+  graphScroll = new QScrollArea();
+  graphScroll->setWidget(flameGraph);
+  graphScroll->setWidgetResizable(true);
+  graphScroll->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
+
+  statusLabel = new QLabel();
+
+  drainTimer = new QTimer(this);
+  drainTimer->setInterval(250);
+  connect(drainTimer, &QTimer::timeout, this, &ProfilerFrame::refresh);
+
+  auto layout = new QVBoxLayout;
+  layout->setContentsMargins(5, 5, 5, 5);
+  layout->addWidget(toolBar);
+  layout->addWidget(graphScroll);
+  layout->addWidget(statusLabel);
+
+  setLayout(layout);
+  refresh();
+}
+
+}  // namespace gyreui
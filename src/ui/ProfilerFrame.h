@@ -0,0 +1,77 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  ProfilerFrame.h: ProfilerFrame class
+ **
+ **/
+#ifndef GYREUI_UI_PROFILERFRAME_H_
+#define GYREUI_UI_PROFILERFRAME_H_
+
+#include <QFrame>
+#include <QLabel>
+#include <QScrollArea>
+#include <QTimer>
+#include <QToolBar>
+#include <QWidget>
+
+#include "FlameGraph.h"
+#include "MainWindow.h"
+#include "Profiler.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QScrollArea;
+class QTimer;
+class QToolBar;
+class QVBoxLayout;
+class QWidget;
+QT_END_NAMESPACE
+
+namespace gyreui {
+
+class MainWindow;
+
+class ProfilerFrame : public QFrame {
+  Q_OBJECT
+
+ public:
+  explicit ProfilerFrame(QString, MainWindow*);
+
+ private:
+  static const int SAMPLE_USEC = 1000;
+
+  void start();
+  void stop();
+  void clear();
+  void save_as();
+  void refresh();
+
+  void log(QString msg) { mw->log(msg); }
+
+  void setContextStatus(QString str) { mw->setContextStatus(str); }
+
+  void showEvent(QShowEvent* event) override {
+    QWidget::showEvent(event);
+    mw->setContextStatus(name);
+  }
+
+  MainWindow* mw;
+  QString name;
+  Profiler* profiler;
+  FlameGraph* flameGraph;
+  QLabel* statusLabel;
+  QScrollArea* graphScroll;
+  QTimer* drainTimer;
+  QToolBar* toolBar;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_PROFILERFRAME_H_ */
@@ -0,0 +1,221 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Pty.cpp: pseudo-terminal implementation
+ **
+ **  the master side is non-blocking and read from a socket notifier, each
+ **  wakeup drains what is there up to a budget and hands it on as one
+ **  block, so a flood of output costs one parse and one repaint per turn.
+ **
+ **/
+#include "Pty.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include <QList>
+#include <QTimer>
+
+extern char** environ;
+
+namespace gyreui {
+
+/** * everything the child needs is built before the fork, after it the
+      child only makes async-signal-safe calls. both sides of the
+      terminal are close-on-exec from the start, so no other child
+      started meanwhile inherits them **/
+bool Pty::start(QString program, int cols, int rows) {
+  if (running() || child > 0) return false;
+
+  struct winsize ws = {};
+  ws.ws_col = cols;
+  ws.ws_row = rows;
+
+  auto path = program.toLocal8Bit();
+  char* argv[] = {path.data(), nullptr};
+
+  QList<QByteArray> vars;
+  for (auto var = environ; *var != nullptr; ++var) {
+    QByteArray entry(*var);
+
+    if (entry.startsWith("TERM=") || entry.startsWith("COLUMNS=") ||
+        entry.startsWith("LINES="))
+      continue;
+
+    vars << entry;
+  }
+  vars << "TERM=xterm-256color";
+
+  std::vector<char*> envp;
+  for (auto& var : vars) envp.push_back(var.data());
+  envp.push_back(nullptr);
+
+  auto pty = posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (pty < 0) return false;
+
+  auto name = grantpt(pty) == 0 && unlockpt(pty) == 0 ? ptsname(pty) : nullptr;
+  auto slave = name == nullptr ? -1 : open(name, O_RDWR | O_NOCTTY | O_CLOEXEC);
+  if (slave < 0) {
+    close(pty);
+    return false;
+  }
+
+  ioctl(slave, TIOCSWINSZ, &ws);
+
+  child = fork();
+  if (child < 0) {
+    child = 0;
+    close(slave);
+    close(pty);
+    return false;
+  }
+
+  /* the copies on 0, 1 and 2 aren't close-on-exec */
+  if (child == 0) {
+    setsid();
+    ioctl(slave, TIOCSCTTY, 0);
+    dup2(slave, 0);
+    dup2(slave, 1);
+    dup2(slave, 2);
+
+    execve(argv[0], argv, envp.data());
+    _exit(127);
+  }
+
+  close(slave);
+  master = pty;
+  fcntl(master, F_SETFL, fcntl(master, F_GETFL) | O_NONBLOCK);
+
+  readNotifier = new QSocketNotifier(master, QSocketNotifier::Read, this);
+  connect(readNotifier, &QSocketNotifier::activated, this, &Pty::readReady);
+
+  writeNotifier = new QSocketNotifier(master, QSocketNotifier::Write, this);
+  writeNotifier->setEnabled(false);
+  connect(writeNotifier, &QSocketNotifier::activated, this, &Pty::writeReady);
+
+  return true;
+}
+
+void Pty::readReady() {
+  QByteArray block;
+  char buf[READ_CHUNK];
+
+  while (block.size() < READ_BUDGET) {
+    auto n = ::read(master, buf, sizeof(buf));
+
+    if (n > 0) {
+      block.append(buf, n);
+      continue;
+    }
+
+    /* linux says EIO once the child side is gone */
+    if (n == 0 || (errno != EAGAIN && errno != EINTR)) {
+      if (!block.isEmpty()) emit received(block);
+      hangup();
+      return;
+    }
+
+    if (errno == EAGAIN) break;
+  }
+
+  if (!block.isEmpty()) emit received(block);
+}
+
+void Pty::write(const QByteArray& bytes) {
+  if (!running()) return;
+
+  unwritten += bytes;
+  writeReady();
+}
+
+void Pty::writeReady() {
+  while (!unwritten.isEmpty()) {
+    auto n = ::write(master, unwritten.constData(), unwritten.size());
+
+    if (n > 0) {
+      unwritten.remove(0, n);
+    } else if (n < 0 && errno == EINTR) {
+      continue;
+    } else {
+      break;
+    }
+  }
+
+  writeNotifier->setEnabled(!unwritten.isEmpty());
+}
+
+void Pty::resize(int cols, int rows) {
+  if (!running()) return;
+
+  struct winsize ws = {};
+  ws.ws_col = cols;
+  ws.ws_row = rows;
+
+  ioctl(master, TIOCSWINSZ, &ws);
+}
+
+void Pty::hangup() {
+  readNotifier->setEnabled(false);
+  writeNotifier->setEnabled(false);
+  readNotifier->deleteLater();
+  writeNotifier->deleteLater();
+  readNotifier = writeNotifier = nullptr;
+  unwritten.clear();
+
+  close(master);
+  master = -1;
+
+  reap();
+}
+
+/** * the child can outlive its side of the terminal for a while, it's
+      looked for again later rather than waited on **/
+void Pty::reap() {
+  auto status = 0;
+  auto pid = waitpid(child, &status, WNOHANG);
+
+  if (pid == 0 || (pid < 0 && errno == EINTR)) {
+    QTimer::singleShot(REAP_INTERVAL, this, &Pty::reap);
+    return;
+  }
+
+  child = 0;
+  emit finished(pid > 0 && WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+}
+
+Pty::Pty(QObject* parent)
+    : QObject(parent),
+      master(-1),
+      child(0),
+      readNotifier(nullptr),
+      writeNotifier(nullptr) {}
+
+Pty::~Pty() {
+  if (child <= 0) return;
+
+  /* a shell goes on hangup, anything that ignores it doesn't get a vote */
+  kill(child, SIGHUP);
+  usleep(10000);
+  if (waitpid(child, nullptr, WNOHANG) == 0) {
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+  }
+
+  if (master >= 0) close(master);
+}
+
+}  // namespace gyreui
@@ -0,0 +1,63 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Pty.h: child process on a pseudo-terminal
+ **
+ **/
+#ifndef GYREUI_UI_PTY_H_
+#define GYREUI_UI_PTY_H_
+
+#include <sys/types.h>
+
+#include <QByteArray>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QString>
+
+namespace gyreui {
+
+class Pty : public QObject {
+  Q_OBJECT
+
+ public:
+  static const int READ_CHUNK = 64 * 1024;
+  /* bytes drained per wakeup before the event loop gets a turn */
+  static const int READ_BUDGET = 1024 * 1024;
+  /* milliseconds between looks for a hung up child's status */
+  static const int REAP_INTERVAL = 20;
+
+  bool start(QString, int, int);
+  void write(const QByteArray&);
+  void resize(int, int);
+  bool running() { return master >= 0; }
+
+  explicit Pty(QObject* parent = nullptr);
+  ~Pty() override;
+
+ signals:
+  void received(QByteArray);
+  void finished(int);
+
+ private:
+  void readReady();
+  void writeReady();
+  void hangup();
+  void reap();
+
+  int master;
+  pid_t child;
+  QByteArray unwritten;
+  QSocketNotifier* readNotifier;
+  QSocketNotifier* writeNotifier;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_PTY_H_ */
@@ -0,0 +1,88 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  ResultView.cpp: ResultView implementation
+ **
+ **  the text is kept as printed. a link carries the index of its marker,
+ **  and following it replaces the marker's first occurrence with what
+ **  the env prints for it, which may hold markers of its own.
+ **
+ **/
+#include "ResultView.h"
+
+#include <QRegularExpression>
+
+namespace gyreui {
+
+namespace {
+
+const QRegularExpression MARKER(
+    "#<gyre:\\d+\\.\\d+:(deep|more):[-.\\d]*(:\\d+)?>");
+
+}  // namespace
+
+void ResultView::setResult(QString result) {
+  text = result;
+  render();
+}
+
+/** * plain text unless there's something to expand **/
+void ResultView::render() {
+  markers.clear();
+
+  if (!text.contains("#<gyre:")) {
+    setTextFormat(Qt::PlainText);
+    setText(text);
+    return;
+  }
+
+  QString html;
+  int at = 0;
+
+  for (auto it = MARKER.globalMatch(text); it.hasNext();) {
+    auto match = it.next();
+
+    html += text.mid(at, match.capturedStart() - at).toHtmlEscaped();
+    html += QString("<a href=\"%1\">%2</a>")
+                .arg(markers.size())
+                .arg(match.captured(1) == "deep" ? "#&lt;...&gt;" : "...");
+
+    markers << match.captured();
+    at = match.capturedEnd();
+  }
+
+  html += text.mid(at).toHtmlEscaped();
+
+  setTextFormat(Qt::RichText);
+  setText("<div style=\"white-space: pre-wrap\">" + html + "</div>");
+}
+
+void ResultView::expand(const QString& link) {
+  auto marker = markers.value(link.toInt());
+  auto at = text.indexOf(marker);
+
+  if (marker.isEmpty() || at < 0) return;
+
+  QString part;
+  auto error = devEnv->withException(
+      [this, &marker, &part]() { part = devEnv->expand(marker); });
+
+  text.replace(at, marker.size(), error.isEmpty() ? part : error.trimmed());
+  render();
+}
+
+ResultView::ResultView(GyreEnv* env) : devEnv(env) {
+  setTextInteractionFlags(Qt::TextSelectableByMouse |
+                          Qt::LinksAccessibleByMouse);
+
+  connect(this, &QLabel::linkActivated, this, &ResultView::expand);
+}
+
+}  // namespace gyreui
@@ -0,0 +1,46 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  ResultView.h: ResultView class
+ **
+ **/
+#ifndef GYREUI_UI_RESULTVIEW_H_
+#define GYREUI_UI_RESULTVIEW_H_
+
+#include <QLabel>
+#include <QStringList>
+
+#include "GyreEnv.h"
+
+namespace gyreui {
+
+/** * printed results, the parts the printer cut off shown as links that
+      print them in place **/
+class ResultView : public QLabel {
+  Q_OBJECT
+
+ public:
+  explicit ResultView(GyreEnv*);
+
+  void setEnv(GyreEnv* env) { devEnv = env; }
+  void setResult(QString);
+
+ private:
+  void render();
+  void expand(const QString&);
+
+  GyreEnv* devEnv;
+  QString text;
+  QStringList markers;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_RESULTVIEW_H_ */
@@ -38,10 +38,12 @@ void ScratchpadFrame::load() {
   if (f.open(QFile::ReadOnly | QFile::Text)) {
     QTextStream in(&f);
     scratchText->setText(in.readAll());
+    scratchText->document()->setModified(false);
     f.close();
   }
 
   saveFileName = loadFileName;
+  LayoutStore::instance()->changed();
 }
 
 void ScratchpadFrame::append() {
@@ -68,7 +70,42 @@ void ScratchpadFrame::save() {
   QSaveFile file(saveFileName);
   file.open(QIODevice::WriteOnly);
   file.write(text.toUtf8());
-  file.commit();
+  if (file.commit()) scratchText->document()->setModified(false);
+
+  LayoutStore::instance()->changed();
+}
+
+/** * like a composer, the file alone when the text still matches it **/
+QJsonObject ScratchpadFrame::saveState() const {
+  QJsonObject state{{"scroll", scratchText->verticalScrollBar()->value()}};
+
+  if (!saveFileName.isEmpty()) state["file"] = saveFileName;
+  if (saveFileName.isEmpty() || scratchText->document()->isModified())
+    state["text"] = scratchText->toPlainText();
+
+  return state;
+}
+
+void ScratchpadFrame::restoreState(const QJsonObject& state) {
+  loadFileName = saveFileName = state["file"].toString();
+
+  if (state.contains("text")) {
+    scratchText->setPlainText(state["text"].toString());
+    scratchText->document()->setModified(true);
+  } else {
+    QFile f(saveFileName);
+    if (f.open(QFile::ReadOnly | QFile::Text)) {
+      scratchText->setPlainText(QTextStream(&f).readAll());
+      scratchText->document()->setModified(false);
+    } else {
+      log(";;; scratch: can't reopen " + saveFileName);
+    }
+  }
+
+  auto scroll = state["scroll"].toInt();
+  QTimer::singleShot(0, scratchText, [this, scroll]() {
+    scratchText->verticalScrollBar()->setValue(scroll);
+  });
 }
 
 ScratchpadFrame::ScratchpadFrame(QString name, MainWindow* tb)
@@ -91,6 +128,11 @@ ScratchpadFrame::ScratchpadFrame(QString name, MainWindow* tb)
   scratchText = new QTextEdit();
   scratchText->setAlignment(Qt::AlignTop);
 
+  auto store = LayoutStore::instance();
+  connect(scratchText, &QTextEdit::textChanged, store, &LayoutStore::changed);
+  connect(scratchText->verticalScrollBar(), &QScrollBar::valueChanged, store,
+          &LayoutStore::changed);
+
   scrollArea = new QScrollArea();
   scrollArea->setWidget(scratchText);
   scrollArea->setWidgetResizable(true);
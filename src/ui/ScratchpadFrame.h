@@ -22,6 +22,7 @@
 
 #include "ComposerFrame.h"
 #include "GyreEnv.h"
+#include "Layout.h"
 #include "MainWindow.h"
 
 QT_BEGIN_NAMESPACE
@@ -40,12 +41,15 @@ class ComposerFrame;
 class MainWindow;
 class MainWindow;
 
-class ScratchpadFrame : public QFrame {
+class ScratchpadFrame : public QFrame, public FrameState {
   Q_OBJECT
 
  public:
   explicit ScratchpadFrame(QString, MainWindow*);
 
+  QJsonObject saveState() const override;
+  void restoreState(const QJsonObject&) override;
+
  private:
   void clear();
   void load();
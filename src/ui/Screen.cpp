@@ -0,0 +1,596 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Screen.cpp: terminal cell grid implementation
+ **
+ **  the subset of xterm that shells, make, less and top actually use.
+ **  every cell is one column, double width glyphs are not laid out.
+ **  the rendition is interned once per SGR, so writing a cell is a
+ **  single 32 bit store.
+ **
+ **/
+#include "Screen.h"
+
+namespace gyreui {
+
+namespace {
+
+const CellAttr PLAIN = {0, 0, 0};
+const Cell SPACE = packCell(U' ', Scrollback::PLAIN);
+
+int param(const QVector<int>& params, int n, int def) {
+  return n < params.size() && params[n] > 0 ? params[n] : def;
+}
+
+/** * xterm's 256 color palette **/
+quint32 palette(int n) {
+  static const quint32 ansi[16] = {
+      0x000000, 0xcd0000, 0x00cd00, 0xcdcd00, 0x0000ee, 0xcd00cd,
+      0x00cdcd, 0xe5e5e5, 0x7f7f7f, 0xff0000, 0x00ff00, 0xffff00,
+      0x5c5cff, 0xff00ff, 0x00ffff, 0xffffff};
+
+  quint32 rgb;
+
+  if (n < 16) {
+    rgb = ansi[n];
+  } else if (n < 232) {
+    static const int level[6] = {0, 95, 135, 175, 215, 255};
+    n -= 16;
+    rgb = level[n / 36] << 16 | level[n / 6 % 6] << 8 | level[n % 6];
+  } else {
+    auto grey = 8 + (n - 232) * 10;
+    rgb = grey << 16 | grey << 8 | grey;
+  }
+
+  return 0xff000000 | rgb;
+}
+
+}  // namespace
+
+/** * damage **/
+QBitArray Screen::takeDamage() {
+  auto out = dirty;
+
+  dirty.fill(false);
+  return out;
+}
+
+int Screen::takeScrolled() {
+  auto out = scrolled;
+
+  scrolled = 0;
+  return out;
+}
+
+QByteArray Screen::takeReplies() {
+  auto out = replies;
+
+  replies.clear();
+  return out;
+}
+
+/** * a full attribute table gives back what neither the screen nor its
+      scrollback still paints with **/
+void Screen::setAttr(const CellAttr& next) {
+  attr = next;
+  pen = history.intern(attr);
+
+  if (pen == Scrollback::PLAIN && history.full()) {
+    QBitArray live(Scrollback::MAX_ATTRS);
+
+    for (auto rows : {&lines, &primary})
+      for (auto& row : *rows)
+        for (auto cell : row) live.setBit(cellAttr(cell));
+
+    history.reclaim(live);
+    pen = history.intern(attr);
+  }
+}
+
+void Screen::pushScrollback(const Row& row) {
+  history.append(row.constData(), row.size());
+  if (history.size() > SCROLLBACK_MAX) history.removeFirst();
+  scrolled++;
+}
+
+void Screen::damageFrom(int n) {
+  for (int i = qMax(0, n); i < lines.size(); ++i) damage(i);
+}
+
+/** * movement **/
+void Screen::moveTo(int row, int col) {
+  cy = qBound(0, row, lines.size() - 1);
+  cx = qBound(0, col, cols - 1);
+  wrapPending = false;
+}
+
+void Screen::scrollUp(int n) {
+  n = qMin(n, bottom - top + 1);
+
+  for (int i = 0; i < n; ++i) {
+    if (top == 0 && !alternate) pushScrollback(lines[top]);
+
+    lines.remove(top);
+    lines.insert(bottom, blank());
+  }
+
+  for (int i = top; i <= bottom; ++i) damage(i);
+}
+
+void Screen::scrollDown(int n) {
+  n = qMin(n, bottom - top + 1);
+
+  for (int i = 0; i < n; ++i) {
+    lines.remove(bottom);
+    lines.insert(top, blank());
+  }
+
+  for (int i = top; i <= bottom; ++i) damage(i);
+}
+
+void Screen::lineFeed() {
+  wrapPending = false;
+
+  if (cy == bottom)
+    scrollUp(1);
+  else if (cy < lines.size() - 1)
+    cy++;
+}
+
+void Screen::reverseIndex() {
+  wrapPending = false;
+
+  if (cy == top)
+    scrollDown(1);
+  else if (cy > 0)
+    cy--;
+}
+
+/** * output **/
+void Screen::print(char32_t ch) {
+  if (wrapPending && autowrap) {
+    cx = 0;
+    lineFeed();
+  }
+
+  lines[cy][cx] = packCell(ch, pen);
+  damage(cy);
+
+  if (cx == cols - 1)
+    wrapPending = true;
+  else
+    cx++;
+}
+
+void Screen::execute(char ch) {
+  damage(cy);
+
+  switch (ch) {
+    case '\r':
+      cx = 0;
+      wrapPending = false;
+      break;
+    case '\n':
+    case '\v':
+    case '\f':
+      lineFeed();
+      break;
+    case '\b':
+      if (cx > 0) cx--;
+      wrapPending = false;
+      break;
+    case '\t':
+      cx = qMin(cols - 1, (cx / TAB_WIDTH + 1) * TAB_WIDTH);
+      break;
+    default:
+      break;
+  }
+
+  damage(cy);
+}
+
+/** * erasing **/
+void Screen::eraseLine(int how) {
+  auto& line = lines[cy];
+  auto from = how == 0 ? cx : 0;
+  auto to = how == 1 ? cx + 1 : cols;
+
+  for (int i = from; i < to; ++i) line[i] = packCell(U' ', pen);
+  damage(cy);
+}
+
+void Screen::eraseDisplay(int how) {
+  switch (how) {
+    case 0:
+      eraseLine(0);
+      for (int i = cy + 1; i < lines.size(); ++i) lines[i] = blank();
+      damageFrom(cy);
+      break;
+    case 1:
+      eraseLine(1);
+      for (int i = 0; i < cy; ++i) lines[i] = blank();
+      damageFrom(0);
+      break;
+    case 3:
+      history.clear();
+      scrolled++;
+      /* fall through */
+    case 2:
+      for (auto& line : lines) line = blank();
+      damageFrom(0);
+      break;
+    default:
+      break;
+  }
+}
+
+void Screen::insertChars(int n) {
+  auto& line = lines[cy];
+
+  n = qMin(n, cols - cx);
+  line.remove(cols - n, n);
+  line.insert(cx, n, packCell(U' ', pen));
+  damage(cy);
+}
+
+void Screen::deleteChars(int n) {
+  auto& line = lines[cy];
+
+  n = qMin(n, cols - cx);
+  line.remove(cx, n);
+  line.insert(cols - n, n, packCell(U' ', pen));
+  damage(cy);
+}
+
+/** * select graphic rendition **/
+void Screen::sgr(const QVector<int>& params) {
+  if (params.isEmpty()) {
+    setAttr(PLAIN);
+    return;
+  }
+
+  for (int i = 0; i < params.size(); ++i) {
+    auto p = params[i];
+
+    if (p == 0) {
+      attr = PLAIN;
+    } else if (p == 1) {
+      attr.flags |= CellAttr::BOLD;
+    } else if (p == 3) {
+      attr.flags |= CellAttr::ITALIC;
+    } else if (p == 4) {
+      attr.flags |= CellAttr::UNDERLINE;
+    } else if (p == 7) {
+      attr.flags |= CellAttr::INVERSE;
+    } else if (p == 22) {
+      attr.flags &= ~CellAttr::BOLD;
+    } else if (p == 23) {
+      attr.flags &= ~CellAttr::ITALIC;
+    } else if (p == 24) {
+      attr.flags &= ~CellAttr::UNDERLINE;
+    } else if (p == 27) {
+      attr.flags &= ~CellAttr::INVERSE;
+    } else if (p >= 30 && p <= 37) {
+      attr.fg = palette(p - 30);
+    } else if (p == 39) {
+      attr.fg = 0;
+    } else if (p >= 40 && p <= 47) {
+      attr.bg = palette(p - 40);
+    } else if (p == 49) {
+      attr.bg = 0;
+    } else if (p >= 90 && p <= 97) {
+      attr.fg = palette(p - 90 + 8);
+    } else if (p >= 100 && p <= 107) {
+      attr.bg = palette(p - 100 + 8);
+    } else if (p == 38 || p == 48) {
+      quint32 color = 0;
+
+      if (i + 2 < params.size() && params[i + 1] == 5) {
+        color = palette(qBound(0, params[i + 2], 255));
+        i += 2;
+      } else if (i + 4 < params.size() && params[i + 1] == 2) {
+        color = 0xff000000 | (params[i + 2] & 0xff) << 16 |
+                (params[i + 3] & 0xff) << 8 | (params[i + 4] & 0xff);
+        i += 4;
+      } else {
+        break;
+      }
+
+      (p == 38 ? attr.fg : attr.bg) = color;
+    }
+  }
+
+  setAttr(attr);
+}
+
+void Screen::altScreen(bool on) {
+  if (on == alternate) return;
+
+  alternate = on;
+  if (on) {
+    primary = lines;
+    for (auto& line : lines) line = blank();
+  } else {
+    lines = primary;
+    primary.clear();
+  }
+
+  damageFrom(0);
+}
+
+void Screen::mode(const QVector<int>& params, bool priv, bool on) {
+  for (auto p : params) {
+    if (!priv) continue;
+
+    switch (p) {
+      case 1:
+        appKeys = on;
+        break;
+      case 7:
+        autowrap = on;
+        break;
+      case 25:
+        showCursor = on;
+        damage(cy);
+        break;
+      case 1049:
+        if (on) {
+          savedX = cx;
+          savedY = cy;
+        }
+        altScreen(on);
+        if (!on) moveTo(savedY, savedX);
+        break;
+      case 47:
+      case 1047:
+        altScreen(on);
+        break;
+      case 2004:
+        bracketed = on;
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+/** * control sequences **/
+void Screen::csi(const QVector<int>& params, const QByteArray& prefix,
+                 char final) {
+  auto priv = prefix.contains('?');
+  auto n = param(params, 0, 1);
+
+  /* the cursor row is damaged whether or not it moves, so it repaints */
+  damage(cy);
+
+  switch (final) {
+    case 'A':
+      moveTo(qMax(cy - n, cy >= top ? top : 0), cx);
+      break;
+    case 'B':
+      moveTo(qMin(cy + n, cy <= bottom ? bottom : lines.size() - 1), cx);
+      break;
+    case 'C':
+      moveTo(cy, cx + n);
+      break;
+    case 'D':
+      moveTo(cy, cx - n);
+      break;
+    case 'E':
+      moveTo(cy + n, 0);
+      break;
+    case 'F':
+      moveTo(cy - n, 0);
+      break;
+    case 'G':
+    case '`':
+      moveTo(cy, n - 1);
+      break;
+    case 'H':
+    case 'f':
+      moveTo(param(params, 0, 1) - 1, param(params, 1, 1) - 1);
+      break;
+    case 'd':
+      moveTo(n - 1, cx);
+      break;
+    case 'J':
+      eraseDisplay(params.value(0));
+      break;
+    case 'K':
+      eraseLine(params.value(0));
+      break;
+    case 'L':
+      if (cy >= top && cy <= bottom) {
+        auto saved = top;
+        top = cy;
+        scrollDown(n);
+        top = saved;
+      }
+      break;
+    case 'M':
+      if (cy >= top && cy <= bottom) {
+        auto saved = top;
+        top = cy;
+        for (int i = 0; i < n; ++i) {
+          lines.remove(top);
+          lines.insert(bottom, blank());
+        }
+        damageFrom(top);
+        top = saved;
+      }
+      break;
+    case '@':
+      insertChars(n);
+      break;
+    case 'P':
+      deleteChars(n);
+      break;
+    case 'X':
+      for (int i = cx; i < qMin(cols, cx + n); ++i)
+        lines[cy][i] = packCell(U' ', pen);
+      break;
+    case 'S':
+      scrollUp(n);
+      break;
+    case 'T':
+      scrollDown(n);
+      break;
+    case 'm':
+      if (prefix.isEmpty()) sgr(params);
+      break;
+    case 'r':
+      top = qBound(0, param(params, 0, 1) - 1, lines.size() - 1);
+      bottom = qBound(top, param(params, 1, lines.size()) - 1,
+                      lines.size() - 1);
+      moveTo(0, 0);
+      break;
+    case 's':
+      savedX = cx;
+      savedY = cy;
+      break;
+    case 'u':
+      moveTo(savedY, savedX);
+      break;
+    case 'h':
+      mode(params, priv, true);
+      break;
+    case 'l':
+      mode(params, priv, false);
+      break;
+    case 'n':
+      if (params.value(0) == 6)
+        replies += QString("\x1b[%1;%2R").arg(cy + 1).arg(cx + 1).toLatin1();
+      else if (params.value(0) == 5)
+        replies += "\x1b[0n";
+      break;
+    case 'c':
+      if (prefix.isEmpty()) replies += "\x1b[?1;2c";
+      break;
+    default:
+      break;
+  }
+
+  damage(cy);
+}
+
+void Screen::esc(const QByteArray& intermediates, char final) {
+  /* charset designations, ESC ( B and friends */
+  if (!intermediates.isEmpty()) return;
+
+  damage(cy);
+
+  switch (final) {
+    case '7':
+      savedX = cx;
+      savedY = cy;
+      savedAttr = attr;
+      break;
+    case '8':
+      moveTo(savedY, savedX);
+      setAttr(savedAttr);
+      break;
+    case 'D':
+      lineFeed();
+      break;
+    case 'E':
+      cx = 0;
+      lineFeed();
+      break;
+    case 'M':
+      reverseIndex();
+      break;
+    case 'c':
+      reset();
+      break;
+    default:
+      break;
+  }
+
+  damage(cy);
+}
+
+/** * operating system commands, only the window title is kept **/
+void Screen::osc(const QByteArray& text) {
+  auto semi = text.indexOf(';');
+  if (semi < 0) return;
+
+  auto which = text.left(semi);
+  if (which == "0" || which == "2")
+    titleText = QString::fromUtf8(text.mid(semi + 1));
+}
+
+/** * keep the cursor on screen, rows pushed off the top go to scrollback **/
+void Screen::resize(int columns, int rowCount) {
+  columns = qMax(1, columns);
+  rowCount = qMax(1, rowCount);
+
+  if (columns == cols && rowCount == lines.size()) return;
+
+  auto excess = cy - (rowCount - 1);
+  for (int i = 0; i < excess; ++i) {
+    if (!alternate) pushScrollback(lines.first());
+    lines.removeFirst();
+  }
+  cy -= qMax(0, excess);
+
+  cols = columns;
+  for (auto& line : lines) {
+    auto width = line.size();
+
+    line.resize(cols);
+    for (int i = width; i < cols; ++i) line[i] = SPACE;
+  }
+
+  while (lines.size() < rowCount) lines << blank();
+  lines.resize(rowCount);
+
+  for (auto& line : primary) {
+    auto width = line.size();
+
+    line.resize(cols);
+    for (int i = width; i < cols; ++i) line[i] = SPACE;
+  }
+  while (alternate && primary.size() < rowCount) primary << blank();
+  primary.resize(alternate ? rowCount : 0);
+
+  dirty.resize(rowCount);
+  top = 0;
+  bottom = rowCount - 1;
+  moveTo(cy, cx);
+  damageFrom(0);
+}
+
+void Screen::reset() {
+  setAttr(PLAIN);
+  savedAttr = PLAIN;
+  cx = cy = savedX = savedY = 0;
+  wrapPending = false;
+  top = 0;
+  bottom = lines.size() - 1;
+  autowrap = true;
+  showCursor = true;
+  appKeys = false;
+  bracketed = false;
+  alternate = false;
+  primary.clear();
+
+  for (auto& line : lines) line = blank();
+  damageFrom(0);
+}
+
+Screen::Screen(int columns, int rowCount)
+    : cols(qMax(1, columns)), scrolled(0) {
+  lines.resize(qMax(1, rowCount));
+  dirty.resize(lines.size());
+
+  reset();
+}
+
+}  // namespace gyreui
@@ -0,0 +1,122 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Screen.h: terminal cell grid
+ **
+ **/
+#ifndef GYREUI_UI_SCREEN_H_
+#define GYREUI_UI_SCREEN_H_
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+#include "Scrollback.h"
+
+namespace gyreui {
+
+/** * packed screen rows over a Scrollback, every change marks its row
+      damaged **/
+class Screen {
+ public:
+  typedef QVector<Cell> Row;
+
+  static const int SCROLLBACK_MAX = 10000;
+  static const int TAB_WIDTH = 8;
+
+  int columns() const { return cols; }
+  int rows() const { return lines.size(); }
+  const Row& row(int n) const { return lines[n]; }
+
+  const Scrollback& scrollback() const { return history; }
+  int scrollbackSize() const { return history.size(); }
+  const CellAttr& attribute(quint16 n) const { return history.attr(n); }
+
+  int cursorRow() const { return cy; }
+  int cursorColumn() const { return cx; }
+  bool cursorVisible() const { return showCursor; }
+  bool appCursorKeys() const { return appKeys; }
+  bool bracketedPaste() const { return bracketed; }
+  QString title() const { return titleText; }
+
+  /** * damage since the last take **/
+  QBitArray takeDamage();
+  int takeScrolled();
+
+  /** * device status replies owed to the program **/
+  QByteArray takeReplies();
+
+  /** * called by the parser **/
+  void print(char32_t);
+  void execute(char);
+  void csi(const QVector<int>&, const QByteArray&, char);
+  void esc(const QByteArray&, char);
+  void osc(const QByteArray&);
+
+  void resize(int, int);
+  void reset();
+
+  Screen(int, int);
+
+ private:
+  Row blank() const { return Row(cols, packCell(U' ', pen)); }
+  void setAttr(const CellAttr&);
+  void pushScrollback(const Row&);
+  void damage(int n) { dirty.setBit(n); }
+  void damageFrom(int);
+
+  void lineFeed();
+  void reverseIndex();
+  void scrollUp(int);
+  void scrollDown(int);
+  void moveTo(int, int);
+
+  void eraseDisplay(int);
+  void eraseLine(int);
+  void insertChars(int);
+  void deleteChars(int);
+  void sgr(const QVector<int>&);
+  void mode(const QVector<int>&, bool, bool);
+  void altScreen(bool);
+
+  int cols;
+  QVector<Row> lines;
+  Scrollback history;
+  QVector<Row> primary;
+  QBitArray dirty;
+  int scrolled;
+
+  int cx;
+  int cy;
+  bool wrapPending;
+  CellAttr attr;
+  quint16 pen;
+
+  int top;
+  int bottom;
+
+  int savedX;
+  int savedY;
+  CellAttr savedAttr;
+
+  bool autowrap;
+  bool showCursor;
+  bool appKeys;
+  bool bracketed;
+  bool alternate;
+
+  QString titleText;
+  QByteArray replies;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_SCREEN_H_ */
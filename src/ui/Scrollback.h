@@ -0,0 +1,195 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Scrollback.h: attributed line store shared by consoles and terminals
+ **
+ **/
+#ifndef GYREUI_UI_SCROLLBACK_H_
+#define GYREUI_UI_SCROLLBACK_H_
+
+#include <QBitArray>
+#include <QColor>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace gyreui {
+
+/** * colors are 0 for the default or 0xff000000 | rgb **/
+struct CellAttr {
+  enum { BOLD = 1, ITALIC = 2, UNDERLINE = 4, INVERSE = 8 };
+
+  quint32 fg;
+  quint32 bg;
+  quint8 flags;
+
+  QColor foreground(const QColor& def) const {
+    return fg == 0 ? def : QColor(QRgb(fg));
+  }
+  QColor background(const QColor& def) const {
+    return bg == 0 ? def : QColor(QRgb(bg));
+  }
+
+  bool operator==(const CellAttr& other) const {
+    return fg == other.fg && bg == other.bg && flags == other.flags;
+  }
+  bool operator!=(const CellAttr& other) const { return !(*this == other); }
+};
+
+inline uint qHash(const CellAttr& attr, uint seed = 0) {
+  return ::qHash((quint64(attr.fg) << 32 | attr.bg) ^ attr.flags, seed);
+}
+
+/** * attribute index from start to the next run, plain before the first **/
+struct AttrRun {
+  int start;
+  quint16 attr;
+};
+
+/** * a grid cell, 21 bits of codepoint and 11 of attribute index **/
+typedef quint32 Cell;
+
+inline Cell packCell(char32_t ch, quint16 attr) {
+  return (ch & 0x1fffff) | static_cast<quint32>(attr) << 21;
+}
+inline char32_t cellChar(Cell cell) { return cell & 0x1fffff; }
+inline quint16 cellAttr(Cell cell) { return cell >> 21; }
+
+/** * text and run-length attributes kept side by side, both implicitly
+      shared, so a copy for a worker thread or a session costs nothing **/
+class Scrollback {
+ public:
+  static const int MAX_ATTRS = 1 << 11;
+  static const quint16 PLAIN = 0;
+
+  int size() const { return texts.size(); }
+  bool isEmpty() const { return texts.isEmpty(); }
+
+  const QString& text(int row) const { return texts.at(row); }
+  const QVector<AttrRun>& runs(int row) const { return attrRuns.at(row); }
+  const QStringList& lines() const { return texts; }
+
+  const CellAttr& attr(quint16 n) const { return table.at(n); }
+
+  /** * index for attr, PLAIN once the table is full and nothing's been
+        reclaimed **/
+  quint16 intern(const CellAttr& attr) {
+    auto n = index.value(attr, -1);
+    if (n >= 0) return n;
+
+    if (!unused.isEmpty()) {
+      n = unused.takeLast();
+      table[n] = attr;
+    } else if (table.size() < MAX_ATTRS) {
+      n = table.size();
+      table << attr;
+    } else {
+      return PLAIN;
+    }
+
+    index.insert(attr, n);
+    return n;
+  }
+
+  /** * true when the table has no room left for another attribute **/
+  bool full() const { return unused.isEmpty() && table.size() == MAX_ATTRS; }
+
+  /** * entries no row uses, and none of live, are free for intern again.
+        live is sized MAX_ATTRS, for indexes held outside the scrollback **/
+  void reclaim(QBitArray live) {
+    live.resize(MAX_ATTRS);
+    live.setBit(PLAIN);
+
+    for (auto& runs : attrRuns)
+      for (auto& run : runs) live.setBit(run.attr);
+
+    unused.clear();
+    for (int n = table.size() - 1; n > PLAIN; --n)
+      if (!live.testBit(n)) {
+        index.remove(table[n]);
+        unused << n;
+      }
+  }
+
+  void append(const QString& text, quint16 attr = PLAIN) {
+    texts << text;
+    attrRuns << (attr == PLAIN ? QVector<AttrRun>()
+                               : QVector<AttrRun>{{0, attr}});
+  }
+
+  void append(const QString& text, const QVector<AttrRun>& runs) {
+    texts << text;
+    attrRuns << runs;
+  }
+
+  /** * a grid row, trailing blanks dropped **/
+  void append(const Cell* cells, int count) {
+    QString text;
+    QVector<AttrRun> runs;
+
+    decode(cells, count, text, runs);
+    append(text, runs);
+  }
+
+  /** * grid cells as text and runs, against this attribute table **/
+  void decode(const Cell* cells, int count, QString& text,
+              QVector<AttrRun>& runs) const {
+    while (count > 0 && cellChar(cells[count - 1]) == U' ' &&
+           attr(cellAttr(cells[count - 1])).bg == 0 &&
+           !(attr(cellAttr(cells[count - 1])).flags & CellAttr::INVERSE))
+      --count;
+
+    quint16 current = PLAIN;
+
+    for (int i = 0; i < count; ++i) {
+      auto index = cellAttr(cells[i]);
+      if (index != current) {
+        runs.push_back({text.size(), index});
+        current = index;
+      }
+
+      auto ch = cellChar(cells[i]);
+      if (QChar::requiresSurrogates(ch)) {
+        text += QChar(QChar::highSurrogate(ch));
+        text += QChar(QChar::lowSurrogate(ch));
+      } else {
+        text += QChar(static_cast<ushort>(ch));
+      }
+    }
+  }
+
+  void removeFirst() {
+    texts.removeFirst();
+    attrRuns.removeFirst();
+  }
+
+  void clear() {
+    texts.clear();
+    attrRuns.clear();
+  }
+
+  Scrollback() {
+    table << CellAttr{0, 0, 0};
+    index.insert(table.first(), PLAIN);
+  }
+
+ private:
+  QStringList texts;
+  QList<QVector<AttrRun>> attrRuns;
+  QVector<CellAttr> table;
+  QHash<CellAttr, int> index;
+  QVector<quint16> unused;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_SCROLLBACK_H_ */
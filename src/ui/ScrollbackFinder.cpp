@@ -0,0 +1,106 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  ScrollbackFinder.cpp: background scrollback search implementation
+ **
+ **  the scan works on an implicitly shared copy of the scrollback and
+ **  checks every few thousand lines whether it has been overtaken by a
+ **  newer query, so typing never waits on a stale search.
+ **
+ **/
+#include "ScrollbackFinder.h"
+
+#include <QCoreApplication>
+#include <QMetaObject>
+
+namespace gyreui {
+
+void ScrollbackFinder::find(QStringList lines, QString query,
+                            QObject* receiver, Reply reply) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  pending = {lines, query, receiver, reply};
+  requested++;
+  ready.notify_one();
+}
+
+void ScrollbackFinder::cancel() {
+  std::lock_guard<std::mutex> guard(lock);
+
+  pending = Request();
+  taken = ++requested;
+}
+
+bool ScrollbackFinder::superseded(quint64 generation) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  return stopping || requested != generation;
+}
+
+void ScrollbackFinder::run() {
+  for (;;) {
+    Request request;
+    quint64 generation;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      ready.wait(guard, [this]() { return stopping || requested != taken; });
+      if (stopping) return;
+
+      request = std::move(pending);
+      pending = Request();
+      generation = taken = requested;
+    }
+
+    QVector<Match> matches;
+    auto abandoned = request.query.isEmpty();
+
+    for (int row = 0; row < request.lines.size() && !abandoned; ++row) {
+      auto& line = request.lines.at(row);
+
+      for (int col = line.indexOf(request.query, 0, Qt::CaseInsensitive);
+           col >= 0;
+           col = line.indexOf(request.query, col + request.query.size(),
+                              Qt::CaseInsensitive))
+        matches.push_back({row, col});
+
+      if (row % CHECK_EVERY == 0) abandoned = superseded(generation);
+    }
+
+    if (abandoned || superseded(generation)) continue;
+
+    auto target = request.receiver;
+    auto reply = request.reply;
+    auto query = request.query;
+
+    QMetaObject::invokeMethod(
+        QCoreApplication::instance(),
+        [target, reply, query, matches]() {
+          if (target) reply(query, matches);
+        },
+        Qt::QueuedConnection);
+  }
+}
+
+ScrollbackFinder::ScrollbackFinder()
+    : requested(0), taken(0), stopping(false) {
+  worker = std::thread([this]() { run(); });
+}
+
+ScrollbackFinder::~ScrollbackFinder() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+    ready.notify_one();
+  }
+
+  worker.join();
+}
+
+}  // namespace gyreui
@@ -0,0 +1,71 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  ScrollbackFinder.h: background scrollback search
+ **
+ **/
+#ifndef GYREUI_UI_SCROLLBACKFINDER_H_
+#define GYREUI_UI_SCROLLBACKFINDER_H_
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace gyreui {
+
+/** * one search at a time, a newer request abandons the one in progress **/
+class ScrollbackFinder {
+ public:
+  struct Match {
+    int row;
+    int column;
+  };
+
+  typedef std::function<void(QString, QVector<Match>)> Reply;
+
+  /** * lines is a copy, appends on the gui thread don't disturb the scan **/
+  void find(QStringList lines, QString query, QObject* receiver, Reply);
+  void cancel();
+
+  ScrollbackFinder();
+  ~ScrollbackFinder();
+
+ private:
+  struct Request {
+    QStringList lines;
+    QString query;
+    QPointer<QObject> receiver;
+    Reply reply;
+  };
+
+  static const int CHECK_EVERY = 4096;
+
+  void run();
+  bool superseded(quint64);
+
+  std::mutex lock;
+  std::condition_variable ready;
+  Request pending;
+  quint64 requested;
+  quint64 taken;
+  bool stopping;
+  std::thread worker;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_SCROLLBACKFINDER_H_ */
@@ -0,0 +1,193 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  SearchFrame.cpp: SearchFrame implementation
+ **
+ **  every keystroke is a new search, the index drops the one it was
+ **  running. batches carry the ticket of their search so a late one
+ **  from an abandoned search is ignored.
+ **
+ **/
+#include <QFileDialog>
+#include <QFontDatabase>
+#include <QLabel>
+#include <QString>
+#include <QToolBar>
+#include <QtWidgets>
+
+#include "SearchFrame.h"
+
+namespace gyreui {
+
+/** * model **/
+int MatchModel::rowCount(const QModelIndex& parent) const {
+  return parent.isValid() ? 0 : rows.size();
+}
+
+QVariant MatchModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid() || index.row() >= rows.size()) return QVariant();
+
+  auto& match = rows[index.row()];
+
+  switch (role) {
+    case Qt::DisplayRole: {
+      auto path = match.path;
+      if (path.startsWith(root)) path = path.mid(root.size());
+
+      return QString("%1:%2: %3")
+          .arg(path)
+          .arg(match.line)
+          .arg(match.text.trimmed());
+    }
+    case Qt::ToolTipRole:
+      return QString("%1:%2:%3").arg(match.path).arg(match.line).arg(
+          match.column);
+    default:
+      return QVariant();
+  }
+}
+
+void MatchModel::append(const QVector<SearchIndex::Match>& matches) {
+  if (matches.isEmpty()) return;
+
+  beginInsertRows(QModelIndex(), rows.size(),
+                  rows.size() + matches.size() - 1);
+  rows += matches;
+  endInsertRows();
+}
+
+void MatchModel::clear() {
+  beginResetModel();
+  rows.clear();
+  endResetModel();
+}
+
+void MatchModel::setRoot(QString path) { root = path + '/'; }
+
+MatchModel::MatchModel(QObject* parent) : QAbstractListModel(parent) {}
+
+/** * frame **/
+void SearchFrame::search() {
+  model->clear();
+  model->setRoot(index->root());
+  outcome.clear();
+
+  auto text = queryEdit->text();
+
+  ticket = index->search(
+      text, regexAction->isChecked(), caseAction->isChecked(), this,
+      [this](const SearchIndex::Results& results) { received(results); });
+
+  if (!text.isEmpty()) outcome = tr("searching");
+  status();
+
+  LayoutStore::instance()->changed();
+}
+
+void SearchFrame::received(const SearchIndex::Results& results) {
+  if (results.ticket != ticket) return;
+
+  model->append(results.matches);
+
+  if (!results.error.isEmpty())
+    outcome = results.error;
+  else if (results.done)
+    outcome = tr("%1%2 matches in %3 files, %4ms")
+                  .arg(model->rowCount(QModelIndex()))
+                  .arg(results.truncated ? "+" : "")
+                  .arg(results.candidates)
+                  .arg(results.msecs);
+
+  status();
+}
+
+void SearchFrame::chooseRoot() {
+  auto path =
+      QFileDialog::getExistingDirectory(this, tr("Search Root"), index->root());
+  if (path.isEmpty()) return;
+
+  index->setRoot(path);
+  search();
+}
+
+void SearchFrame::status() {
+  auto text = index->status();
+  if (!outcome.isEmpty()) text = outcome + " | " + text;
+
+  statusLabel->setText(text);
+}
+
+QJsonObject SearchFrame::saveState() const {
+  return QJsonObject{{"root", index->root()},
+                     {"query", queryEdit->text()},
+                     {"regex", regexAction->isChecked()},
+                     {"case", caseAction->isChecked()}};
+}
+
+void SearchFrame::restoreState(const QJsonObject& state) {
+  if (state.contains("root")) index->setRoot(state["root"].toString());
+
+  regexAction->setChecked(state["regex"].toBool());
+  caseAction->setChecked(state["case"].toBool());
+  queryEdit->setText(state["query"].toString());
+}
+
+SearchFrame::SearchFrame(QString name, MainWindow* tb)
+    : mw(tb), name(name), index(SearchIndex::instance()), ticket(0) {
+  toolBar = new QToolBar();
+
+  queryEdit = new QLineEdit();
+  queryEdit->setPlaceholderText(tr("search"));
+  queryEdit->setClearButtonEnabled(true);
+  toolBar->addWidget(queryEdit);
+
+  regexAction = toolBar->addAction(tr("regex"));
+  regexAction->setCheckable(true);
+
+  caseAction = toolBar->addAction(tr("case"));
+  caseAction->setCheckable(true);
+
+  connect(toolBar->addAction(tr("root")), &QAction::triggered, this,
+          &SearchFrame::chooseRoot);
+  connect(toolBar->addAction(tr("reindex")), &QAction::triggered, this,
+          [this]() { index->rebuild(); });
+
+  model = new MatchModel(this);
+
+  matchView = new QListView();
+  matchView->setModel(model);
+  matchView->setUniformItemSizes(true);
+  matchView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+  statusLabel = new QLabel();
+
+  connect(queryEdit, &QLineEdit::textChanged, this, &SearchFrame::search);
+  connect(regexAction, &QAction::toggled, this, &SearchFrame::search);
+  connect(caseAction, &QAction::toggled, this, &SearchFrame::search);
+  connect(index, &SearchIndex::statusChanged, this, &SearchFrame::status);
+  connect(matchView, &QListView::activated, this,
+          [this](const QModelIndex& at) {
+            auto& match = model->match(at.row());
+            emit openFile(match.path, match.line);
+          });
+
+  auto layout = new QVBoxLayout;
+  layout->setContentsMargins(5, 5, 5, 5);
+  layout->addWidget(toolBar);
+  layout->addWidget(matchView);
+  layout->addWidget(statusLabel);
+
+  setLayout(layout);
+
+  if (index->root().isEmpty()) index->setRoot(mw->userInfo()->userdir());
+  status();
+}
+
+}  // namespace gyreui
@@ -0,0 +1,104 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  SearchFrame.h: SearchFrame class
+ **
+ **/
+#ifndef GYREUI_UI_SEARCHFRAME_H_
+#define GYREUI_UI_SEARCHFRAME_H_
+
+#include <QAbstractListModel>
+#include <QFrame>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
+#include <QToolBar>
+#include <QWidget>
+
+#include "Layout.h"
+#include "MainWindow.h"
+#include "SearchIndex.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QLineEdit;
+class QListView;
+class QToolBar;
+class QVBoxLayout;
+class QWidget;
+QT_END_NAMESPACE
+
+namespace gyreui {
+
+class MainWindow;
+
+/** * matches as they stream in, the view asks only for what it shows **/
+class MatchModel : public QAbstractListModel {
+  Q_OBJECT
+
+ public:
+  int rowCount(const QModelIndex&) const override;
+  QVariant data(const QModelIndex&, int) const override;
+
+  void append(const QVector<SearchIndex::Match>&);
+  void clear();
+  const SearchIndex::Match& match(int row) const { return rows[row]; }
+
+  void setRoot(QString);
+
+  explicit MatchModel(QObject*);
+
+ private:
+  QVector<SearchIndex::Match> rows;
+  QString root;
+};
+
+class SearchFrame : public QFrame, public FrameState {
+  Q_OBJECT
+
+ public:
+  explicit SearchFrame(QString, MainWindow*);
+
+  QJsonObject saveState() const override;
+  void restoreState(const QJsonObject&) override;
+
+ signals:
+  void openFile(QString, int);
+
+ private:
+  void search();
+  void received(const SearchIndex::Results&);
+  void chooseRoot();
+  void status();
+
+  void setContextStatus(QString str) { mw->setContextStatus(str); }
+
+  void showEvent(QShowEvent* event) override {
+    QWidget::showEvent(event);
+    mw->setContextStatus(name);
+  }
+
+  MainWindow* mw;
+  QString name;
+  SearchIndex* index;
+  MatchModel* model;
+  quint64 ticket;
+  QString outcome;
+  QListView* matchView;
+  QLineEdit* queryEdit;
+  QAction* regexAction;
+  QAction* caseAction;
+  QLabel* statusLabel;
+  QToolBar* toolBar;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_SEARCHFRAME_H_ */
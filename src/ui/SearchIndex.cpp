@@ -0,0 +1,622 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  SearchIndex.cpp: project search implementation
+ **
+ **  the index lives in ~/.gyre-ui-index. on a new root the builder
+ **  thread maps the index if it was built for that root and walks the
+ **  tree to find what changed since, otherwise it builds one, reading
+ **  files on every core. a tree watcher keeps a list of files changed
+ **  or removed since the index was written; queries read those from
+ **  disk instead, and enough of them rebuild the index.
+ **
+ **  a query takes the trigrams of the literal runs its pattern has to
+ **  contain, intersects their posting lists, and reads only the files
+ **  left, streaming matches back a batch at a time.
+ **
+ **/
+#include "SearchIndex.h"
+
+#include <dirent.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMetaObject>
+#include <QRegularExpression>
+#include <QStringList>
+
+#include "LogBus.h"
+
+namespace gyreui {
+
+namespace {
+
+const int CHECK_EVERY = 256;
+const int BINARY_PROBE = 8000;
+const int LINE_MAX = 200;
+
+bool binary(const QByteArray& bytes) {
+  return memchr(bytes.constData(), 0, qMin(bytes.size(), BINARY_PROBE)) !=
+         nullptr;
+}
+
+/** * folding is ascii only, so a case blind query drops the rest **/
+QVector<quint32> queryTrigrams(const QStringList& runs, bool caseSensitive) {
+  QVector<quint32> out;
+
+  for (auto& run : runs)
+    for (auto trigram : TrigramIndex::trigrams(run.toUtf8()))
+      if (caseSensitive || (trigram & 0x808080) == 0) out << trigram;
+
+  std::sort(out.begin(), out.end());
+  out.erase(std::unique(out.begin(), out.end()), out.end());
+
+  return out;
+}
+
+bool under(const QString& path, const QHash<QString, quint64>& dirs) {
+  for (auto it = dirs.begin(); it != dirs.end(); ++it)
+    if (path.startsWith(it.key())) return true;
+
+  return false;
+}
+
+/** * what a new index has taken in **/
+void prune(QHash<QString, quint64>& changes, quint64 tick) {
+  for (auto it = changes.begin(); it != changes.end();)
+    if (it.value() <= tick)
+      it = changes.erase(it);
+    else
+      ++it;
+}
+
+}  // namespace
+
+SearchIndex* SearchIndex::instance() {
+  static SearchIndex index;
+
+  return &index;
+}
+
+void SearchIndex::announce() {
+  if (announced.exchange(true)) return;
+
+  QMetaObject::invokeMethod(
+      this,
+      [this]() {
+        announced.store(false);
+        emit statusChanged();
+      },
+      Qt::QueuedConnection);
+}
+
+void SearchIndex::progress(QString text) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    state = text;
+  }
+
+  announce();
+}
+
+QString SearchIndex::status() {
+  std::lock_guard<std::mutex> guard(lock);
+
+  auto changes = dirty.size() + gone.size();
+
+  if (changes == 0) return state;
+
+  return tr("%1, %2 changed since").arg(state).arg(changes);
+}
+
+void SearchIndex::setRoot(QString path) {
+  auto root = QDir::cleanPath(QDir(path).absolutePath());
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (root == rootPath) return;
+
+    rootPath = root;
+    generation++;
+    current.reset();
+    dirty.clear();
+    gone.clear();
+    goneDirs.clear();
+
+    job = REFRESH;
+    wanted.notify_one();
+  }
+
+  watcher->clear();
+  progress(tr("opening %1").arg(root));
+}
+
+QString SearchIndex::root() {
+  std::lock_guard<std::mutex> guard(lock);
+
+  return rootPath;
+}
+
+void SearchIndex::rebuild() {
+  std::lock_guard<std::mutex> guard(lock);
+
+  if (rootPath.isEmpty()) return;
+
+  job = REBUILD;
+  wanted.notify_one();
+}
+
+/** * builder thread **/
+bool SearchIndex::superseded(quint64 round) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  return stopping.load() || generation != round;
+}
+
+/** * hidden entries and links are left out, each directory is watched
+      before it is read **/
+bool SearchIndex::walk(QString root, QVector<TrigramIndex::File>& files,
+                       quint64 round) {
+  QStringList dirs{QString()};
+
+  for (int count = 1; !dirs.isEmpty(); ++count) {
+    auto rel = dirs.takeLast();
+    auto abs = rel.isEmpty() ? root : root + '/' + rel;
+
+    watcher->watch(abs);
+
+    auto dp = opendir(QFile::encodeName(abs).constData());
+    if (dp == nullptr) continue;
+
+    for (auto ent = readdir(dp); ent != nullptr; ent = readdir(dp)) {
+      if (ent->d_name[0] == '.') continue;
+
+      struct stat st;
+      if (fstatat(dirfd(dp), ent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+        continue;
+
+      auto name = QFile::decodeName(ent->d_name);
+      auto path = rel.isEmpty() ? name : rel + '/' + name;
+
+      if (S_ISDIR(st.st_mode))
+        dirs << path;
+      else if (S_ISREG(st.st_mode) && st.st_size <= MAX_FILE_SIZE)
+        files << TrigramIndex::File{path, qint64(st.st_mtime),
+                                    qint64(st.st_size)};
+    }
+
+    closedir(dp);
+
+    if (count % CHECK_EVERY == 0) {
+      if (superseded(round)) return false;
+      progress(tr("scanning %1, %2 files").arg(root).arg(files.size()));
+    }
+  }
+
+  return !superseded(round);
+}
+
+void SearchIndex::index(QString root, quint64 round) {
+  QElapsedTimer timer;
+  timer.start();
+
+  quint64 since;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    since = ticks;
+  }
+
+  QVector<TrigramIndex::File> files;
+  if (!walk(root, files, round)) return;
+
+  progress(tr("indexing %1 files").arg(files.size()));
+
+  /* each worker fills in its own files' slots, packed as they're read */
+  const auto& list = files;
+  QVector<QByteArray> packed(files.size());
+  auto lists = packed.data();
+  auto threads = qMax(1u, std::thread::hardware_concurrency());
+  std::vector<std::thread> workers;
+  std::atomic<int> next(0);
+
+  for (unsigned w = 0; w < threads; ++w)
+    workers.emplace_back([this, &list, lists, &next, root, round]() {
+      for (int i = next++; i < list.size(); i = next++) {
+        if (i % CHECK_EVERY == 0 && superseded(round)) return;
+
+        QFile file(root + '/' + list[i].path);
+        if (!file.open(QIODevice::ReadOnly)) continue;
+
+        auto bytes = file.read(MAX_FILE_SIZE);
+        if (binary(bytes)) continue;
+
+        lists[i] = TrigramIndex::pack(TrigramIndex::trigrams(bytes));
+      }
+    });
+
+  for (auto& worker : workers) worker.join();
+  if (superseded(round)) return;
+
+  auto built = std::make_shared<TrigramIndex>();
+  if (!TrigramIndex::write(indexPath, root, files, packed) ||
+      !built->open(indexPath)) {
+    LogBus::instance()->post(LogEntry::ERROR, "search",
+                             "can't write " + indexPath);
+    progress(tr("can't write %1").arg(indexPath));
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (generation != round) return;
+
+    current = built;
+    prune(dirty, since);
+    prune(gone, since);
+    prune(goneDirs, since);
+  }
+
+  auto done = tr("%1 files indexed in %2s")
+                  .arg(files.size())
+                  .arg(timer.elapsed() / 1000.0, 0, 'f', 1);
+
+  LogBus::instance()->post(LogEntry::INFO, "search", root + ": " + done);
+  progress(done);
+}
+
+/** * an index for this root is mapped as is, then checked against the
+      tree for what changed while we weren't watching **/
+void SearchIndex::refresh(QString root, quint64 round) {
+  auto loaded = std::make_shared<TrigramIndex>();
+
+  if (!loaded->open(indexPath) || loaded->root() != root) {
+    index(root, round);
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (generation != round) return;
+
+    current = loaded;
+  }
+
+  progress(tr("%1 files indexed, checking").arg(loaded->files()));
+
+  QVector<TrigramIndex::File> files;
+  if (!walk(root, files, round)) return;
+
+  QHash<QString, QPair<qint64, qint64>> known;
+  known.reserve(loaded->files());
+
+  for (int id = 0; id < loaded->files(); ++id) {
+    auto file = loaded->file(id);
+    known.insert(file.path, {file.mtime, file.size});
+  }
+
+  int stale;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (generation != round) return;
+
+    auto tick = ++ticks;
+    for (auto& file : files) {
+      auto it = known.find(file.path);
+
+      if (it == known.end() || it.value() != qMakePair(file.mtime, file.size))
+        dirty.insert(root + '/' + file.path, tick);
+      if (it != known.end()) known.erase(it);
+    }
+
+    for (auto it = known.begin(); it != known.end(); ++it)
+      gone.insert(root + '/' + it.key(), tick);
+
+    stale = dirty.size() + gone.size();
+  }
+
+  if (stale > REBUILD_AT)
+    index(root, round);
+  else
+    progress(tr("%1 files indexed").arg(loaded->files()));
+}
+
+void SearchIndex::build() {
+  for (;;) {
+    Job todo;
+    QString root;
+    quint64 round;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      busy = false;
+
+      wanted.wait(guard, [this]() { return stopping.load() || job != NONE; });
+      if (stopping.load()) return;
+
+      todo = job;
+      job = NONE;
+      busy = true;
+      root = rootPath;
+      round = generation;
+    }
+
+    if (todo == REFRESH)
+      refresh(root, round);
+    else
+      index(root, round);
+  }
+}
+
+/** * watcher thread **/
+void SearchIndex::changed(TreeWatcher::Change change, QString path) {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+
+    if (change == TreeWatcher::OVERFLOWED) {
+      if (job == NONE) job = REFRESH;
+      wanted.notify_one();
+      return;
+    }
+
+    if (!path.startsWith(rootPath + '/')) return;
+
+    auto tick = ++ticks;
+    switch (change) {
+      case TreeWatcher::CHANGED:
+        gone.remove(path);
+        dirty.insert(path, tick);
+        break;
+      case TreeWatcher::REMOVED:
+        dirty.remove(path);
+        gone.insert(path, tick);
+        break;
+      case TreeWatcher::DIR_REMOVED:
+        path += '/';
+        goneDirs.insert(path, tick);
+        for (auto it = dirty.begin(); it != dirty.end();)
+          if (it.key().startsWith(path))
+            it = dirty.erase(it);
+          else
+            ++it;
+        break;
+      default:
+        break;
+    }
+
+    if (dirty.size() + gone.size() > REBUILD_AT && job == NONE && !busy) {
+      job = REBUILD;
+      wanted.notify_one();
+    }
+  }
+
+  announce();
+}
+
+/** * search thread **/
+quint64 SearchIndex::search(QString text, bool regex, bool caseSensitive,
+                            QObject* receiver, Reply reply) {
+  std::lock_guard<std::mutex> guard(queryLock);
+
+  pending = {text, regex, caseSensitive, receiver, reply};
+  asked.notify_one();
+
+  return ++requested;
+}
+
+bool SearchIndex::abandoned(quint64 ticket) {
+  std::lock_guard<std::mutex> guard(queryLock);
+
+  return stopping.load() || requested != ticket;
+}
+
+void SearchIndex::post(const Query& query, Results& results) {
+  auto target = query.receiver;
+  auto reply = query.reply;
+  auto batch = results;
+
+  QMetaObject::invokeMethod(
+      QCoreApplication::instance(),
+      [target, reply, batch]() {
+        if (target) reply(batch);
+      },
+      Qt::QueuedConnection);
+
+  results.matches.clear();
+}
+
+void SearchIndex::find() {
+  for (;;) {
+    Query query;
+    quint64 ticket;
+    {
+      std::unique_lock<std::mutex> guard(queryLock);
+      asked.wait(guard,
+                 [this]() { return stopping.load() || requested != taken; });
+      if (stopping.load()) return;
+
+      query = std::move(pending);
+      pending = Query();
+      ticket = taken = requested;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    Results results{ticket, {}, 0, 0, false, false, QString()};
+
+    std::shared_ptr<TrigramIndex> mapped;
+    QString root;
+    QHash<QString, quint64> changes, removed, removedDirs;
+    {
+      std::lock_guard<std::mutex> guard(lock);
+
+      mapped = current;
+      root = rootPath;
+      changes = dirty;
+      removed = gone;
+      removedDirs = goneDirs;
+    }
+
+    QRegularExpression re;
+    if (query.regex) {
+      re.setPattern(query.text);
+      re.setPatternOptions(
+          QRegularExpression::MultilineOption |
+          (query.caseSensitive ? QRegularExpression::NoPatternOption
+                               : QRegularExpression::CaseInsensitiveOption));
+      re.optimize();
+
+      if (!re.isValid()) results.error = re.errorString();
+    }
+
+    if (mapped == nullptr) results.error = tr("the index isn't ready yet");
+
+    if (query.text.isEmpty() || !results.error.isEmpty()) {
+      results.done = true;
+      post(query, results);
+      continue;
+    }
+
+    auto trigrams = queryTrigrams(
+        TrigramIndex::literals(query.text, query.regex), query.caseSensitive);
+
+    QStringList paths;
+    for (auto id : mapped->candidates(trigrams)) {
+      auto path = root + '/' + mapped->file(id).path;
+
+      if (!changes.contains(path) && !removed.contains(path) &&
+          !under(path, removedDirs))
+        paths << path;
+    }
+
+    auto extra = changes.keys();
+    std::sort(extra.begin(), extra.end());
+    paths += extra;
+
+    results.candidates = paths.size();
+
+    auto cs = query.caseSensitive ? Qt::CaseSensitive : Qt::CaseInsensitive;
+    auto found = 0;
+    auto stopped = false;
+
+    QElapsedTimer since;
+    since.start();
+
+    for (auto& path : paths) {
+      if (abandoned(ticket)) {
+        stopped = true;
+        break;
+      }
+
+      QFile file(path);
+      if (!file.open(QIODevice::ReadOnly)) continue;
+
+      auto bytes = file.read(MAX_FILE_SIZE);
+      if (binary(bytes)) continue;
+
+      auto text = QString::fromUtf8(bytes);
+      auto line = 1;
+      auto lineStart = 0;
+
+      /* one match per line, the first */
+      for (int from = 0; from <= text.size() && found < MAX_MATCHES;) {
+        int at;
+
+        if (query.regex) {
+          auto match = re.match(text, from);
+          if (!match.hasMatch()) break;
+          at = match.capturedStart();
+        } else {
+          at = text.indexOf(query.text, from, cs);
+          if (at < 0) break;
+        }
+
+        for (auto nl = text.indexOf('\n', lineStart); nl >= 0 && nl < at;
+             nl = text.indexOf('\n', lineStart)) {
+          line++;
+          lineStart = nl + 1;
+        }
+
+        auto lineEnd = text.indexOf('\n', at);
+        if (lineEnd < 0) lineEnd = text.size();
+
+        results.matches << Match{
+            path, line, at - lineStart + 1,
+            text.mid(lineStart, qMin(lineEnd - lineStart, LINE_MAX))};
+        found++;
+
+        from = lineEnd + 1;
+      }
+
+      if (found >= MAX_MATCHES) {
+        results.truncated = true;
+        break;
+      }
+
+      if (!results.matches.isEmpty() && since.elapsed() >= BATCH_MSECS) {
+        post(query, results);
+        since.restart();
+      }
+    }
+
+    if (stopped) continue;
+
+    results.done = true;
+    results.msecs = timer.elapsed();
+    post(query, results);
+  }
+}
+
+SearchIndex::SearchIndex()
+    : indexPath(QDir::home().filePath(".gyre-ui-index")),
+      generation(0),
+      job(NONE),
+      busy(false),
+      stopping(false),
+      ticks(0),
+      requested(0),
+      taken(0),
+      announced(false) {
+  watcher.reset(new TreeWatcher(
+      [this](TreeWatcher::Change change, QString path) {
+        changed(change, path);
+      }));
+
+  builder = std::thread([this]() { build(); });
+  searcher = std::thread([this]() { find(); });
+
+  /* progress comes from the builder, announcements belong to the gui */
+  moveToThread(QCoreApplication::instance()->thread());
+}
+
+SearchIndex::~SearchIndex() {
+  stopping.store(true);
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    wanted.notify_one();
+  }
+  {
+    std::lock_guard<std::mutex> guard(queryLock);
+    asked.notify_one();
+  }
+
+  builder.join();
+  searcher.join();
+  watcher.reset();
+}
+
+}  // namespace gyreui
@@ -0,0 +1,143 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  SearchIndex.h: project search over a trigram index
+ **
+ **/
+#ifndef GYREUI_UI_SEARCHINDEX_H_
+#define GYREUI_UI_SEARCHINDEX_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <QHash>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QVector>
+
+#include "TreeWatcher.h"
+#include "TrigramIndex.h"
+
+namespace gyreui {
+
+/** * one index, built and kept current in the background **/
+class SearchIndex : public QObject {
+  Q_OBJECT
+
+ public:
+  static const qint64 MAX_FILE_SIZE = 1 << 20;
+  static const int REBUILD_AT = 512;
+  static const int MAX_MATCHES = 5000;
+  static const int BATCH_MSECS = 30;
+
+  struct Match {
+    QString path;
+    int line;
+    int column;
+    QString text;
+  };
+
+  struct Results {
+    quint64 ticket;
+    QVector<Match> matches;
+    int candidates;
+    qint64 msecs;
+    bool done;
+    bool truncated;
+    QString error;
+  };
+
+  typedef std::function<void(const Results&)> Reply;
+
+  static SearchIndex* instance();
+
+  /** * loads the index for root, or builds it, in the background **/
+  void setRoot(QString);
+  QString root();
+  void rebuild();
+
+  /** * a newer search abandons the one in progress, returns its ticket **/
+  quint64 search(QString, bool, bool, QObject*, Reply);
+
+  QString status();
+
+ signals:
+  void statusChanged();
+
+ private:
+  enum Job { NONE, REFRESH, REBUILD };
+
+  struct Query {
+    QString text;
+    bool regex;
+    bool caseSensitive;
+    QPointer<QObject> receiver;
+    Reply reply;
+  };
+
+  SearchIndex();
+  ~SearchIndex();
+
+  /* the builder thread */
+  void build();
+  void refresh(QString, quint64);
+  void index(QString, quint64);
+  bool walk(QString, QVector<TrigramIndex::File>&, quint64);
+  bool superseded(quint64);
+  void progress(QString);
+
+  /* the search thread */
+  void find();
+  void post(const Query&, Results&);
+  bool abandoned(quint64);
+
+  /* the watcher thread */
+  void changed(TreeWatcher::Change, QString);
+
+  void announce();
+
+  QString indexPath;
+
+  std::mutex lock;
+  std::condition_variable wanted;
+  QString rootPath;
+  quint64 generation;
+  Job job;
+  bool busy;
+  std::atomic<bool> stopping;
+  QString state;
+  std::shared_ptr<TrigramIndex> current;
+
+  /* changes since the index was written, by the tick they came in on */
+  quint64 ticks;
+  QHash<QString, quint64> dirty;
+  QHash<QString, quint64> gone;
+  QHash<QString, quint64> goneDirs;
+
+  std::mutex queryLock;
+  std::condition_variable asked;
+  Query pending;
+  quint64 requested;
+  quint64 taken;
+
+  std::atomic<bool> announced;
+  std::unique_ptr<TreeWatcher> watcher;
+  std::thread builder;
+  std::thread searcher;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_SEARCHINDEX_H_ */
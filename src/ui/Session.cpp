@@ -0,0 +1,176 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Session.cpp: named console sessions implementation
+ **
+ **  libmu keeps no per-env accounting, so a session is charged the
+ **  thread cpu time and process resident growth of its own evals.
+ **  sessions sharing an env each see only their own share.
+ **
+ **/
+#include "Session.h"
+
+#include <time.h>
+#include <unistd.h>
+
+#include <QDateTime>
+#include <QFile>
+
+#include "Completer.h"
+#include "MacroExpander.h"
+
+namespace gyreui {
+
+namespace {
+
+qint64 threadCpuNs() {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+qint64 now() { return QDateTime::currentMSecsSinceEpoch(); }
+
+}  // namespace
+
+/** * session **/
+Session::Activity::Activity(Session* session)
+    : session(session),
+      cpu(threadCpuNs()),
+      rss(SessionManager::residentBytes()) {}
+
+Session::Activity::~Activity() {
+  session->evals++;
+  session->cpuNs += threadCpuNs() - cpu;
+  session->rssBytes += qMax(0LL, SessionManager::residentBytes() - rss);
+  session->touch();
+}
+
+GyreEnv* Session::env() {
+  if (gyre == nullptr) {
+    auto rss = SessionManager::residentBytes();
+
+    gyre = std::shared_ptr<GyreEnv>(new GyreEnv(), [](GyreEnv* env) {
+      Completer::release(env);
+      MacroExpander::release(env);
+      delete env;
+    });
+    rssBytes += qMax(0LL, SessionManager::residentBytes() - rss);
+  }
+
+  return gyre.get();
+}
+
+void Session::touch() {
+  lastUsed = now();
+  SessionManager::instance()->changed();
+}
+
+Session::Session(int id, QString name)
+    : id(id),
+      name(name),
+      tty(nullptr),
+      evals(0),
+      cpuNs(0),
+      rssBytes(0),
+      lastUsed(now()),
+      pinned(false),
+      named(false) {}
+
+/** * manager **/
+SessionManager* SessionManager::instance() {
+  static SessionManager manager;
+
+  return &manager;
+}
+
+/** * resident set size, 0 where /proc isn't available **/
+qint64 SessionManager::residentBytes() {
+  QFile statm("/proc/self/statm");
+
+  if (!statm.open(QFile::ReadOnly)) return 0;
+
+  auto fields = statm.readLine().split(' ');
+  return fields.size() > 1 ? fields[1].toLongLong() * sysconf(_SC_PAGESIZE)
+                           : 0;
+}
+
+Session* SessionManager::create(Session* share) {
+  ++serial;
+  auto session = new Session(serial, QString("session-%1").arg(serial));
+
+  if (share != nullptr) {
+    share->env();
+    session->gyre = share->gyre;
+  }
+
+  all << session;
+  changed();
+
+  return session;
+}
+
+void SessionManager::rename(Session* session, QString name) {
+  if (name.isEmpty()) return;
+
+  session->name = name;
+  session->named = true;
+  changed();
+}
+
+/** * drop the env, the scrollback stays **/
+void SessionManager::release(Session* session) {
+  if (session->tty != nullptr || session->pinned) return;
+
+  session->gyre.reset();
+  session->rssBytes = 0;
+  changed();
+}
+
+Session* SessionManager::find(int id) {
+  for (auto session : all)
+    if (session->id == id) return session;
+
+  return nullptr;
+}
+
+void SessionManager::remove(Session* session) {
+  if (session->tty != nullptr || session->pinned) return;
+
+  all.removeOne(session);
+  delete session;
+  changed();
+}
+
+/** * detached sessions idle past IDLE_MSECS give their env back, their
+      scrollback stays. an unnamed one nothing was ever evaluated in, left
+      behind by a console that closed or attached elsewhere, goes **/
+void SessionManager::sweep() {
+  auto cutoff = now() - IDLE_MSECS;
+
+  for (auto session : QList<Session*>(all)) {
+    if (session->tty != nullptr || session->pinned) continue;
+
+    if (!session->named && session->evals == 0)
+      remove(session);
+    else if (session->hasEnv() && session->lastUsed < cutoff)
+      release(session);
+  }
+}
+
+SessionManager::SessionManager() : serial(0) {
+  sweepTimer = new QTimer(this);
+  sweepTimer->setInterval(SWEEP_MSECS);
+  connect(sweepTimer, &QTimer::timeout, this, &SessionManager::sweep);
+  sweepTimer->start();
+}
+
+}  // namespace gyreui
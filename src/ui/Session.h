@@ -0,0 +1,122 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Session.h: named console sessions
+ **
+ **/
+#ifndef GYREUI_UI_SESSION_H_
+#define GYREUI_UI_SESSION_H_
+
+#include <memory>
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include "GyreEnv.h"
+#include "Scrollback.h"
+
+namespace gyreui {
+
+class TtyWidget;
+
+/** * a console's env and scrollback, outlives the console it is shown in **/
+class Session {
+ public:
+  /** * charges cpu time and resident growth to the session **/
+  class Activity {
+   public:
+    explicit Activity(Session*);
+    ~Activity();
+
+   private:
+    Session* session;
+    qint64 cpu;
+    qint64 rss;
+  };
+
+  int id;
+  QString name;
+  Scrollback scrollback;
+  TtyWidget* tty;
+
+  qint64 evals;
+  qint64 cpuNs;
+  qint64 rssBytes;
+  qint64 lastUsed;
+
+  /** * the env, a fresh one if it was released **/
+  GyreEnv* env();
+
+  /** * env handed to other frames, never released while idle **/
+  GyreEnv* pin() {
+    pinned = true;
+    return env();
+  }
+
+  bool hasEnv() const { return gyre != nullptr; }
+  bool isPinned() const { return pinned; }
+  bool sharesEnv(const Session* other) const {
+    return other != this && gyre != nullptr && gyre == other->gyre;
+  }
+
+  void touch();
+
+ private:
+  friend class SessionManager;
+
+  Session(int, QString);
+
+  std::shared_ptr<GyreEnv> gyre;
+  bool pinned;
+  bool named;
+};
+
+class SessionManager : public QObject {
+  Q_OBJECT
+
+ public:
+  static const int IDLE_MSECS = 10 * 60 * 1000;
+  static const int SWEEP_MSECS = 30 * 1000;
+
+  static SessionManager* instance();
+  static qint64 residentBytes();
+
+  /** * share is a session whose env the new one attaches to, or nullptr **/
+  Session* create(Session* share = nullptr);
+  void rename(Session*, QString);
+  void release(Session*);
+  void remove(Session*);
+
+  const QList<Session*>& sessions() { return all; }
+
+  /** * nullptr once it's gone **/
+  Session* find(int);
+
+  void changed() { emit sessionsChanged(); }
+
+ signals:
+  void sessionsChanged();
+
+ private:
+  SessionManager();
+
+  void sweep();
+
+  QList<Session*> all;
+  QTimer* sweepTimer;
+  int serial;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_SESSION_H_ */
@@ -0,0 +1,157 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  SessionsFrame.cpp: SessionsFrame implementation
+ **
+ **/
+#include <QDateTime>
+#include <QHeaderView>
+#include <QLabel>
+#include <QString>
+#include <QTableWidget>
+#include <QToolBar>
+#include <QtWidgets>
+
+#include "SessionsFrame.h"
+
+namespace gyreui {
+
+namespace {
+
+QString bytes(qint64 n) {
+  if (n < 1024 * 1024) return QString("%1K").arg(n / 1024);
+
+  return QString("%1M").arg(n / (1024.0 * 1024.0), 0, 'f', 1);
+}
+
+QString idle(qint64 msecs) {
+  auto secs = msecs / 1000;
+
+  if (secs < 60) return QString("%1s").arg(secs);
+  if (secs < 3600) return QString("%1m").arg(secs / 60);
+
+  return QString("%1h").arg(secs / 3600);
+}
+
+}  // namespace
+
+Session* SessionsFrame::selected() {
+  auto row = sessionTable->currentRow();
+
+  return row >= 0 && row < manager->sessions().size() ? manager->sessions()[row]
+                                                      : nullptr;
+}
+
+void SessionsFrame::release() {
+  auto session = selected();
+
+  if (session == nullptr) return;
+  if (session->tty != nullptr || session->isPinned()) {
+    log(";;; " + session->name + " is attached or in use, not released");
+    return;
+  }
+
+  manager->release(session);
+}
+
+void SessionsFrame::remove() {
+  auto session = selected();
+
+  if (session == nullptr) return;
+  if (session->tty != nullptr || session->isPinned()) {
+    log(";;; " + session->name + " is attached or in use, not closed");
+    return;
+  }
+
+  manager->remove(session);
+}
+
+void SessionsFrame::refresh() {
+  auto& sessions = manager->sessions();
+  auto now = QDateTime::currentMSecsSinceEpoch();
+  qint64 cpu = 0;
+
+  sessionTable->setRowCount(sessions.size());
+
+  for (int row = 0; row < sessions.size(); ++row) {
+    auto session = sessions[row];
+
+    QString env = session->hasEnv() ? tr("live") : tr("released");
+    for (auto other : sessions)
+      if (session->sharesEnv(other))
+        env = tr("shared with %1").arg(other->name);
+    if (session->isPinned()) env += tr(", pinned");
+
+    QStringList cells;
+    cells << session->name
+          << (session->tty != nullptr ? tr("attached") : tr("detached")) << env
+          << QString::number(session->evals)
+          << QString("%1ms").arg(session->cpuNs / 1000000.0, 0, 'f', 1)
+          << bytes(session->rssBytes)
+          << (session->tty != nullptr ? QString()
+                                      : idle(now - session->lastUsed));
+
+    for (int col = 0; col < cells.size(); ++col) {
+      auto item = sessionTable->item(row, col);
+      if (item == nullptr) {
+        item = new QTableWidgetItem();
+        item->setFlags(Qt::ItemIsSelectable | Qt::ItemIsEnabled);
+        sessionTable->setItem(row, col, item);
+      }
+      item->setText(cells[col]);
+    }
+
+    cpu += session->cpuNs;
+  }
+
+  totalLabel->setText(tr("%1 sessions, %2ms cpu, %3 resident")
+                          .arg(sessions.size())
+                          .arg(cpu / 1000000.0, 0, 'f', 1)
+                          .arg(bytes(SessionManager::residentBytes())));
+}
+
+SessionsFrame::SessionsFrame(QString name, MainWindow* tb)
+    : mw(tb), name(name), manager(SessionManager::instance()) {
+  toolBar = new QToolBar();
+  connect(toolBar->addAction(tr("release")), &QAction::triggered, this,
+          &SessionsFrame::release);
+  connect(toolBar->addAction(tr("close")), &QAction::triggered, this,
+          &SessionsFrame::remove);
+
+  sessionTable = new QTableWidget(0, 7);
+  sessionTable->setHorizontalHeaderLabels({tr("session"), tr("console"),
+                                           tr("env"), tr("evals"), tr("cpu"),
+                                           tr("memory"), tr("idle")});
+  sessionTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+  sessionTable->setSelectionMode(QAbstractItemView::SingleSelection);
+  sessionTable->verticalHeader()->hide();
+  sessionTable->horizontalHeader()->setStretchLastSection(true);
+
+  totalLabel = new QLabel();
+
+  connect(manager, &SessionManager::sessionsChanged, this,
+          &SessionsFrame::refresh);
+
+  refreshTimer = new QTimer(this);
+  refreshTimer->setInterval(REFRESH_MSECS);
+  connect(refreshTimer, &QTimer::timeout, this, &SessionsFrame::refresh);
+  refreshTimer->start();
+
+  auto layout = new QVBoxLayout;
+  layout->setContentsMargins(5, 5, 5, 5);
+  layout->addWidget(toolBar);
+  layout->addWidget(sessionTable);
+  layout->addWidget(totalLabel);
+
+  setLayout(layout);
+  refresh();
+}
+
+}  // namespace gyreui
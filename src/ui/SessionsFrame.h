@@ -0,0 +1,74 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  SessionsFrame.h: SessionsFrame class
+ **
+ **/
+#ifndef GYREUI_UI_SESSIONSFRAME_H_
+#define GYREUI_UI_SESSIONSFRAME_H_
+
+#include <QFrame>
+#include <QLabel>
+#include <QTableWidget>
+#include <QTimer>
+#include <QToolBar>
+#include <QWidget>
+
+#include "MainWindow.h"
+#include "Session.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QTableWidget;
+class QTimer;
+class QToolBar;
+class QVBoxLayout;
+class QWidget;
+QT_END_NAMESPACE
+
+namespace gyreui {
+
+class MainWindow;
+
+class SessionsFrame : public QFrame {
+  Q_OBJECT
+
+ public:
+  explicit SessionsFrame(QString, MainWindow*);
+
+ private:
+  static const int REFRESH_MSECS = 1000;
+
+  Session* selected();
+  void release();
+  void remove();
+  void refresh();
+
+  void log(QString msg) { mw->log(msg); }
+
+  void setContextStatus(QString str) { mw->setContextStatus(str); }
+
+  void showEvent(QShowEvent* event) override {
+    QWidget::showEvent(event);
+    mw->setContextStatus(name);
+  }
+
+  MainWindow* mw;
+  QString name;
+  SessionManager* manager;
+  QTableWidget* sessionTable;
+  QLabel* totalLabel;
+  QTimer* refreshTimer;
+  QToolBar* toolBar;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_SESSIONSFRAME_H_ */
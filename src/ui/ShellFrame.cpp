@@ -25,21 +25,64 @@ void ShellFrame::showEvent(QShowEvent* event) {
   mw->setContextStatus(name);
 }
 
+QString ShellFrame::shell() {
+  auto sh = qEnvironmentVariable("SHELL");
+
+  return sh.isEmpty() ? QString("/bin/sh") : sh;
+}
+
+void ShellFrame::start() {
+  auto screen = terminalView->screen();
+
+  if (pty->running()) return;
+
+  if (!pty->start(shell(), screen->columns(), screen->rows())) {
+    log(";;; can't start " + shell());
+    return;
+  }
+
+  titleLabel->setText(shell());
+  terminalView->setFocus();
+}
+
+void ShellFrame::exited(int status) {
+  terminalView->feed(
+      QString("\r\n[%1 exited %2]\r\n").arg(shell()).arg(status).toUtf8());
+  titleLabel->setText(tr("exited"));
+}
+
 ShellFrame::ShellFrame(QString name, MainWindow* tb) : mw(tb), name(name) {
-  ttyWidget = new TtyWidget(this);
+  terminalView = new TerminalView(this);
 
-  QSizePolicy tty_policy = ttyWidget->sizePolicy();
+  QSizePolicy tty_policy = terminalView->sizePolicy();
   tty_policy.setVerticalStretch(1);
-  ttyWidget->setSizePolicy(tty_policy);
+  terminalView->setSizePolicy(tty_policy);
+
+  pty = new Pty(this);
+  connect(pty, &Pty::received, terminalView, &TerminalView::feed);
+  connect(pty, &Pty::finished, this, &ShellFrame::exited);
+  connect(terminalView, &TerminalView::input, pty, &Pty::write);
+  connect(terminalView, &TerminalView::sizeChanged, pty, &Pty::resize);
+
+  titleLabel = new QLabel();
+  connect(terminalView, &TerminalView::titleChanged, titleLabel,
+          &QLabel::setText);
+
+  toolBar = new QToolBar();
+  connect(toolBar->addAction(tr("restart")), &QAction::triggered, this,
+          &ShellFrame::start);
+  toolBar->addWidget(titleLabel);
 
   this->setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
   this->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 
   layout = new QVBoxLayout;
   layout->setContentsMargins(5, 5, 5, 5);
-  layout->addWidget(ttyWidget);
+  layout->addWidget(toolBar);
+  layout->addWidget(terminalView);
 
   setLayout(layout);
+  start();
 }
 
 }  // namespace gyreui
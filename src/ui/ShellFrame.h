@@ -15,42 +15,51 @@
 #define GYREUI_UI_SHELLFRAME_H_
 
 #include <QFrame>
+#include <QLabel>
+#include <QToolBar>
 #include <QWidget>
 
-#include "GyreEnv.h"
 #include "MainWindow.h"
-#include "TtyWidget.h"
+#include "Pty.h"
+#include "TerminalView.h"
 #include "user.h"
 
 QT_BEGIN_NAMESPACE
 class QLabel;
+class QToolBar;
 class QVBoxLayout;
 class QWidget;
 QT_END_NAMESPACE
 
-class TtyWidget;
-
 namespace gyreui {
 
 class MainWindow;
 
+/** * the user's shell on a pseudo-terminal **/
 class ShellFrame : public QFrame {
   Q_OBJECT
 
  public:
   explicit ShellFrame(QString, MainWindow*);
 
-  void log(QString msg) { ttyWidget->writeTty(msg); }
+  void log(QString msg) { mw->log(msg); }
 
   void setContextStatus(QString);
 
   void showEvent(QShowEvent*) override;
 
- protected:
  private:
+  static QString shell();
+
+  void start();
+  void exited(int);
+
   MainWindow* mw;
   QString name;
-  TtyWidget* ttyWidget;
+  Pty* pty;
+  TerminalView* terminalView;
+  QLabel* titleLabel;
+  QToolBar* toolBar;
   QVBoxLayout* layout;
 };
 
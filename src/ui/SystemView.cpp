@@ -11,6 +11,9 @@
  **  SystemView.cpp: SystemView implementation
  **
  **/
+#include <atomic>
+#include <memory>
+
 #include <QFileDialog>
 #include <QLabel>
 #include <QSplitter>
@@ -22,16 +25,134 @@
 
 #include "ComposerFrame.h"
 #include "ConsoleFrame.h"
+#include "DiagnosticsFrame.h"
+#include "ExpanderFrame.h"
 #include "GyreEnv.h"
 #include "InspectorFrame.h"
+#include "Layout.h"
+#include "LogBus.h"
+#include "ProfilerFrame.h"
 #include "ScratchpadFrame.h"
+#include "SearchFrame.h"
+#include "SessionsFrame.h"
+#include "ShellFrame.h"
 #include "SystemView.h"
+#include "TestRunnerFrame.h"
 #include "Tile.h"
 
 namespace gyreui {
 
 void SystemView::log(QString msg) { mw->log(msg); }
 
+/** * whether files load on their own, in parallel, each in a fresh env.
+      nothing they define reaches the dev env **/
+void SystemView::checkLoad() {
+  auto files = QFileDialog::getOpenFileNames(
+      this, tr("Check Load"), mw->userInfo()->userdir(), tr("File (*)"));
+
+  if (files.isEmpty()) return;
+
+  /* the jobs make their own envs, the workers' would go unused */
+  if (pool == nullptr)
+    pool = new EnvPool(0, []() -> GyreEnv* { return nullptr; });
+
+  auto total = files.size();
+  auto left = std::make_shared<std::atomic<int>>(total);
+  auto failed = std::make_shared<std::atomic<int>>(0);
+
+  for (auto& path : files)
+    pool->submit([path, total, left, failed](GyreEnv*) {
+      std::unique_ptr<GyreEnv> env(EnvPool::configuredEnv());
+      auto raw = env.get();
+
+      auto error = env->withException(
+          [raw, path]() { (void)raw->rep(GyreEnv::loadForm(path)); });
+
+      if (error.isEmpty()) {
+        LogBus::instance()->post(LogEntry::INFO, "check", path + " loads");
+      } else {
+        (*failed)++;
+        LogBus::instance()->post(LogEntry::ERROR, "check",
+                                 path + ": " + error);
+      }
+
+      if (--*left == 0)
+        LogBus::instance()->post(
+            failed->load() == 0 ? LogEntry::INFO : LogEntry::WARNING, "check",
+            QString("%1 of %2 files load on their own")
+                .arg(total - failed->load())
+                .arg(total));
+    });
+}
+
+/** * frames by layout type, nullptr for types this build doesn't know **/
+QFrame* SystemView::makeFrame(QString type) {
+  auto name = type;
+  QFrame* frame = nullptr;
+
+  if (type == "composer")
+    frame = new ComposerFrame(name, mw, devEnv);
+  else if (type == "console")
+    frame = new ConsoleFrame(name, mw);
+  else if (type == "diagnostics")
+    frame = new DiagnosticsFrame(name, mw);
+  else if (type == "macros")
+    frame = new ExpanderFrame(name, mw, devEnv);
+  else if (type == "inspector")
+    frame = new InspectorFrame(name, mw, devEnv);
+  else if (type == "profiler")
+    frame = new ProfilerFrame(name, mw);
+  else if (type == "sessions")
+    frame = new SessionsFrame(name, mw);
+  else if (type == "shell")
+    frame = new ShellFrame(name, mw);
+  else if (type == "tests")
+    frame = new TestRunnerFrame(name, mw);
+  else if (type == "scratch")
+    frame = new ScratchpadFrame(name, mw);
+  else if (type == "search")
+    frame = new SearchFrame(name, mw);
+
+  if (auto search = qobject_cast<SearchFrame*>(frame))
+    connect(search, &SearchFrame::openFile, this, &SystemView::openFile);
+  if (auto composer = qobject_cast<ComposerFrame*>(frame)) {
+    connect(composer, &ComposerFrame::openFile, this, &SystemView::openFile);
+    connect(composer, &ComposerFrame::expandForm, this,
+            &SystemView::expandForm);
+  }
+
+  if (frame != nullptr) LayoutStore::setFrameType(frame, type);
+  return frame;
+}
+
+/** * a closed frame of the type comes back as it was left **/
+void SystemView::addFrame(QString type) {
+  auto frame = rootTile->recycled(type);
+
+  rootTile->split(frame == nullptr ? makeFrame(type) : frame);
+}
+
+void SystemView::openFile(QString path, int line) {
+  auto composer = static_cast<ComposerFrame*>(makeFrame("composer"));
+
+  if (!composer->loadFile(path)) log(";;; can't open " + path);
+  rootTile->split(composer);
+
+  if (line > 0) composer->gotoLine(line);
+}
+
+void SystemView::expandForm(QString form) {
+  if (expander.isNull() || !expander->isVisible()) {
+    auto frame = rootTile->recycled("macros");
+
+    expander = static_cast<ExpanderFrame*>(
+        frame == nullptr ? makeFrame("macros") : frame);
+    rootTile->split(expander);
+  }
+
+  expander->setForm(form);
+}
+
 QToolButton* SystemView::toolMenu() {
   auto tb = new QToolButton(toolBar);
   tb->setToolButtonStyle(Qt::ToolButtonTextOnly);
@@ -41,79 +162,49 @@ QToolButton* SystemView::toolMenu() {
   auto tm = new QMenu(tb);
   tb->setMenu(tm);
 
-  tm->addAction(tr("&composer"), [this]() {
-    if (init)
-      rootTile->rebase(new ComposerFrame("rebase-composer", mw, devEnv));
-    else
-      rootTile->split(new ComposerFrame("split-composer", mw, devEnv));
-    init = false;
-    vsplitAction->setEnabled(true);
-    hsplitAction->setEnabled(true);
-  });
-
-  tm->addAction(tr("&console"), [this]() {
-    if (init)
-      rootTile->rebase(new ConsoleFrame("rebase-console", mw));
-    else
-      rootTile->split(new ConsoleFrame("split-console", mw));
-    init = false;
-    vsplitAction->setEnabled(true);
-    hsplitAction->setEnabled(true);
-  });
-
-  tm->addAction(tr("&inspector"), [this]() {
-    if (init)
-      rootTile->rebase(new InspectorFrame("rebase-inspector", mw, devEnv));
-    else
-      rootTile->split(new InspectorFrame("split-inspector", mw, devEnv));
-    init = false;
-    vsplitAction->setEnabled(true);
-    hsplitAction->setEnabled(true);
-  });
-
-  tm->addAction(tr("&shell"), [this]() {
-    if (init)
-      rootTile->rebase(new ScratchpadFrame("rebase-shell", mw));
-    else
-      rootTile->split(new ScratchpadFrame("split-shell", mw));
-    init = false;
-    vsplitAction->setEnabled(true);
-    hsplitAction->setEnabled(true);
-  });
-
-  tm->addAction(tr("&scratch"), [this]() {
-    if (init)
-      rootTile->rebase(new ScratchpadFrame("rebase-scratch", mw));
-    else
-      rootTile->split(new ScratchpadFrame("split-scratch", mw));
-    init = false;
-    vsplitAction->setEnabled(true);
-    hsplitAction->setEnabled(true);
-  });
+  tm->addAction(tr("&composer"), [this]() { addFrame("composer"); });
+  tm->addAction(tr("&console"), [this]() { addFrame("console"); });
+  tm->addAction(tr("&diagnostics"), [this]() { addFrame("diagnostics"); });
+  tm->addAction(tr("&inspector"), [this]() { addFrame("inspector"); });
+  tm->addAction(tr("&macros"), [this]() { addFrame("macros"); });
+  tm->addAction(tr("check &load"), [this]() { checkLoad(); });
+  tm->addAction(tr("&profiler"), [this]() { addFrame("profiler"); });
+  tm->addAction(tr("sea&rch"), [this]() { addFrame("search"); });
+  tm->addAction(tr("s&essions"), [this]() { addFrame("sessions"); });
+  tm->addAction(tr("&shell"), [this]() { addFrame("shell"); });
+  tm->addAction(tr("&tests"), [this]() { addFrame("tests"); });
+  tm->addAction(tr("&scratch"), [this]() { addFrame("scratch"); });
+
   return tb;
 }
 
 SystemView::SystemView(QString nm, MainWindow* tb, GyreEnv* dev)
-    : mw(tb), devEnv(dev), name(nm) {
-  init = true;
-
+    : mw(tb), devEnv(dev), pool(nullptr), name(nm) {
   toolBar = new QToolBar();
 
   vsplitAction = toolBar->addAction(tr("vsplit"));
-  vsplitAction->setEnabled(false);
 
   connect(vsplitAction, &QAction::triggered, this,
           [this]() { rootTile->splitv(); });
 
   hsplitAction = toolBar->addAction(tr("hsplit"));
-  hsplitAction->setEnabled(false);
 
   connect(hsplitAction, &QAction::triggered, this,
           [this]() { rootTile->splith(); });
 
+  connect(toolBar->addAction(tr("close")), &QAction::triggered, this,
+          [this]() { rootTile->close(); });
+
   toolBar->addWidget(toolMenu());
 
-  rootTile = new Tile(tb, new QFrame());
+  /* the last session's layout, frames realized as they're shown */
+  auto store = LayoutStore::instance();
+  auto state = store->load();
+
+  rootTile = Tile::restore(tb, state,
+                           [this](QString type) { return makeFrame(type); });
+
+  store->setSource([this]() { return rootTile->saveState(); });
 
   layout = new QVBoxLayout();
   layout->setContentsMargins(5, 5, 5, 5);
@@ -123,4 +214,12 @@ SystemView::SystemView(QString nm, MainWindow* tb, GyreEnv* dev)
   setLayout(layout);
 }
 
+SystemView::~SystemView() {
+  if (pool == nullptr) return;
+
+  /* checks still queued are dropped, the running ones finish first */
+  pool->cancel();
+  delete pool;
+}
+
 } /* namespace gyreui */
@@ -16,10 +16,12 @@
 
 #include <QFrame>
 #include <QLabel>
+#include <QPointer>
 #include <QTextEdit>
 #include <QToolBar>
 #include <QWidget>
 
+#include "EnvPool.h"
 #include "GyreEnv.h"
 #include "MainWindow.h"
 #include "Tile.h"
@@ -34,6 +36,7 @@ QT_END_NAMESPACE
 
 namespace gyreui {
 
+class ExpanderFrame;
 class MainWindow;
 class Tile;
 
@@ -42,6 +45,13 @@ class SystemView : public QFrame {
 
  public:
   explicit SystemView(QString, MainWindow*, GyreEnv*);
+  ~SystemView();
+
+  /** * in a new composer pane, at line when there is one **/
+  void openFile(QString, int = 0);
+
+  /** * in the macroexpansion browser, opened if it isn't showing **/
+  void expandForm(QString);
 
  private:
   void showEvent(QShowEvent* event) {
@@ -50,12 +60,16 @@ class SystemView : public QFrame {
   }
 
   void log(QString);
+  void checkLoad();
+
+  QFrame* makeFrame(QString);
+  void addFrame(QString);
 
   QToolButton* toolMenu();
 
   MainWindow* mw;
-  bool init;
   GyreEnv* devEnv;
+  EnvPool* pool;
   QString name;
   QLayout* layout;
   QToolBar* toolBar;
@@ -63,6 +77,7 @@ class SystemView : public QFrame {
   QAction* hsplitAction;
   QMenu* tm;
   Tile* rootTile;
+  QPointer<ExpanderFrame> expander;
 };
 
 } /* namespace gyreui */
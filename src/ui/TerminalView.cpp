@@ -0,0 +1,281 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  TerminalView.cpp: TerminalView implementation
+ **
+ **/
+#include "TerminalView.h"
+
+#include <utility>
+
+#include <QClipboard>
+#include <QFontDatabase>
+#include <QGuiApplication>
+#include <QPaintEvent>
+#include <QResizeEvent>
+#include <QScrollBar>
+#include <QVector>
+
+namespace gyreui {
+
+/** * output **/
+void TerminalView::feed(const QByteArray& bytes) {
+  parser_.feed(bytes);
+
+  auto replies = screen_.takeReplies();
+  if (!replies.isEmpty()) emit input(replies);
+
+  if (!frameTimer_->isActive()) frameTimer_->start();
+}
+
+/** * turn a frame's worth of damage into repaint requests **/
+void TerminalView::flush() {
+  auto damage = screen_.takeDamage();
+  auto scrollBar = verticalScrollBar();
+  auto follow = scrollBar->value() == scrollBar->maximum();
+
+  if (screen_.title() != title_) {
+    title_ = screen_.title();
+    emit titleChanged(title_);
+  }
+
+  /* the whole screen moved, there's no saving rows */
+  if (screen_.takeScrolled() != 0) {
+    scrollBar->setRange(0, screen_.scrollbackSize());
+    if (follow) scrollBar->setValue(scrollBar->maximum());
+    viewport()->update();
+    return;
+  }
+
+  auto offset = screen_.scrollbackSize() - scrollBar->value();
+  for (int row = 0; row < damage.size(); ++row)
+    if (damage.testBit(row))
+      viewport()->update(QRect(0, PAD + (offset + row) * cellHeight_,
+                               viewport()->width(), cellHeight_));
+}
+
+void TerminalView::DrawRun(QPainter& painter, int column, int y,
+                           const QString& text, const CellAttr& attr) {
+  auto bg = palette().color(QPalette::Base);
+  auto ink = attr.foreground(palette().color(QPalette::Text));
+  auto paper = attr.background(bg);
+
+  if (attr.flags & CellAttr::INVERSE) std::swap(ink, paper);
+
+  auto x = PAD + column * cellWidth_;
+  auto width = text.toUcs4().size() * cellWidth_;
+
+  if (paper != bg) painter.fillRect(x, y, width, cellHeight_, paper);
+
+  auto face = font();
+  face.setBold(attr.flags & CellAttr::BOLD);
+  face.setItalic(attr.flags & CellAttr::ITALIC);
+  face.setUnderline(attr.flags & CellAttr::UNDERLINE);
+
+  painter.setFont(face);
+  painter.setPen(ink);
+  painter.drawText(QRect(x, y, width, cellHeight_), Qt::AlignLeft, text);
+}
+
+/** * scrollback and screen rows draw the same text and runs **/
+void TerminalView::DrawRow(QPainter& painter, const QString& text,
+                           const QVector<AttrRun>& runs, int y) {
+  auto column = 0;
+
+  for (int n = -1; n < runs.size(); ++n) {
+    auto start = n < 0 ? 0 : runs[n].start;
+    auto end = n + 1 < runs.size() ? runs[n + 1].start : text.size();
+
+    if (end <= start) continue;
+
+    auto run = text.mid(start, end - start);
+    DrawRun(painter, column, y, run,
+            screen_.attribute(n < 0 ? Scrollback::PLAIN : runs[n].attr));
+    column += run.toUcs4().size();
+  }
+}
+
+void TerminalView::paintEvent(QPaintEvent* event) {
+  QPainter painter(viewport());
+  painter.fillRect(event->rect(), palette().color(QPalette::Base));
+
+  auto top = verticalScrollBar()->value();
+  auto scrollback = screen_.scrollbackSize();
+
+  for (int line = 0;; ++line) {
+    auto index = top + line;
+    auto y = PAD + line * cellHeight_;
+
+    if (y >= viewport()->height() || index >= scrollback + screen_.rows())
+      break;
+    if (y + cellHeight_ <= event->rect().top() || y > event->rect().bottom())
+      continue;
+
+    if (index < scrollback) {
+      DrawRow(painter, screen_.scrollback().text(index),
+              screen_.scrollback().runs(index), y);
+    } else {
+      auto& row = screen_.row(index - scrollback);
+      QString text;
+      QVector<AttrRun> runs;
+
+      screen_.scrollback().decode(row.constData(), row.size(), text, runs);
+      DrawRow(painter, text, runs, y);
+    }
+  }
+
+  /* a solid block with focus, an outline without */
+  if (screen_.cursorVisible()) {
+    QRect cursor(PAD + screen_.cursorColumn() * cellWidth_,
+                 PAD + (scrollback + screen_.cursorRow() - top) * cellHeight_,
+                 cellWidth_, cellHeight_);
+
+    if (hasFocus())
+      painter.fillRect(cursor, QColor(0, 0, 0, 128));
+    else
+      painter.drawRect(cursor.adjusted(0, 0, -1, -1));
+  }
+}
+
+void TerminalView::resizeEvent(QResizeEvent* event) {
+  QAbstractScrollArea::resizeEvent(event);
+
+  auto cols = qMax(1, (viewport()->width() - 2 * PAD) / cellWidth_);
+  auto rows = qMax(1, (viewport()->height() - 2 * PAD) / cellHeight_);
+
+  if (cols == screen_.columns() && rows == screen_.rows()) return;
+
+  screen_.resize(cols, rows);
+  verticalScrollBar()->setPageStep(rows);
+  verticalScrollBar()->setRange(0, screen_.scrollbackSize());
+  verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+
+  emit sizeChanged(cols, rows);
+  viewport()->update();
+}
+
+/** * input **/
+void TerminalView::send(const QByteArray& bytes) {
+  verticalScrollBar()->setValue(verticalScrollBar()->maximum());
+  emit input(bytes);
+}
+
+void TerminalView::paste(QString text) {
+  auto bytes = text.replace("\r\n", "\r").replace('\n', '\r').toUtf8();
+
+  if (screen_.bracketedPaste()) bytes = "\x1b[200~" + bytes + "\x1b[201~";
+  send(bytes);
+}
+
+/** * xterm key encodings **/
+QByteArray TerminalView::keyBytes(QKeyEvent* event) {
+  static const char* function[] = {"\x1bOP",   "\x1bOQ",   "\x1bOR",
+                                   "\x1bOS",   "\x1b[15~", "\x1b[17~",
+                                   "\x1b[18~", "\x1b[19~", "\x1b[20~",
+                                   "\x1b[21~", "\x1b[23~", "\x1b[24~"};
+
+  auto app = screen_.appCursorKeys();
+  auto key = event->key();
+
+  switch (key) {
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+      return "\r";
+    case Qt::Key_Backspace:
+      return "\x7f";
+    case Qt::Key_Tab:
+      return "\t";
+    case Qt::Key_Backtab:
+      return "\x1b[Z";
+    case Qt::Key_Escape:
+      return "\x1b";
+    case Qt::Key_Up:
+      return app ? "\x1bOA" : "\x1b[A";
+    case Qt::Key_Down:
+      return app ? "\x1bOB" : "\x1b[B";
+    case Qt::Key_Right:
+      return app ? "\x1bOC" : "\x1b[C";
+    case Qt::Key_Left:
+      return app ? "\x1bOD" : "\x1b[D";
+    case Qt::Key_Home:
+      return app ? "\x1bOH" : "\x1b[H";
+    case Qt::Key_End:
+      return app ? "\x1bOF" : "\x1b[F";
+    case Qt::Key_Insert:
+      return "\x1b[2~";
+    case Qt::Key_Delete:
+      return "\x1b[3~";
+    case Qt::Key_PageUp:
+      return "\x1b[5~";
+    case Qt::Key_PageDown:
+      return "\x1b[6~";
+    default:
+      break;
+  }
+
+  if (key >= Qt::Key_F1 && key <= Qt::Key_F12)
+    return function[key - Qt::Key_F1];
+
+  if (event->modifiers() & Qt::ControlModifier && key >= Qt::Key_A &&
+      key <= Qt::Key_Z)
+    return QByteArray(1, static_cast<char>(key - Qt::Key_A + 1));
+
+  auto bytes = event->text().toUtf8();
+  if (!bytes.isEmpty() && event->modifiers() & Qt::AltModifier)
+    bytes.prepend('\x1b');
+
+  return bytes;
+}
+
+void TerminalView::keyPressEvent(QKeyEvent* event) {
+  auto scrollBar = verticalScrollBar();
+  auto shift = event->modifiers() & Qt::ShiftModifier;
+
+  /* shift pages the scrollback, the program never sees it */
+  if (shift && event->key() == Qt::Key_PageUp) {
+    scrollBar->setValue(scrollBar->value() - scrollBar->pageStep());
+    return;
+  }
+  if (shift && event->key() == Qt::Key_PageDown) {
+    scrollBar->setValue(scrollBar->value() + scrollBar->pageStep());
+    return;
+  }
+
+  if (shift && event->modifiers() & Qt::ControlModifier &&
+      event->key() == Qt::Key_V) {
+    paste(QGuiApplication::clipboard()->text());
+    return;
+  }
+
+  auto bytes = keyBytes(event);
+  if (!bytes.isEmpty()) send(bytes);
+}
+
+/** * constructor **/
+TerminalView::TerminalView(QWidget* parent)
+    : QAbstractScrollArea(parent), screen_(80, 24), parser_(&screen_) {
+  setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+  setFocusPolicy(Qt::StrongFocus);
+  viewport()->setCursor(Qt::IBeamCursor);
+
+  QFontMetrics m(font());
+  cellWidth_ = qMax(1, m.horizontalAdvance('M'));
+  cellHeight_ = qMax(1, m.height());
+
+  verticalScrollBar()->setSingleStep(1);
+  verticalScrollBar()->setRange(0, 0);
+
+  frameTimer_ = new QTimer(this);
+  frameTimer_->setSingleShot(true);
+  frameTimer_->setInterval(FRAME_MSECS);
+  connect(frameTimer_, &QTimer::timeout, this, &TerminalView::flush);
+}
+
+}  // namespace gyreui
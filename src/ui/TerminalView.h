@@ -0,0 +1,74 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  TerminalView.h: TerminalView class
+ **
+ **/
+#ifndef GYREUI_UI_TERMINALVIEW_H_
+#define GYREUI_UI_TERMINALVIEW_H_
+
+#include <QAbstractScrollArea>
+#include <QByteArray>
+#include <QKeyEvent>
+#include <QPainter>
+#include <QTimer>
+
+#include "Screen.h"
+#include "VtParser.h"
+
+class QPaintEvent;
+class QResizeEvent;
+
+namespace gyreui {
+
+/** * renders a Screen, repainting only damaged rows at most once a frame **/
+class TerminalView : public QAbstractScrollArea {
+  Q_OBJECT
+
+ public:
+  static const int PAD = 5;
+  static const int FRAME_MSECS = 16;
+
+  explicit TerminalView(QWidget*);
+
+  void feed(const QByteArray&);
+  void paste(QString);
+
+  Screen* screen() { return &screen_; }
+
+ signals:
+  void input(QByteArray);
+  void sizeChanged(int, int);
+  void titleChanged(QString);
+
+ protected:
+  void paintEvent(QPaintEvent* event) override;
+  void resizeEvent(QResizeEvent* event) override;
+  void keyPressEvent(QKeyEvent* event) override;
+  bool focusNextPrevChild(bool) override { return false; }
+
+ private:
+  void flush();
+  void send(const QByteArray&);
+  void DrawRun(QPainter&, int, int, const QString&, const CellAttr&);
+  void DrawRow(QPainter&, const QString&, const QVector<AttrRun>&, int);
+  QByteArray keyBytes(QKeyEvent*);
+
+  int cellWidth_;
+  int cellHeight_;
+  QString title_;
+  Screen screen_;
+  VtParser parser_;
+  QTimer* frameTimer_;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_TERMINALVIEW_H_ */
@@ -0,0 +1,296 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  TestRunnerFrame.cpp: TestRunnerFrame implementation
+ **
+ **  a test is a top-level (:defcon test-name (:lambda () ...)) form, it
+ **  passes if calling it neither raises an exception nor returns :nil.
+ **
+ **/
+#include <algorithm>
+
+#include <QElapsedTimer>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QLabel>
+#include <QListView>
+#include <QRegularExpression>
+#include <QSplitter>
+#include <QString>
+#include <QTextEdit>
+#include <QToolBar>
+#include <QtWidgets>
+
+#include "EnvPool.h"
+#include "FormReader.h"
+#include "TestRunnerFrame.h"
+
+namespace gyreui {
+
+namespace {
+
+/* set per worker thread, true if ~/.gyre-ui's ide-printex is loaded */
+thread_local bool decodes = false;
+
+QString elapsed(qint64 ns) {
+  if (ns < 1000000) return QString("%1us").arg(ns / 1000.0, 0, 'f', 1);
+
+  return QString("%1ms").arg(ns / 1000000.0, 0, 'f', 1);
+}
+
+} /* anonymous namespace */
+
+/** * model **/
+QVariant TestResultModel::data(const QModelIndex& index, int role) const {
+  if (!index.isValid() || index.row() >= tests.size()) return QVariant();
+
+  auto& test = tests[index.row()];
+
+  switch (role) {
+    case Qt::DisplayRole: {
+      static const char* label[] = {"....", "pass", "FAIL"};
+
+      return QString("%1  %2  %3  %4")
+          .arg(label[test.status])
+          .arg(test.status == PENDING ? QString() : elapsed(test.ns), 9)
+          .arg(test.name, QFileInfo(test.file).fileName());
+    }
+    case Qt::ForegroundRole:
+      return test.status == FAILED ? QColor(Qt::red) : QColor(Qt::black);
+    default:
+      return QVariant();
+  }
+}
+
+void TestResultModel::clear() {
+  beginResetModel();
+  tests.clear();
+  endResetModel();
+}
+
+void TestResultModel::add(QString file, QString name) {
+  beginInsertRows(QModelIndex(), tests.size(), tests.size());
+  tests.push_back({file, name, PENDING, 0, QString()});
+  endInsertRows();
+}
+
+void TestResultModel::finish(int row, STATUS status, qint64 ns,
+                             QString detail) {
+  auto& test = tests[row];
+
+  test.status = status;
+  test.ns = ns;
+  test.detail = detail;
+
+  emit dataChanged(index(row), index(row));
+}
+
+void TestResultModel::resetStatus() {
+  beginResetModel();
+  for (auto& test : tests) {
+    test.status = PENDING;
+    test.ns = 0;
+    test.detail.clear();
+  }
+  endResetModel();
+}
+
+void TestResultModel::sortBySlowest() {
+  beginResetModel();
+  std::stable_sort(tests.begin(), tests.end(),
+                   [](const Test& a, const Test& b) { return a.ns > b.ns; });
+  endResetModel();
+}
+
+int TestResultModel::count(STATUS status) const {
+  return std::count_if(tests.begin(), tests.end(), [status](const Test& test) {
+    return test.status == status;
+  });
+}
+
+/** * frame **/
+void TestRunnerFrame::summary() {
+  summaryLabel->setText(
+      QString("%1 tests, %2 passed, %3 failed%4")
+          .arg(model->rowCount())
+          .arg(model->count(TestResultModel::PASSED))
+          .arg(model->count(TestResultModel::FAILED))
+          .arg(running > 0 ? QString(", %1 running").arg(running) : ""));
+}
+
+void TestRunnerFrame::clear() {
+  if (running > 0) return;
+
+  files.clear();
+  model->clear();
+  detailText->clear();
+  summary();
+}
+
+/** * discover test forms without evaluating the files **/
+void TestRunnerFrame::load() {
+  static const QRegularExpression testForm(
+      "^\\(\\s*:defcon\\s+(test-[^\\s()]+)");
+
+  if (running > 0) return;
+
+  auto paths = QFileDialog::getOpenFileNames(
+      this, tr("Load Tests"), mw->userInfo()->userdir(), tr("File (*)"));
+
+  for (auto& path : paths) {
+    QFile f(path);
+    if (!f.open(QFile::ReadOnly | QFile::Text)) continue;
+
+    QTextStream in(&f);
+    for (auto& form : FormReader::forms(in.readAll())) {
+      auto match = testForm.match(form.text);
+      if (match.hasMatch()) model->add(path, match.captured(1));
+    }
+
+    files << path;
+  }
+
+  summary();
+}
+
+void TestRunnerFrame::finished(int row, int status, qint64 ns,
+                               QString detail) {
+  model->finish(row, static_cast<TestResultModel::STATUS>(status), ns, detail);
+  running--;
+
+  if (running == 0) {
+    auto failed = model->count(TestResultModel::FAILED);
+    log(QString(";;; %1 tests run, %2 failed")
+            .arg(model->rowCount())
+            .arg(failed));
+  }
+
+  summary();
+}
+
+/** * every test is an independent job, files load once per worker env **/
+void TestRunnerFrame::run() {
+  if (running > 0 || model->rowCount() == 0) return;
+
+  setContextStatus(tr("test"));
+
+  /* fresh envs for every run so runs don't leak state into each other */
+  if (pool != nullptr) pool->cancel();
+  delete pool;
+  pool = new EnvPool();
+
+  model->resetStatus();
+  detailText->clear();
+  running = model->rowCount();
+
+  for (int row = 0; row < model->rowCount(); ++row) {
+    auto file = model->test(row).file;
+    auto test = model->test(row).name;
+
+    pool->submit([this, row, file, test](GyreEnv* env) {
+      EnvPool::once(env, "ide-printex", [](GyreEnv* worker) {
+        decodes = worker->withException([worker]() {
+                    (void)worker->rep("ide-printex");
+                  }).size() <= 1;
+      });
+
+      EnvPool::once(env, file, [file](GyreEnv* worker) {
+        worker->withException(
+            [worker, file]() { (void)worker->rep(GyreEnv::loadForm(file)); });
+      });
+
+      auto form = decodes ? "(with-exception (:lambda () (" + test +
+                                ")) ide-printex)"
+                          : "(" + test + ")";
+      QString out;
+      QElapsedTimer timer;
+
+      timer.start();
+      auto error =
+          env->withException([env, form, &out]() { out = env->rep(form); });
+      auto ns = timer.nsecsElapsed();
+
+      auto failed = error.size() > 1 || out.contains("with-ide exception") ||
+                    out.trimmed().endsWith(":nil");
+
+      QMetaObject::invokeMethod(
+          this,
+          [this, row, failed, ns, out, error]() {
+            finished(row,
+                     failed ? TestResultModel::FAILED : TestResultModel::PASSED,
+                     ns, out + error);
+          },
+          Qt::QueuedConnection);
+    });
+  }
+
+  summary();
+}
+
+void TestRunnerFrame::sort() {
+  if (running > 0) return;
+
+  model->sortBySlowest();
+}
+
+void TestRunnerFrame::select(const QModelIndex& index) {
+  if (!index.isValid()) return;
+
+  auto& test = model->test(index.row());
+  detailText->setPlainText(test.file + "\n" + test.name + "\n\n" + test.detail);
+}
+
+TestRunnerFrame::TestRunnerFrame(QString name, MainWindow* tb)
+    : mw(tb), name(name), pool(nullptr), running(0) {
+  toolBar = new QToolBar();
+  connect(toolBar->addAction(tr("clear")), &QAction::triggered, this,
+          &TestRunnerFrame::clear);
+  connect(toolBar->addAction(tr("load")), &QAction::triggered, this,
+          &TestRunnerFrame::load);
+  connect(toolBar->addAction(tr("run")), &QAction::triggered, this,
+          &TestRunnerFrame::run);
+  connect(toolBar->addAction(tr("slowest")), &QAction::triggered, this,
+          &TestRunnerFrame::sort);
+
+  model = new TestResultModel(this);
+
+  resultView = new QListView();
+  resultView->setModel(model);
+  resultView->setUniformItemSizes(true);
+  resultView->setLayoutMode(QListView::Batched);
+  resultView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+  connect(resultView, &QListView::clicked, this, &TestRunnerFrame::select);
+
+  detailText = new QTextEdit();
+  detailText->setReadOnly(true);
+
+  summaryLabel = new QLabel();
+
+  auto vs = new QSplitter(Qt::Vertical, this);
+  vs->addWidget(resultView);
+  vs->addWidget(detailText);
+
+  auto layout = new QVBoxLayout;
+  layout->setContentsMargins(5, 5, 5, 5);
+  layout->addWidget(toolBar);
+  layout->addWidget(vs);
+  layout->addWidget(summaryLabel);
+
+  setLayout(layout);
+  summary();
+}
+
+/** * only the tests already running hold up the close **/
+TestRunnerFrame::~TestRunnerFrame() {
+  if (pool != nullptr) pool->cancel();
+  delete pool;
+}
+
+}  // namespace gyreui
@@ -0,0 +1,117 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  TestRunnerFrame.h: TestRunnerFrame class
+ **
+ **/
+#ifndef GYREUI_UI_TESTRUNNERFRAME_H_
+#define GYREUI_UI_TESTRUNNERFRAME_H_
+
+#include <QAbstractListModel>
+#include <QFrame>
+#include <QLabel>
+#include <QListView>
+#include <QTextEdit>
+#include <QToolBar>
+#include <QVector>
+#include <QWidget>
+
+#include "EnvPool.h"
+#include "MainWindow.h"
+
+QT_BEGIN_NAMESPACE
+class QLabel;
+class QListView;
+class QTextEdit;
+class QToolBar;
+class QVBoxLayout;
+class QWidget;
+QT_END_NAMESPACE
+
+namespace gyreui {
+
+class MainWindow;
+
+/** * one row per discovered test **/
+class TestResultModel : public QAbstractListModel {
+  Q_OBJECT
+
+ public:
+  enum STATUS { PENDING, PASSED, FAILED };
+
+  struct Test {
+    QString file;
+    QString name;
+    STATUS status;
+    qint64 ns;
+    QString detail;
+  };
+
+  int rowCount(const QModelIndex& = QModelIndex()) const override {
+    return tests.size();
+  }
+
+  QVariant data(const QModelIndex&, int) const override;
+
+  void clear();
+  void add(QString, QString);
+  void finish(int, STATUS, qint64, QString);
+  void sortBySlowest();
+  void resetStatus();
+
+  const Test& test(int row) const { return tests[row]; }
+  int count(STATUS) const;
+
+  explicit TestResultModel(QObject* parent) : QAbstractListModel(parent) {}
+
+ private:
+  QVector<Test> tests;
+};
+
+class TestRunnerFrame : public QFrame {
+  Q_OBJECT
+
+ public:
+  explicit TestRunnerFrame(QString, MainWindow*);
+  ~TestRunnerFrame();
+
+ private:
+  void clear();
+  void load();
+  void run();
+  void sort();
+  void select(const QModelIndex&);
+  void finished(int, int, qint64, QString);
+  void summary();
+
+  void log(QString msg) { mw->log(msg); }
+
+  void setContextStatus(QString str) { mw->setContextStatus(str); }
+
+  void showEvent(QShowEvent* event) override {
+    QWidget::showEvent(event);
+    mw->setContextStatus(name);
+  }
+
+  MainWindow* mw;
+  QString name;
+  EnvPool* pool;
+  int running;
+  QStringList files;
+  TestResultModel* model;
+  QListView* resultView;
+  QTextEdit* detailText;
+  QLabel* summaryLabel;
+  QToolBar* toolBar;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_TESTRUNNERFRAME_H_ */
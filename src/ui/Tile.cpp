@@ -8,152 +8,327 @@
 
 /********
  **
- **  TileFrame.cpp: TileFrame implementation
+ **  Tile.cpp: Tile implementation
+ **
+ **  the root splitter holds panes and nested splitters of the other
+ **  orientation. splitting, closing and merging only move widgets
+ **  between splitters, so frames keep their widgets and their state.
+ **  closed frames are kept for reuse, the oldest dropped first.
  **
  **/
-#include <QFileDialog>
-#include <QLabel>
+#include <numeric>
+
+#include <QApplication>
+#include <QJsonArray>
 #include <QSplitter>
 #include <QString>
-#include <QTextEdit>
-#include <QToolBar>
 #include <QtWidgets>
 
 #include "Tile.h"
 
 namespace gyreui {
 
-namespace {
+/** * pane **/
+QFrame* Pane::setFrame(QFrame* frame) {
+  auto old = content;
 
-void scrub_layout(QLayout* layout) {
-  QLayoutItem* item;
-  QLayout* sublayout;
-  QWidget* widget;
+  if (old != nullptr) {
+    layout()->removeWidget(old);
+    old->hide();
+    old->setParent(nullptr);
+  }
 
-  while ((item = layout->takeAt(0))) {
-    if ((sublayout = item->layout()) != 0) { /* do the same for sublayout*/
-    } else if ((widget = item->widget()) != 0) {
-      widget->hide();
-      delete widget;
-    } else {
-      delete item;
-    }
+  content = frame;
+  if (content != nullptr) {
+    layout()->addWidget(content);
+    content->show();
   }
 
-  delete layout;
+  return old;
 }
 
-}  // namespace
+Pane::Pane(QFrame* frame) : content(nullptr) {
+  setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
+  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+
+  /* a click selects an empty pane */
+  setFocusPolicy(Qt::ClickFocus);
 
+  auto layout = new QVBoxLayout;
+  layout->setContentsMargins(5, 5, 5, 5);
+  setLayout(layout);
+
+  setFrame(frame);
+}
+
+/** * tile **/
 void Tile::log(QString msg) { mw->log(msg); }
 
-void Tile::split(QFrame* fr) {
-  switch (splitState) {
-    case UNSPLIT:
-      break;
-    case HORIZONTAL:
-      splitTile = new Tile(mw, fr);
-      splith();
-      break;
-    case VERTICAL:
-      splitTile = new Tile(mw, fr);
-      splitv();
-      break;
+QSplitter* Tile::newSplitter(Qt::Orientation orientation) {
+  auto splitter = new QSplitter(orientation);
+
+  splitter->setChildrenCollapsible(false);
+  connect(splitter, &QSplitter::splitterMoved, this,
+          []() { LayoutStore::instance()->changed(); });
+
+  return splitter;
+}
+
+/** * added goes after pane, sharing its space **/
+void Tile::splitPane(Pane* pane, Qt::Orientation orientation, Pane* added) {
+  auto parent = static_cast<QSplitter*>(pane->parentWidget());
+  auto index = parent->indexOf(pane);
+  auto sizes = parent->sizes();
+
+  if (parent->count() == 1) parent->setOrientation(orientation);
+
+  if (parent->orientation() == orientation) {
+    auto half = sizes[index] / 2;
+
+    sizes[index] -= half;
+    sizes.insert(index + 1, half);
+    parent->insertWidget(index + 1, added);
+  } else {
+    auto node = newSplitter(orientation);
+
+    parent->replaceWidget(index, node);
+    node->addWidget(pane);
+    node->addWidget(added);
+    node->setSizes({1, 1});
+    node->show();
   }
+
+  pane->show();
+  added->show();
+  parent->setSizes(sizes);
 }
 
-void Tile::rebase(QFrame* base) {
-  auto size = this->frameSize();
+/** * inner's children take its place in its parent **/
+void Tile::splice(QSplitter* inner) {
+  auto parent = static_cast<QSplitter*>(inner->parentWidget());
+  auto index = parent->indexOf(inner);
+  auto sizes = parent->sizes();
+  auto slot = sizes.takeAt(index);
+  auto innerSizes = inner->sizes();
+  auto total =
+      qMax(1, std::accumulate(innerSizes.begin(), innerSizes.end(), 0));
 
-  baseFrame = base;
-  baseFrame->setMinimumHeight(size.height() / 2);
+  for (int i = 0; i < innerSizes.size(); ++i)
+    sizes.insert(index + i, slot * innerSizes[i] / total);
 
-  QSizePolicy spBase(QSizePolicy::Preferred, QSizePolicy::Preferred);
-  spBase.setVerticalStretch(1);
-  baseFrame->setSizePolicy(spBase);
+  while (inner->count() > 0) {
+    auto widget = inner->widget(0);
 
-  auto layout = new QVBoxLayout();
-  layout->setContentsMargins(5, 5, 5, 5);
-  layout->addWidget(baseFrame);
-  layout->setSizeConstraint(QLayout::SetMinimumSize);
+    parent->insertWidget(index++, widget);
+    widget->show();
+  }
 
-  scrub_layout(this->layout());
-  setLayout(layout);
+  delete inner;
+  parent->setSizes(sizes);
+}
 
-  setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
-  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+/** * a splitter left with one child gives way to it **/
+void Tile::merge(QSplitter* splitter) {
+  if (splitter->count() != 1) return;
+
+  auto child = qobject_cast<QSplitter*>(splitter->widget(0));
+
+  if (splitter == root) {
+    if (child != nullptr) {
+      root->setOrientation(child->orientation());
+      splice(child);
+    }
+    return;
+  }
+
+  auto parent = static_cast<QSplitter*>(splitter->parentWidget());
+  auto sizes = parent->sizes();
+  auto widget = splitter->widget(0);
+
+  parent->replaceWidget(parent->indexOf(splitter), widget);
+  widget->show();
+  delete splitter;
+  parent->setSizes(sizes);
+
+  if (child != nullptr && child->orientation() == parent->orientation())
+    splice(child);
 }
 
-void Tile::splitv() {
-  auto size = this->frameSize();
+void Tile::recycle(QFrame* frame) {
+  if (frame == nullptr) return;
+
+  recycleList.prepend(frame);
+  while (recycleList.size() > RECYCLE_MAX) delete recycleList.takeLast();
+}
 
-  splitState = VERTICAL;
+QFrame* Tile::recycled(QString type) {
+  for (int i = 0; i < recycleList.size(); ++i)
+    if (LayoutStore::frameType(recycleList[i]) == type)
+      return recycleList.takeAt(i);
 
-  auto panel = (splitTile == nullptr) ? new QFrame() : splitTile;
-  panel->setMinimumHeight(size.height() / 2);
+  return nullptr;
+}
 
-  QSizePolicy spPanel(QSizePolicy::Preferred, QSizePolicy::Preferred);
-  spPanel.setVerticalStretch(1);
-  panel->setSizePolicy(spPanel);
+void Tile::setCurrent(Pane* pane) {
+  if (current != nullptr) current->setLineWidth(1);
 
-  auto vs = new QSplitter(Qt::Vertical, this);
-  vs->addWidget(baseFrame);
-  vs->addWidget(panel);
-  vs->setStretchFactor(1, 1);
+  current = pane;
+  current->setLineWidth(2);
+}
 
-  auto layout = new QVBoxLayout();
-  layout->setContentsMargins(5, 5, 5, 5);
-  layout->addWidget(vs);
-  layout->setSizeConstraint(QLayout::SetMinimumSize);
+/** * the pane holding focus is the one the toolbar acts on **/
+void Tile::focusChanged(QWidget*, QWidget* now) {
+  for (auto widget = now; widget != nullptr; widget = widget->parentWidget())
+    if (auto pane = qobject_cast<Pane*>(widget)) {
+      if (isAncestorOf(pane)) setCurrent(pane);
+      return;
+    }
+}
 
-  scrub_layout(this->layout());
-  setLayout(layout);
-  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+/** * frame replaces the current pane's, which is kept for reuse **/
+void Tile::rebase(QFrame* frame) {
+  recycle(current->setFrame(frame));
+  LayoutStore::instance()->changed();
+}
+
+/** * an empty current pane takes the frame, otherwise it gets its own **/
+void Tile::split(QFrame* frame) {
+  if (current->frame() == nullptr) {
+    current->setFrame(frame);
+  } else {
+    auto pane = new Pane(frame);
+
+    splitPane(current, orientation, pane);
+    setCurrent(pane);
+  }
+
+  LayoutStore::instance()->changed();
 }
 
 void Tile::splith() {
-  auto size = this->frameSize();
+  auto pane = new Pane(nullptr);
 
-  splitState = HORIZONTAL;
+  orientation = Qt::Horizontal;
+  splitPane(current, orientation, pane);
+  setCurrent(pane);
+  LayoutStore::instance()->changed();
+}
 
-  auto panel = (splitTile == nullptr) ? new QFrame() : splitTile;
-  panel->setMinimumWidth(size.width() / 2);
+void Tile::splitv() {
+  auto pane = new Pane(nullptr);
 
-  QSizePolicy spPanel(QSizePolicy::Preferred, QSizePolicy::Preferred);
-  spPanel.setHorizontalStretch(1);
-  panel->setSizePolicy(spPanel);
+  orientation = Qt::Vertical;
+  splitPane(current, orientation, pane);
+  setCurrent(pane);
+  LayoutStore::instance()->changed();
+}
 
-  auto hs = new QSplitter(Qt::Horizontal, this);
-  hs->addWidget(baseFrame);
-  hs->addWidget(panel);
-  hs->setStretchFactor(1, 1);
+/** * the last pane is emptied rather than closed **/
+void Tile::close() {
+  auto pane = current;
+  auto parent = static_cast<QSplitter*>(pane->parentWidget());
 
-  auto layout = new QVBoxLayout();
-  layout->setContentsMargins(5, 5, 5, 5);
-  layout->addWidget(hs);
-  layout->setSizeConstraint(QLayout::SetMinimumSize);
+  recycle(pane->setFrame(nullptr));
 
-  scrub_layout(this->layout());
-  setLayout(layout);
-  setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+  if (parent != root || root->count() > 1) {
+    current = nullptr;
+    delete pane;
+    merge(parent);
+    setCurrent(root->findChild<Pane*>());
+  }
+
+  LayoutStore::instance()->changed();
+}
+
+/** * splitters with their children and sizes, panes with their frame **/
+QJsonObject Tile::saveNode(QWidget* widget) const {
+  if (auto splitter = qobject_cast<QSplitter*>(widget)) {
+    QJsonArray tiles;
+    QJsonArray sizes;
+
+    for (int i = 0; i < splitter->count(); ++i)
+      tiles << saveNode(splitter->widget(i));
+    for (auto size : splitter->sizes()) sizes << size;
+
+    return QJsonObject{
+        {"split", splitter->orientation() == Qt::Horizontal ? "horizontal"
+                                                            : "vertical"},
+        {"tiles", tiles},
+        {"sizes", sizes}};
+  }
+
+  auto frame = static_cast<Pane*>(widget)->frame();
+  return QJsonObject{{"frame", frame == nullptr
+                                   ? QJsonObject()
+                                   : LayoutStore::frameState(frame)}};
 }
 
-Tile::Tile(MainWindow* tb, QFrame* cf) : mw(tb), baseFrame(cf) {
-  splitState = UNSPLIT;
-  splitTile = nullptr;
+QJsonObject Tile::saveState() const { return saveNode(root); }
 
-  baseFrame->setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
+QWidget* Tile::restoreNode(const QJsonObject& state,
+                           const PendingFrame::Factory& factory) {
+  if (!state.contains("tiles"))
+    return new Pane(
+        LayoutStore::restoreFrame(state["frame"].toObject(), factory));
 
-  QSizePolicy spBase(QSizePolicy::Preferred, QSizePolicy::Preferred);
-  spBase.setVerticalStretch(1);
-  baseFrame->setSizePolicy(spBase);
+  auto splitter = newSplitter(Qt::Horizontal);
+  restoreSplitter(splitter, state, factory);
+
+  return splitter;
+}
+
+void Tile::restoreSplitter(QSplitter* splitter, const QJsonObject& state,
+                           const PendingFrame::Factory& factory) {
+  splitter->setOrientation(state["split"].toString() == "vertical"
+                               ? Qt::Vertical
+                               : Qt::Horizontal);
+
+  for (auto tile : state["tiles"].toArray())
+    splitter->addWidget(restoreNode(tile.toObject(), factory));
+  if (splitter->count() == 0) splitter->addWidget(new Pane(nullptr));
+
+  QList<int> sizes;
+  for (auto size : state["sizes"].toArray()) sizes << size.toInt();
+  if (sizes.size() == splitter->count()) splitter->setSizes(sizes);
+}
+
+Tile* Tile::restore(MainWindow* mw, const QJsonObject& state,
+                    const PendingFrame::Factory& factory) {
+  auto tile = new Tile(mw, nullptr);
+
+  if (state.contains("tiles")) {
+    tile->current = nullptr;
+    delete tile->root->widget(0);
+    tile->restoreSplitter(tile->root, state, factory);
+    tile->merge(tile->root);
+    tile->setCurrent(tile->root->findChild<Pane*>());
+  } else {
+    tile->current->setFrame(
+        LayoutStore::restoreFrame(state["frame"].toObject(), factory));
+  }
+
+  return tile;
+}
+
+Tile::Tile(MainWindow* tb, QFrame* frame)
+    : mw(tb), current(nullptr), orientation(Qt::Horizontal) {
+  root = newSplitter(orientation);
+
+  auto pane = new Pane(frame);
+  root->addWidget(pane);
+  setCurrent(pane);
+
+  connect(qApp, &QApplication::focusChanged, this, &Tile::focusChanged);
 
   auto layout = new QVBoxLayout;
   layout->setContentsMargins(5, 5, 5, 5);
-  layout->addWidget(baseFrame);
+  layout->addWidget(root);
 
   setLayout(layout);
   setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
 }
 
+/** * recycled frames have no parent to take them **/
+Tile::~Tile() { qDeleteAll(recycleList); }
+
 }  // namespace gyreui
@@ -15,20 +15,17 @@
 #define GYREUI_UI_TILE_H_
 
 #include <QFrame>
-#include <QLabel>
-#include <QTextEdit>
-#include <QToolBar>
-#include <QToolButton>
+#include <QJsonObject>
+#include <QList>
+#include <QSplitter>
 #include <QWidget>
 
 #include "GyreEnv.h"
+#include "Layout.h"
 #include "MainWindow.h"
 
 QT_BEGIN_NAMESPACE
-class QLabel;
-class QTextEdit;
-class QToolBar;
-class QToolButton;
+class QSplitter;
 class QVBoxLayout;
 class QWidget;
 QT_END_NAMESPACE
@@ -37,26 +34,66 @@ namespace gyreui {
 
 class MainWindow;
 
+/** * one frame in the tiling, moves between splitters with its frame **/
+class Pane : public QFrame {
+  Q_OBJECT
+
+ public:
+  QFrame* frame() const { return content; }
+
+  /** * the frame this pane held, unparented **/
+  QFrame* setFrame(QFrame*);
+
+  explicit Pane(QFrame*);
+
+ private:
+  QFrame* content;
+};
+
+/** * panes in nested splitters, split, closed and merged in place **/
 class Tile : public QFrame {
   Q_OBJECT
 
  public:
+  static const int RECYCLE_MAX = 8;
+
   explicit Tile(MainWindow*, QFrame*);
+  ~Tile() override;
+
+  static Tile* restore(MainWindow*, const QJsonObject&,
+                       const PendingFrame::Factory&);
+  QJsonObject saveState() const;
+
+  /** * a closed frame of type, nullptr if none was kept **/
+  QFrame* recycled(QString);
 
   void rebase(QFrame*);
   void split(QFrame*);
   void splith();
   void splitv();
+  void close();
 
  private:
-  enum STATE { UNSPLIT, HORIZONTAL, VERTICAL };
-
   void log(QString);
 
+  QSplitter* newSplitter(Qt::Orientation);
+  void splitPane(Pane*, Qt::Orientation, Pane*);
+  void splice(QSplitter*);
+  void merge(QSplitter*);
+  void recycle(QFrame*);
+  void setCurrent(Pane*);
+  void focusChanged(QWidget*, QWidget*);
+
+  QJsonObject saveNode(QWidget*) const;
+  QWidget* restoreNode(const QJsonObject&, const PendingFrame::Factory&);
+  void restoreSplitter(QSplitter*, const QJsonObject&,
+                       const PendingFrame::Factory&);
+
   MainWindow* mw;
-  STATE splitState;
-  QFrame* baseFrame;
-  Tile* splitTile;
+  QSplitter* root;
+  Pane* current;
+  Qt::Orientation orientation;
+  QList<QFrame*> recycleList;
 };
 
 }  // namespace gyreui
@@ -0,0 +1,218 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  TreeWatcher.cpp: recursive directory change notification
+ **
+ **  one inotify watch per directory, read on a thread of its own. a
+ **  directory created or moved into the tree is watched and walked
+ **  right away, its files reported as changed, so nothing written
+ **  into it before the watch went on is missed. a listed watcher
+ **  leaves that to its owner, which watches what it has listed.
+ **
+ **/
+#include "TreeWatcher.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <QFile>
+
+#include "LogBus.h"
+
+#ifdef Q_OS_LINUX
+#include <sys/inotify.h>
+#endif
+
+namespace gyreui {
+
+namespace {
+
+#ifdef Q_OS_LINUX
+const uint32_t WATCH_MASK = IN_CREATE | IN_DELETE | IN_MOVED_FROM |
+                            IN_MOVED_TO | IN_CLOSE_WRITE | IN_ONLYDIR |
+                            IN_EXCL_UNLINK;
+
+/* a listing shows sizes and times, so attribute changes count too */
+const uint32_t LISTED_MASK = WATCH_MASK | IN_ATTRIB;
+#endif
+
+std::atomic<bool> warned(false);
+
+}  // namespace
+
+int TreeWatcher::watch(QString dir) {
+#ifdef Q_OS_LINUX
+  if (fd < 0) return -1;
+
+  auto wd = inotify_add_watch(fd, QFile::encodeName(dir).constData(),
+                              mode == LISTED ? LISTED_MASK : WATCH_MASK);
+  if (wd < 0) {
+    if (errno == ENOSPC && !warned.exchange(true))
+      LogBus::instance()->post(
+          LogEntry::WARNING, "watcher",
+          "out of inotify watches, raise fs.inotify.max_user_watches; "
+          "changes under " + dir + " and anything watched after it "
+          "won't be seen");
+    return -1;
+  }
+
+  std::lock_guard<std::mutex> guard(lock);
+
+  /* the same directory reached through a link keeps its first path */
+  if (dirs.contains(wd)) return dirs[wd] == dir ? wd : -1;
+
+  dirs[wd] = dir;
+  return wd;
+#else
+  (void)dir;
+  return -1;
+#endif
+}
+
+void TreeWatcher::unwatch(int wd) {
+  std::lock_guard<std::mutex> guard(lock);
+
+#ifdef Q_OS_LINUX
+  if (dirs.remove(wd) != 0) inotify_rm_watch(fd, wd);
+#else
+  (void)wd;
+#endif
+}
+
+void TreeWatcher::clear() {
+  std::lock_guard<std::mutex> guard(lock);
+
+#ifdef Q_OS_LINUX
+  for (auto it = dirs.begin(); it != dirs.end(); ++it)
+    inotify_rm_watch(fd, it.key());
+#endif
+
+  dirs.clear();
+}
+
+void TreeWatcher::created(QString dir) {
+  watch(dir);
+
+  auto dp = opendir(QFile::encodeName(dir).constData());
+  if (dp == nullptr) return;
+
+  for (auto ent = readdir(dp); ent != nullptr; ent = readdir(dp)) {
+    if (ent->d_name[0] == '.') continue;
+
+    struct stat st;
+    if (fstatat(dirfd(dp), ent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+      continue;
+
+    auto path = dir + '/' + QFile::decodeName(ent->d_name);
+    if (S_ISDIR(st.st_mode))
+      created(path);
+    else if (S_ISREG(st.st_mode))
+      notify(CHANGED, path);
+  }
+
+  closedir(dp);
+}
+
+void TreeWatcher::read() {
+#ifdef Q_OS_LINUX
+  alignas(inotify_event) char buffer[64 * 1024];
+
+  for (;;) {
+    auto len = ::read(fd, buffer, sizeof buffer);
+    if (len <= 0) return;
+
+    for (auto at = buffer; at < buffer + len;) {
+      auto event = reinterpret_cast<const inotify_event*>(at);
+      at += sizeof(inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        notify(OVERFLOWED, QString());
+        continue;
+      }
+
+      QString dir;
+      {
+        std::lock_guard<std::mutex> guard(lock);
+
+        if (event->mask & IN_IGNORED) {
+          dirs.remove(event->wd);
+          continue;
+        }
+
+        dir = dirs.value(event->wd);
+      }
+
+      if (dir.isEmpty() || event->len == 0) continue;
+      if (mode == TREE && event->name[0] == '.') continue;
+
+      auto path = dir + '/' + QFile::decodeName(event->name);
+      auto gone = event->mask & (IN_DELETE | IN_MOVED_FROM);
+
+      if (event->mask & IN_ISDIR) {
+        if (gone)
+          notify(DIR_REMOVED, path);
+        else if (mode == LISTED)
+          notify(CHANGED, path);
+        else if (event->mask & (IN_CREATE | IN_MOVED_TO))
+          created(path);
+      } else {
+        notify(gone ? REMOVED : CHANGED, path);
+      }
+    }
+  }
+#endif
+}
+
+void TreeWatcher::run() {
+  pollfd fds[2] = {{fd, POLLIN, 0}, {wake[0], POLLIN, 0}};
+
+  while (!stopping.load()) {
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) continue;
+      return;
+    }
+
+    if (fds[1].revents != 0) return;
+    if (fds[0].revents & POLLIN) read();
+  }
+}
+
+TreeWatcher::TreeWatcher(Notify notify, Mode mode)
+    : notify(notify), mode(mode), fd(-1), wake{-1, -1}, stopping(false) {
+#ifdef Q_OS_LINUX
+  fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+
+  if (fd >= 0 && pipe2(wake, O_CLOEXEC) != 0) {
+    ::close(fd);
+    fd = -1;
+  }
+
+  if (fd >= 0) worker = std::thread([this]() { run(); });
+}
+
+TreeWatcher::~TreeWatcher() {
+  stopping.store(true);
+
+  if (worker.joinable()) {
+    (void)::write(wake[1], "", 1);
+    worker.join();
+  }
+
+  for (auto end : {fd, wake[0], wake[1]})
+    if (end >= 0) ::close(end);
+}
+
+}  // namespace gyreui
@@ -0,0 +1,67 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  TreeWatcher.h: recursive directory change notification
+ **
+ **/
+#ifndef GYREUI_UI_TREEWATCHER_H_
+#define GYREUI_UI_TREEWATCHER_H_
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+#include <QHash>
+#include <QString>
+
+namespace gyreui {
+
+/** * callbacks run on the watcher thread **/
+class TreeWatcher {
+ public:
+  enum Change { CHANGED, REMOVED, DIR_REMOVED, OVERFLOWED };
+
+  /** * TREE follows new directories down and skips hidden entries,
+        LISTED reports every entry of the directories it was given **/
+  enum Mode { TREE, LISTED };
+
+  typedef std::function<void(Change, QString)> Notify;
+
+  /** * any thread, before the directory is read so nothing slips by,
+        -1 if it isn't watched or already is under another path **/
+  int watch(QString);
+  void unwatch(int);
+  void clear();
+
+  bool available() const { return fd >= 0; }
+
+  explicit TreeWatcher(Notify, Mode = TREE);
+  ~TreeWatcher();
+
+ private:
+  void run();
+  void read();
+  void created(QString);
+
+  Notify notify;
+  Mode mode;
+
+  int fd;
+  int wake[2];
+  std::mutex lock;
+  QHash<int, QString> dirs;
+  std::atomic<bool> stopping;
+  std::thread worker;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_TREEWATCHER_H_ */
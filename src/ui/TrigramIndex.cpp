@@ -0,0 +1,475 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  TrigramIndex.cpp: memory mapped trigram index implementation
+ **
+ **  the file is a header, a fixed size record per file, a sorted table
+ **  of trigrams each pointing at its posting list, the posting lists
+ **  as delta encoded varints, and the paths. nothing is read into
+ **  memory, a query binary searches the mapped table and decodes the
+ **  lists it needs, shortest first.
+ **
+ **  it's written from each file's packed trigrams a shard of trigrams
+ **  at a time, so the builder holds a few bytes per trigram and file
+ **  and one shard's pairs, and the posting lists go straight to disk.
+ **
+ **/
+#include "TrigramIndex.h"
+
+#include <ctype.h>
+#include <string.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <QBitArray>
+#include <QSaveFile>
+
+namespace gyreui {
+
+namespace {
+
+const char MAGIC[8] = {'G', 'Y', 'R', 'E', 'T', 'R', 'I', '1'};
+
+/* shards are the trigrams sharing a first byte */
+const int SHARD_SHIFT = 16;
+const quint32 TRIGRAMS = 1 << 24;
+
+quint32 fold(uchar ch) { return ch >= 'A' && ch <= 'Z' ? ch + 32 : ch; }
+
+void putVarint(QByteArray& out, quint32 value) {
+  for (; value >= 0x80; value >>= 7) out.append(char(value | 0x80));
+  out.append(char(value));
+}
+
+bool getVarint(const QByteArray& in, int& at, quint32& value) {
+  value = 0;
+
+  for (quint32 shift = 0; at < in.size(); shift += 7) {
+    auto byte = uchar(in[at++]);
+
+    value |= quint32(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) return true;
+  }
+
+  return false;
+}
+
+/** * a file's place in its packed trigrams **/
+struct Cursor {
+  int at;
+  quint32 last;
+};
+
+/** * skips past a bracketed class or a group, escapes included **/
+int skipTo(const QString& pattern, int at, QChar open, QChar close) {
+  auto depth = 0;
+
+  for (; at < pattern.size(); ++at) {
+    if (pattern[at] == '\\') {
+      ++at;
+    } else if (pattern[at] == '[' && open == '(') {
+      at = skipTo(pattern, at + 1, ']', ']');
+    } else if (pattern[at] == open && open != close) {
+      ++depth;
+    } else if (pattern[at] == close) {
+      if (--depth <= 0) return at;
+    }
+  }
+
+  return at;
+}
+
+/** * the last character of a letter or digit escape, \x41, \p{L}, \12 **/
+int skipEscape(const QString& pattern, int at) {
+  auto kind = pattern[at];
+  auto next = at + 1;
+
+  if (next < pattern.size()) {
+    auto open = pattern[next];
+
+    if (open == '{' || open == '<' || open == '\'') {
+      auto close = open == '{' ? '}' : open == '<' ? '>' : '\'';
+      auto end = pattern.indexOf(close, next + 1);
+
+      return end < 0 ? pattern.size() : end;
+    }
+  }
+
+  if (kind == 'x')
+    while (next < pattern.size() && next <= at + 2 &&
+           isxdigit(pattern[next].toLatin1()))
+      ++next;
+  else if (kind == 'c')
+    next = qMin(next + 1, pattern.size());
+  else if (kind.isDigit() || kind == 'g')
+    while (next < pattern.size() && pattern[next].isDigit()) ++next;
+
+  return next - 1;
+}
+
+}  // namespace
+
+struct TrigramIndex::Header {
+  char magic[8];
+  quint32 files;
+  quint32 trigrams;
+  quint64 fileTable;
+  quint64 trigramTable;
+  quint64 postings;
+  quint64 strings;
+  quint32 root;
+  quint32 rootLength;
+};
+
+struct TrigramIndex::FileRecord {
+  qint64 mtime;
+  qint64 size;
+  quint32 path;
+  quint32 length;
+};
+
+struct TrigramIndex::TrigramRecord {
+  quint32 trigram;
+  quint32 count;
+  quint64 offset;
+  quint64 bytes;
+};
+
+/** * trigrams across a line break are never asked for **/
+QVector<quint32> TrigramIndex::trigrams(const QByteArray& bytes) {
+  auto data = reinterpret_cast<const uchar*>(bytes.constData());
+  QVector<quint32> out;
+
+  out.reserve(qMax(0, bytes.size() - 2));
+  for (int i = 0; i + 2 < bytes.size(); ++i) {
+    if (data[i] == '\n' || data[i + 1] == '\n' || data[i + 2] == '\n')
+      continue;
+
+    out << (fold(data[i]) << 16 | fold(data[i + 1]) << 8 | fold(data[i + 2]));
+  }
+
+  std::sort(out.begin(), out.end());
+  out.erase(std::unique(out.begin(), out.end()), out.end());
+
+  return out;
+}
+
+/** * conservative: alternation gives up, groups and classes break runs,
+      and a character an optional quantifier applies to is dropped **/
+QStringList TrigramIndex::literals(QString pattern, bool regex) {
+  if (!regex) return {pattern};
+  if (pattern.contains('|')) return {};
+
+  QStringList runs;
+  QString run;
+
+  auto flush = [&runs, &run]() {
+    if (!run.isEmpty()) runs << run;
+    run.clear();
+  };
+
+  for (int i = 0; i < pattern.size(); ++i) {
+    auto ch = pattern[i];
+
+    switch (ch.unicode()) {
+      case '\\':
+        if (i + 1 < pattern.size() && !pattern[i + 1].isLetterOrNumber()) {
+          run += pattern[++i];
+        } else {
+          flush();
+          if (i + 1 < pattern.size()) i = skipEscape(pattern, i + 1);
+        }
+        break;
+      case '[':
+        flush();
+        i = skipTo(pattern, i + 1 < pattern.size() && pattern[i + 1] == ']'
+                                ? i + 2
+                                : i + 1,
+                   ']', ']');
+        break;
+      case '(':
+        flush();
+        i = skipTo(pattern, i, '(', ')');
+        break;
+      case '*':
+      case '?':
+      case '{':
+        run.chop(1);
+        flush();
+        if (ch == '{') i = skipTo(pattern, i, '{', '}');
+        break;
+      case '+':
+      case '.':
+      case '^':
+      case '$':
+      case ')':
+      case ']':
+      case '}':
+        flush();
+        break;
+      default:
+        run += ch;
+        break;
+    }
+  }
+
+  flush();
+  return runs;
+}
+
+QByteArray TrigramIndex::pack(const QVector<quint32>& trigrams) {
+  QByteArray out;
+  quint32 last = 0;
+
+  for (auto trigram : trigrams) {
+    putVarint(out, trigram - last);
+    last = trigram;
+  }
+
+  return out;
+}
+
+/** * the tables are sized from a first pass over the packed trigrams,
+      the posting lists follow them a shard at a time, and the header
+      and trigram table are filled in last **/
+bool TrigramIndex::write(QString path, QString root, const QVector<File>& files,
+                         const QVector<QByteArray>& packed) {
+  QByteArray strings;
+  QVector<FileRecord> records;
+
+  records.reserve(files.size());
+  for (auto& file : files) {
+    auto utf8 = file.path.toUtf8();
+
+    records << FileRecord{file.mtime, file.size, quint32(strings.size()),
+                          quint32(utf8.size())};
+    strings += utf8;
+  }
+
+  QBitArray present(TRIGRAMS);
+  for (auto& list : packed) {
+    quint32 trigram = 0;
+    quint32 delta;
+
+    for (int at = 0; getVarint(list, at, delta);)
+      present.setBit(trigram += delta);
+  }
+
+  Header header;
+  memset(&header, 0, sizeof header);
+  memcpy(header.magic, MAGIC, sizeof MAGIC);
+
+  header.files = records.size();
+  header.trigrams = present.count(true);
+  header.fileTable = sizeof header;
+  header.trigramTable = header.fileTable + records.size() * sizeof(FileRecord);
+  header.postings =
+      header.trigramTable + quint64(header.trigrams) * sizeof(TrigramRecord);
+
+  QSaveFile out(path);
+  if (!out.open(QIODevice::WriteOnly)) return false;
+
+  out.write(reinterpret_cast<const char*>(&header), sizeof header);
+  out.write(reinterpret_cast<const char*>(records.constData()),
+            records.size() * sizeof(FileRecord));
+  if (!out.seek(header.postings)) return false;
+
+  QVector<TrigramRecord> table;
+  std::vector<Cursor> cursors(packed.size(), Cursor{0, 0});
+  std::vector<quint64> pairs;
+  QByteArray lists;
+  quint64 offset = 0;
+
+  table.reserve(header.trigrams);
+  for (quint32 limit = 1 << SHARD_SHIFT; limit <= TRIGRAMS;
+       limit += 1 << SHARD_SHIFT) {
+    pairs.clear();
+
+    for (int file = 0; file < packed.size(); ++file) {
+      auto& cursor = cursors[file];
+
+      for (quint32 delta;;) {
+        auto at = cursor.at;
+
+        if (!getVarint(packed[file], at, delta) ||
+            cursor.last + delta >= limit)
+          break;
+
+        cursor.at = at;
+        cursor.last += delta;
+        pairs.push_back(quint64(cursor.last) << 32 | quint32(file));
+      }
+    }
+
+    std::sort(pairs.begin(), pairs.end());
+    lists.clear();
+
+    for (size_t i = 0; i < pairs.size();) {
+      auto trigram = quint32(pairs[i] >> 32);
+      TrigramRecord record{trigram, 0, offset + lists.size(), 0};
+
+      quint32 last = 0;
+      for (; i < pairs.size() && quint32(pairs[i] >> 32) == trigram; ++i) {
+        auto file = quint32(pairs[i]);
+
+        putVarint(lists, file - last);
+        last = file;
+        record.count++;
+      }
+
+      record.bytes = offset + lists.size() - record.offset;
+      table << record;
+    }
+
+    if (out.write(lists) != lists.size()) return false;
+    offset += lists.size();
+  }
+
+  header.strings = header.postings + offset;
+
+  auto utf8 = root.toUtf8();
+  header.root = strings.size();
+  header.rootLength = utf8.size();
+  strings += utf8;
+
+  out.write(strings);
+
+  out.seek(0);
+  out.write(reinterpret_cast<const char*>(&header), sizeof header);
+  out.seek(header.trigramTable);
+  out.write(reinterpret_cast<const char*>(table.constData()),
+            table.size() * sizeof(TrigramRecord));
+
+  return out.commit();
+}
+
+bool TrigramIndex::open(QString path) {
+  mapped.setFileName(path);
+  if (!mapped.open(QIODevice::ReadOnly)) return false;
+
+  length = mapped.size();
+  if (length < qint64(sizeof(Header))) return false;
+
+  base = mapped.map(0, length);
+  if (base == nullptr) return false;
+
+  auto candidate = reinterpret_cast<const Header*>(base);
+  auto files = quint64(candidate->files) * sizeof(FileRecord);
+  auto trigrams = quint64(candidate->trigrams) * sizeof(TrigramRecord);
+
+  auto valid =
+      memcmp(candidate->magic, MAGIC, sizeof MAGIC) == 0 &&
+      candidate->fileTable == sizeof(Header) &&
+      candidate->trigramTable == candidate->fileTable + files &&
+      candidate->postings == candidate->trigramTable + trigrams &&
+      candidate->strings >= candidate->postings &&
+      candidate->strings + candidate->root + candidate->rootLength <=
+          quint64(length);
+
+  if (!valid) return false;
+
+  header = candidate;
+  fileTable = reinterpret_cast<const FileRecord*>(base + header->fileTable);
+  trigramTable =
+      reinterpret_cast<const TrigramRecord*>(base + header->trigramTable);
+  rootPath = string(header->root, header->rootLength);
+
+  return true;
+}
+
+QString TrigramIndex::string(quint32 offset, quint32 size) const {
+  if (header->strings + offset + size > quint64(length)) return QString();
+
+  return QString::fromUtf8(
+      reinterpret_cast<const char*>(base + header->strings + offset), size);
+}
+
+int TrigramIndex::files() const {
+  return header == nullptr ? 0 : header->files;
+}
+
+TrigramIndex::File TrigramIndex::file(int id) const {
+  auto& record = fileTable[id];
+
+  return {string(record.path, record.length), record.mtime, record.size};
+}
+
+QVector<quint32> TrigramIndex::postings(const TrigramRecord& record) const {
+  QVector<quint32> out;
+
+  auto at = base + header->postings + record.offset;
+  auto end = qMin(at + record.bytes, base + header->strings);
+
+  out.reserve(record.count);
+  for (quint32 last = 0, value = 0, shift = 0; at < end; ++at) {
+    value |= quint32(*at & 0x7f) << shift;
+    shift += 7;
+
+    if ((*at & 0x80) == 0) {
+      last += value;
+      out << last;
+      value = shift = 0;
+    }
+  }
+
+  return out;
+}
+
+QVector<quint32> TrigramIndex::candidates(
+    const QVector<quint32>& wanted) const {
+  QVector<quint32> out;
+
+  if (header == nullptr) return out;
+
+  if (wanted.isEmpty()) {
+    out.reserve(header->files);
+    for (quint32 id = 0; id < header->files; ++id) out << id;
+    return out;
+  }
+
+  auto end = trigramTable + header->trigrams;
+  QVector<const TrigramRecord*> found;
+
+  for (auto trigram : wanted) {
+    auto record = std::lower_bound(
+        trigramTable, end, trigram,
+        [](const TrigramRecord& r, quint32 t) { return r.trigram < t; });
+
+    if (record == end || record->trigram != trigram) return out;
+    found << record;
+  }
+
+  std::sort(found.begin(), found.end(),
+            [](const TrigramRecord* a, const TrigramRecord* b) {
+              return a->count < b->count;
+            });
+
+  out = postings(*found[0]);
+  for (int i = 1; i < found.size() && !out.isEmpty(); ++i) {
+    auto next = postings(*found[i]);
+    QVector<quint32> both;
+
+    std::set_intersection(out.begin(), out.end(), next.begin(), next.end(),
+                          std::back_inserter(both));
+    out = both;
+  }
+
+  return out;
+}
+
+TrigramIndex::TrigramIndex()
+    : base(nullptr),
+      length(0),
+      header(nullptr),
+      fileTable(nullptr),
+      trigramTable(nullptr) {}
+
+}  // namespace gyreui
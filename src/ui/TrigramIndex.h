@@ -0,0 +1,77 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  TrigramIndex.h: memory mapped trigram index
+ **
+ **/
+#ifndef GYREUI_UI_TRIGRAMINDEX_H_
+#define GYREUI_UI_TRIGRAMINDEX_H_
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace gyreui {
+
+/** * read only once written, queries share it across threads **/
+class TrigramIndex {
+ public:
+  struct File {
+    QString path;
+    qint64 mtime;
+    qint64 size;
+  };
+
+  /** * case folded byte trigrams, sorted and unique **/
+  static QVector<quint32> trigrams(const QByteArray&);
+
+  /** * literal runs every match of the pattern has to contain **/
+  static QStringList literals(QString, bool);
+
+  /** * sorted trigrams as delta encoded varints, a few bytes each **/
+  static QByteArray pack(const QVector<quint32>&);
+
+  /** * files by relative path, each with its packed trigrams **/
+  static bool write(QString, QString, const QVector<File>&,
+                    const QVector<QByteArray>&);
+
+  bool open(QString);
+
+  QString root() const { return rootPath; }
+  int files() const;
+  File file(int) const;
+
+  /** * files holding every trigram, all of them for none **/
+  QVector<quint32> candidates(const QVector<quint32>&) const;
+
+  TrigramIndex();
+
+ private:
+  struct Header;
+  struct FileRecord;
+  struct TrigramRecord;
+
+  QVector<quint32> postings(const TrigramRecord&) const;
+  QString string(quint32, quint32) const;
+
+  QFile mapped;
+  const uchar* base;
+  qint64 length;
+  const Header* header;
+  const FileRecord* fileTable;
+  const TrigramRecord* trigramTable;
+  QString rootPath;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_TRIGRAMINDEX_H_ */
@@ -13,25 +13,23 @@
  **/
 #include "TtyWidget.h"
 
+#include "FormReader.h"
+#include "Profiler.h"
+#include "Watchdog.h"
+
+#include <algorithm>
+
+#include <QClipboard>
 #include <QDebug>
+#include <QGuiApplication>
 #include <QKeyEvent>
 #include <QMouseEvent>
 #include <QPainter>
 #include <QScrollBar>
+#include <QStringListModel>
 
 namespace gyreui {
 
-struct LineStyle {
-  LineStyle(const QColor& bg, const QColor& fg, int s, int l)
-      : background(bg), foreground(fg), start(s), length(l) {}
-
-  QBrush background;
-  QPen foreground;
-
-  int start;
-  int length;
-};
-
 struct TextPosition {
   TextPosition(int r = 0, int c = 0) : row(r), column(c) {}
 
@@ -81,41 +79,25 @@ struct TextSelection {
   TextPosition end_pos;
 };
 
-inline LineStyle normalStyle(int start, int length) {
-  return LineStyle(Qt::white, Qt::black, start, length);
-}
+namespace {
 
-inline LineStyle highlightStyle(int start, int length) {
-  return LineStyle(Qt::darkGray, Qt::white, start, length);
-}
+const int XOFF = 5;
+const int YOFF = 5;
 
-namespace {
+const CellAttr ERROR_ATTR = {0xffcc0000, 0, 0};
+const CellAttr BANNER_ATTR = {0xff808080, 0, 0};
 
-QList<LineStyle> getLineStyle(const TextSelection& sel, int length, int row) {
-  QList<LineStyle> styles;
-
-  if (!sel.hasActiveSelection()) {
-    styles << normalStyle(0, length);
-  } else if (sel.first().row == row && sel.last().row == row) {
-    styles << normalStyle(0, sel.first().column);
-    styles << highlightStyle(sel.first().column,
-                             sel.last().column - sel.first().column);
-
-    styles << normalStyle(sel.last().column, length - sel.last().column + 1);
-  } else if (sel.first().row == row) {
-    styles << normalStyle(0, sel.first().column);
-    styles << highlightStyle(sel.first().column,
-                             length - sel.first().column + 1);
-  } else if (sel.last().row == row) {
-    styles << highlightStyle(0, sel.last().column);
-    styles << normalStyle(sel.last().column, length - sel.last().column + 1);
-  } else if (sel.first().row < row && sel.last().row > row) {
-    styles << highlightStyle(0, length);
-  } else {
-    styles << normalStyle(0, length);
-  }
+/** * selected columns of row, empty if none **/
+QPair<int, int> selectedColumns(const TextSelection& sel, int length,
+                                int row) {
+  if (!sel.hasActiveSelection() || row < sel.first().row ||
+      row > sel.last().row)
+    return qMakePair(0, 0);
+
+  auto start = sel.first().row == row ? sel.first().column : 0;
+  auto end = sel.last().row == row ? sel.last().column : length;
 
-  return styles;
+  return qMakePair(qBound(0, start, length), qBound(0, end, length));
 }
 
 int drawWidth(QPainter& painter, const QString& text) {
@@ -125,74 +107,109 @@ int drawWidth(QPainter& painter, const QString& text) {
 
 } /* anonymous namespace */
 
-/** * draw text line **/
-void TtyWidget::DrawLine(int& x_offset, int y_offset, QString line,
-                         QFontMetrics m, int current_line) {
-  static const int XOFF = 5;
-  static const int YOFF = 5;
+/** * draw text line, attribute runs split further by the selection **/
+void TtyWidget::DrawLine(QPainter& painter, int& x_offset, int y_offset,
+                         const QString& line, const QVector<AttrRun>& runs,
+                         const QFontMetrics& m, int current_line) {
+  if (y_offset >= viewport()->height() || current_line < 0 || line.isEmpty())
+    return;
 
-  QPainter painter(viewport());
+  auto selected =
+      selectedColumns(*_selection.data(), line.size(), current_line);
+
+  auto run = runs.constBegin();
+  auto index = Scrollback::PLAIN;
+  const int text_offset = y_offset + m.ascent();
 
-  if (y_offset < viewport()->height() && current_line >= 0 && line.size() > 0) {
-    const int text_offset = y_offset + m.ascent();
+  for (int start = 0; start < line.size();) {
+    while (run != runs.constEnd() && run->start <= start) index = (run++)->attr;
 
-    foreach (const auto style,
-             getLineStyle(*_selection.data(), line.size(), current_line)) {
-      painter.setPen(style.foreground);
-      painter.setBrush(style.background);
+    auto end = line.size();
+    if (run != runs.constEnd()) end = qMin(end, run->start);
+    if (selected.first > start) end = qMin(end, selected.first);
+    if (selected.second > start) end = qMin(end, selected.second);
 
-      const QString text = line.mid(style.start, style.length);
-      int text_width = drawWidth(painter, text);
+    auto& attr = buffer_.attr(index);
+    QColor fg = attr.foreground(Qt::black);
+    QColor bg = attr.background(Qt::white);
 
-      painter.fillRect(
-          QRect(x_offset + XOFF, y_offset + YOFF, text_width, m.height()),
-          style.background);
-      painter.drawText(x_offset + XOFF, text_offset + YOFF, text);
-      x_offset += text_width;
+    if (attr.flags & CellAttr::INVERSE) std::swap(fg, bg);
+    if (start >= selected.first && start < selected.second) {
+      fg = Qt::white;
+      bg = Qt::darkGray;
     }
+
+    /** * segment_ aliases the line, no copy per segment **/
+    segment_.setRawData(line.constData() + start, end - start);
+    int text_width = drawWidth(painter, segment_);
+
+    painter.fillRect(
+        QRect(x_offset + XOFF, y_offset + YOFF, text_width, m.height()), bg);
+    painter.setPen(fg);
+    painter.drawText(x_offset + XOFF, text_offset + YOFF, segment_);
+    x_offset += text_width;
+    start = end;
   }
+  segment_.clear();
 }
 
 /** * class members **/
-void TtyWidget::paintEvent(QPaintEvent*) {
+void TtyWidget::paintEvent(QPaintEvent* event) {
   QPainter painter(viewport());
-  painter.fillRect(viewport()->rect(), Qt::white);
+  painter.fillRect(event->rect(), Qt::white);
 
   QFontMetrics m = painter.fontMetrics();
 
-  int current_line = verticalScrollBar()->value() / m.height();
+  int top = verticalScrollBar()->value() / m.height();
+  int current_line = top;
 
   int y_offset = 0;
   int x_offset = 0;
   int maximum_width = 0;
 
-  /* display the buffer */
+  /* display the buffer, skipping lines outside the damaged area */
   while (y_offset < viewport()->height() && current_line >= 0 &&
          current_line < buffer_.size()) {
-    x_offset = -horizontalScrollBar()->value();
+    if (event->rect().intersects(QRect(0, y_offset + YOFF,
+                                       viewport()->width(), m.height()))) {
+      x_offset = -horizontalScrollBar()->value();
 
-    DrawLine(x_offset, y_offset, buffer_[current_line], m, current_line);
+      DrawLine(painter, x_offset, y_offset, buffer_.text(current_line),
+               buffer_.runs(current_line), m, current_line);
+      DrawMatches(painter, y_offset, current_line, m);
 
-    maximum_width =
-        qMax(maximum_width, m.horizontalAdvance(buffer_[current_line]));
+      maximum_width =
+          qMax(maximum_width, m.horizontalAdvance(buffer_.text(current_line)));
+    }
 
     y_offset += m.height();
     ++current_line;
   }
 
-  /* display the prompt */
-  x_offset = -horizontalScrollBar()->value();
-  DrawLine(x_offset, y_offset, prompt_, m, current_line);
-  /* display the current line */
-  DrawLine(x_offset, y_offset, line_, m, current_line);
-  /* display the cursor */
-  DrawLine(x_offset, y_offset, cursor_, m, current_line);
+  /* display the prompt and input, continuation lines under the first */
+  auto& input = inputLines();
+  auto indent = m.horizontalAdvance(prompt_);
 
-  maximum_width = qMax(maximum_width, m.horizontalAdvance(prompt_) +
-                                          m.horizontalAdvance(line_) +
-                                          m.horizontalAdvance(cursor_));
+  for (int i = qMax(0, top - buffer_.size()); i < input.size(); ++i) {
+    current_line = buffer_.size() + i;
+    y_offset = (current_line - top) * m.height();
+    if (y_offset >= viewport()->height()) break;
 
-  verticalScrollBar()->setRange(0, buffer_.size() * m.height());
+    x_offset = -horizontalScrollBar()->value();
+    if (i == 0)
+      DrawLine(painter, x_offset, y_offset, prompt_, {}, m, current_line);
+    else
+      x_offset += indent;
+
+    DrawLine(painter, x_offset, y_offset, input[i], {}, m, current_line);
+
+    maximum_width = qMax(maximum_width, indent + m.horizontalAdvance(input[i]));
+  }
+
+  DrawCursor(painter, m);
+
+  verticalScrollBar()->setRange(
+      0, (buffer_.size() + input.size() - 1) * m.height());
   verticalScrollBar()->setSingleStep(m.height());
   verticalScrollBar()->setPageStep(viewport()->height());
 
@@ -202,117 +219,623 @@ void TtyWidget::paintEvent(QPaintEvent*) {
   horizontalScrollBar()->setPageStep(viewport()->width());
 }
 
-void TtyWidget::DrawCursor() {
-  // const int x = m.width(buffer_[current_line], _selection->cursor().column);
-  // painter.setPen(QPen(Qt::red, 2));
-  // painter.drawLine(x, y_offset, x, y_offset + m.height());
-  // painter.setPen(Qt::black);
+void TtyWidget::DrawCursor(QPainter& painter, const QFontMetrics& m) {
+  if (searching_) return;
+
+  painter.fillRect(cursorRect(m), Qt::black);
 }
 
+/** * find matches on row, over the text already drawn **/
+void TtyWidget::DrawMatches(QPainter& painter, int y_offset, int row,
+                            const QFontMetrics& m) {
+  auto first = std::lower_bound(
+      matches_.begin(), matches_.end(), row,
+      [](const ScrollbackFinder::Match& match, int row) {
+        return match.row < row;
+      });
+
+  if (first == matches_.end() || first->row != row) return;
+
+  auto offsets = glyphOffsets(row);
+  auto x = XOFF - horizontalScrollBar()->value();
+
+  for (auto it = first; it != matches_.end() && it->row == row; ++it) {
+    auto start = qMin(it->column, offsets.size() - 1);
+    auto end = qMin(it->column + matchLength_, offsets.size() - 1);
+    auto current = it - matches_.begin() == currentMatch_;
+
+    painter.fillRect(QRect(x + offsets[start], y_offset + YOFF,
+                           offsets[end] - offsets[start], m.height()),
+                     current ? QColor(255, 140, 0, 128)
+                             : QColor(255, 255, 0, 128));
+  }
+}
+
+void TtyWidget::changeEvent(QEvent* event) {
+  if (event->type() == QEvent::FontChange) offsets_.clear();
+
+  QAbstractScrollArea::changeEvent(event);
+}
+
+/** * x of every column boundary on a scrollback line, cached by row **/
+QVector<int> TtyWidget::glyphOffsets(int row) const {
+  if (auto cached = offsets_.object(row)) return *cached;
+
+  QFontMetrics m(font());
+  auto& line = buffer_.text(row);
+  QVector<int> offsets(line.size() + 1);
+
+  offsets[0] = 0;
+  for (int i = 0; i < line.size(); ++i)
+    offsets[i + 1] = offsets[i] + m.horizontalAdvance(line[i]);
+
+  offsets_.insert(row, new QVector<int>(offsets), offsets.size());
+  return offsets;
+}
+
+/** * nearest column boundary, scrollback rows only **/
 TextPosition TtyWidget::getTextPosition(const QPoint& pos) const {
   QFontMetrics m(font());
 
-  int current_line = 0;
+  if (buffer_.isEmpty()) return TextPosition();
 
-  while (current_line * m.height() < pos.y()) {
-    ++current_line;
-  }
+  auto top = verticalScrollBar()->value() / m.height();
 
   TextPosition tp;
-  tp.row = current_line + verticalScrollBar()->value() / m.height() - 1;
+  tp.row = qBound(0, top + (pos.y() - YOFF) / m.height(), buffer_.size() - 1);
 
-  int current_column = 0;
+  auto offsets = glyphOffsets(tp.row);
+  auto x = pos.x() - XOFF + horizontalScrollBar()->value();
+  auto it = std::lower_bound(offsets.begin(), offsets.end(), x);
 
-  if (tp.row < buffer_.size() - 1) {
-    while (tp.row >= 0 && m.horizontalAdvance(buffer_[tp.row], current_column) <
-                              pos.x() + horizontalScrollBar()->value()) {
-      if (++current_column >= buffer_[tp.row].size()) {
-        break;
-      }
+  if (it == offsets.end())
+    tp.column = offsets.size() - 1;
+  else if (it != offsets.begin() && x - *(it - 1) < *it - x)
+    tp.column = it - offsets.begin() - 1;
+  else
+    tp.column = it - offsets.begin();
+
+  return tp;
+}
+
+QString TtyWidget::selectedText() const {
+  if (!_selection->hasActiveSelection()) return QString();
+
+  auto first = _selection->first();
+  auto last = _selection->last();
+  QStringList out;
+
+  for (int row = first.row; row <= last.row && row < buffer_.size(); ++row) {
+    auto& line = buffer_.text(row);
+    auto start = row == first.row ? first.column : 0;
+    auto end = row == last.row ? last.column : line.size();
+
+    out << line.mid(start, end - start);
+  }
+
+  return out.join('\n');
+}
+
+void TtyWidget::copySelection(QClipboard::Mode mode) {
+  if (_selection->hasActiveSelection())
+    QGuiApplication::clipboard()->setText(selectedText(), mode);
+}
+
+/** * input line **/
+const QStringList& TtyWidget::inputLines() {
+  if (inputGeneration_ != line_.generation()) {
+    inputLines_ = line_.lines();
+    inputGeneration_ = line_.generation();
+  }
+
+  return inputLines_;
+}
+
+/** * from the prompt row to the bottom of the viewport **/
+QRect TtyWidget::inputRect() {
+  QFontMetrics m(font());
+
+  auto top = verticalScrollBar()->value() / m.height();
+  auto y = (buffer_.size() - top) * m.height() + YOFF;
+
+  return QRect(0, y, viewport()->width(), viewport()->height() - y);
+}
+
+QRect TtyWidget::cursorRect(const QFontMetrics& m) {
+  auto top = verticalScrollBar()->value() / m.height();
+  auto row = line_.row();
+  auto text = inputLines().value(row).left(line_.column());
+
+  auto x = m.horizontalAdvance(prompt_) + m.horizontalAdvance(text) -
+           horizontalScrollBar()->value() + XOFF;
+  auto y = (buffer_.size() + row - top) * m.height() + YOFF;
+
+  return QRect(x, y, 2, m.height());
+}
+
+/** * repaint just the input rows, Qt folds repeated requests into one paint **/
+void TtyWidget::updateInput() { viewport()->update(inputRect()); }
+
+/** * repaint from a scrollback row down, rows above it haven't changed **/
+void TtyWidget::updateFrom(int row) {
+  QFontMetrics m(font());
+
+  auto top = verticalScrollBar()->value() / m.height();
+  auto y = qMax(0, (row - top) * m.height() + YOFF);
+
+  viewport()->update(
+      QRect(0, y, viewport()->width(), viewport()->height() - y));
+}
+
+/** * a paste is one edit no matter how many lines it holds **/
+void TtyWidget::paste(QString text) {
+  text.remove("\x1b[200~").remove("\x1b[201~");
+  text.replace("\r\n", "\n").replace('\r', '\n');
+
+  completer_->popup()->hide();
+  line_.insert(text);
+}
+
+/** * completion **/
+void TtyWidget::requestCompletion() {
+  auto prefix = Completer::prefixOf(line_.left(), line_.cursor());
+
+  if (prefix.isEmpty()) {
+    completer_->popup()->hide();
+    return;
+  }
+
+  symbols_->complete(prefix, this, [this](QString prefix, QStringList matches) {
+    /* the line moved on while we waited */
+    if (prefix != Completer::prefixOf(line_.left(), line_.cursor())) return;
+
+    if (matches.size() == 1 && !completer_->popup()->isVisible()) {
+      insertCompletion(matches.first());
+      return;
+    }
+
+    if (matches.isEmpty()) {
+      completer_->popup()->hide();
+      return;
     }
+
+    static_cast<QStringListModel*>(completer_->model())->setStringList(matches);
+    completer_->setCompletionPrefix(prefix);
+
+    auto rect = cursorRect(fontMetrics());
+    rect.setWidth(completer_->popup()->sizeHintForColumn(0) +
+                  completer_->popup()->verticalScrollBar()->sizeHint().width());
+    completer_->complete(rect);
+  });
+}
+
+void TtyWidget::insertCompletion(const QString& completion) {
+  auto prefix = Completer::prefixOf(line_.left(), line_.cursor());
+
+  line_.insert(completion.mid(prefix.size()));
+  updateInput();
+}
+
+/** * history **/
+void TtyWidget::historyMove(int delta) {
+  auto size = history_->size();
+
+  if (historyIndex_ < 0 || historyIndex_ > size) historyIndex_ = size;
+  if (historyIndex_ == size) draft_ = line_.text();
+
+  historyIndex_ = qBound(0, historyIndex_ + delta, size);
+  line_.setText(historyIndex_ == size ? draft_ : history_->at(historyIndex_));
+}
+
+void TtyWidget::searchUpdate(int before) {
+  auto match = history_->search(searchQuery_, before);
+
+  if (match >= 0) {
+    searchMatch_ = match;
+    line_.setText(history_->at(match));
   }
 
-  tp.column = current_column;
+  searchFailed_ = match < 0 && !searchQuery_.isEmpty();
+  prompt_ = QString(searchFailed_ ? "(failed search)'%1': " : "(search)'%1': ")
+                .arg(searchQuery_);
+}
 
-  return tp;
+void TtyWidget::searchEnd() {
+  searching_ = false;
+  prompt_ = QString(". ");
+  historyIndex_ = searchMatch_;
+}
+
+/** * keys while in ctrl-r search, false if the key should run as usual **/
+bool TtyWidget::searchKey(QKeyEvent* event) {
+  switch (event->key()) {
+    case Qt::Key_R:
+      if (event->modifiers() & Qt::ControlModifier) {
+        searchUpdate(searchMatch_ < 0 ? history_->size() : searchMatch_);
+        return true;
+      }
+      break;
+    case Qt::Key_Escape:
+    case Qt::Key_G:
+      if (event->key() == Qt::Key_Escape ||
+          event->modifiers() & Qt::ControlModifier) {
+        searchEnd();
+        line_.setText(draft_);
+        return true;
+      }
+      break;
+    case Qt::Key_Backspace:
+      searchQuery_.chop(1);
+      searchUpdate(history_->size());
+      return true;
+    case Qt::Key_Return:
+      searchEnd();
+      return false;
+    default:
+      break;
+  }
+
+  auto text = event->text();
+  if (!text.isEmpty() && text[0].isPrint()) {
+    /* a longer query can't match anything newer than the current match,
+       or anything at all once the shorter one failed */
+    searchQuery_ += text;
+    searchUpdate(searchFailed_ ? 0
+                               : searchMatch_ < 0 ? history_->size()
+                                                  : searchMatch_ + 1);
+    return true;
+  }
+
+  /* anything else accepts the match and is handled normally */
+  searchEnd();
+  return false;
+}
+
+/** * scrollback find **/
+void TtyWidget::findPrompt() {
+  prompt_ = QString("(find %1/%2)'%3': ")
+                .arg(matches_.isEmpty() ? 0 : currentMatch_ + 1)
+                .arg(matches_.size())
+                .arg(findQuery_);
+}
+
+void TtyWidget::findMove(int delta) {
+  if (matches_.isEmpty()) return;
+
+  currentMatch_ = (currentMatch_ + delta + matches_.size()) % matches_.size();
+
+  QFontMetrics m(font());
+  auto& match = matches_[currentMatch_];
+  auto x = glyphOffsets(match.row).value(match.column);
+
+  verticalScrollBar()->setValue(match.row * m.height() -
+                                viewport()->height() / 2);
+  if (x < horizontalScrollBar()->value() ||
+      x > horizontalScrollBar()->value() + viewport()->width() - XOFF * 2)
+    horizontalScrollBar()->setValue(x - viewport()->width() / 2);
+
+  findPrompt();
+}
+
+/** * the scan runs on the finder's thread, newest query wins **/
+void TtyWidget::findUpdate() {
+  findPrompt();
+
+  if (findQuery_.isEmpty()) {
+    finder_.cancel();
+    matches_.clear();
+    return;
+  }
+
+  finder_.find(buffer_.lines(), findQuery_, this,
+               [this](QString query, QVector<ScrollbackFinder::Match> found) {
+                 if (!finding_ || query != findQuery_) return;
+
+                 matches_ = found;
+                 matchLength_ = query.size();
+                 currentMatch_ = matches_.size();
+                 findMove(-1);
+                 findPrompt();
+                 viewport()->update();
+               });
+}
+
+void TtyWidget::findEnd() {
+  finding_ = false;
+  finder_.cancel();
+  matches_.clear();
+  prompt_ = QString(". ");
+}
+
+/** * keys while in ctrl-f find, false if the key should run as usual **/
+bool TtyWidget::findKey(QKeyEvent* event) {
+  switch (event->key()) {
+    case Qt::Key_Escape:
+      findEnd();
+      return true;
+    case Qt::Key_Up:
+      findMove(-1);
+      return true;
+    case Qt::Key_Down:
+      findMove(1);
+      return true;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+      findMove(event->modifiers() & Qt::ShiftModifier ? 1 : -1);
+      return true;
+    case Qt::Key_Backspace:
+      findQuery_.chop(1);
+      findUpdate();
+      return true;
+    default:
+      break;
+  }
+
+  if (event->matches(QKeySequence::Find)) {
+    findMove(-1);
+    return true;
+  }
+
+  auto text = event->text();
+  if (!text.isEmpty() && text[0].isPrint()) {
+    findQuery_ += text;
+    findUpdate();
+    return true;
+  }
+
+  findEnd();
+  return false;
 }
 
 /** * events **/
 void TtyWidget::keyPressEvent(QKeyEvent* event) {
+  if (searching_ && searchKey(event)) {
+    updateInput();
+    return;
+  }
+
+  if (finding_ && findKey(event)) {
+    viewport()->update();
+    return;
+  }
+
+  if (event->matches(QKeySequence::Find)) {
+    finding_ = true;
+    findQuery_.clear();
+    findUpdate();
+    updateInput();
+    return;
+  }
+
+  if (event->matches(QKeySequence::Copy) &&
+      _selection->hasActiveSelection()) {
+    copySelection(QClipboard::Clipboard);
+    return;
+  }
+
+  if (event->matches(QKeySequence::Paste)) {
+    paste(QGuiApplication::clipboard()->text());
+    updateInput();
+    return;
+  }
+
   switch (event->key()) {
-    case Qt::Key_Return: {
-      buffer_ << prompt_ + line_;
+    case Qt::Key_Return:
+    case Qt::Key_Enter: {
+      auto text = line_.text();
+
+      /* an open form continues on the next line */
+      if (event->modifiers() & Qt::ShiftModifier ||
+          !FormReader::complete(text)) {
+        line_.insert("\n");
+        break;
+      }
+
+      auto& input = inputLines();
+      auto first = buffer_.size();
+
+      buffer_.append(prompt_ + input.first());
+      for (int i = 1; i < input.size(); ++i)
+        buffer_.append(QString(prompt_.size(), ' ') + input.at(i));
 
-      auto error_text = ideEnv->withException([this]() {
-        auto lines = ideEnv->rep(line_).split(
+      history_->append(text);
+      historyIndex_ = -1;
+
+      Profiler::Scope profile;
+      Watchdog::Scope watch("console " + session_->name, text);
+      Session::Activity activity(session_);
+      auto env = session_->env();
+      auto error_text = env->withException([this, env, text]() {
+        auto lines = env->rep(text).split(
             '\n', QString::SplitBehavior::KeepEmptyParts, Qt::CaseSensitive);
-        for (int i = 0; i < lines.size(); ++i) buffer_ << lines.at(i);
+        for (int i = 0; i < lines.size(); ++i) buffer_.append(lines.at(i));
       });
 
-      if (error_text.size() > 1) buffer_ << error_text;
+      if (error_text.size() > 1)
+        buffer_.append(error_text, buffer_.intern(ERROR_ATTR));
 
       line_.clear();
-      break;
+      updateFrom(first);
+      return;
     }
     case Qt::Key_Backspace:
-      line_.resize(line_.size() - 1);
+      line_.backspace();
+      if (completer_->popup()->isVisible()) requestCompletion();
       break;
-    default:
-      line_.append(event->text());
+    case Qt::Key_Delete:
+      line_.erase();
+      break;
+    case Qt::Key_Left:
+      line_.moveBy(-1);
+      break;
+    case Qt::Key_Right:
+      line_.moveBy(1);
+      break;
+    case Qt::Key_Home:
+      line_.moveTo(line_.lineStart(line_.cursor()));
       break;
+    case Qt::Key_End:
+      line_.moveTo(line_.lineEnd(line_.cursor()));
+      break;
+    case Qt::Key_Tab:
+      requestCompletion();
+      break;
+    case Qt::Key_Up:
+      if (!line_.moveLine(-1)) historyMove(-1);
+      break;
+    case Qt::Key_Down:
+      if (!line_.moveLine(1)) historyMove(1);
+      break;
+    case Qt::Key_R:
+      if (event->modifiers() & Qt::ControlModifier) {
+        searching_ = true;
+        searchQuery_.clear();
+        searchMatch_ = -1;
+        draft_ = line_.text();
+        searchUpdate(history_->size());
+        break;
+      }
+      line_.insert(event->text());
+      break;
+    default: {
+      /* several characters at once come from input methods and pastes */
+      auto text = event->text();
+
+      if (text.isEmpty() || !(text.size() > 1 || text[0].isPrint())) break;
+
+      line_.insert(text);
+      if (completer_->popup()->isVisible()) requestCompletion();
+      break;
+    }
   }
 
-  viewport()->update();
+  updateInput();
 }
 
 void TtyWidget::keyReleaseEvent(QKeyEvent*) {}
 
-void TtyWidget::mousePressEvent(QMouseEvent*) {
-#if 0
+void TtyWidget::mousePressEvent(QMouseEvent* event) {
   QAbstractScrollArea::mousePressEvent(event);
 
-  if (event->buttons().testFlag(Qt::LeftButton)) {
-    TextPosition tp = getTextPosition(event->pos());
-    if (tp.row < buffer_.size())
-      _selection->start(tp);
+  if (event->button() == Qt::LeftButton) {
+    _selection->start(getTextPosition(event->pos()));
+    viewport()->update();
+  } else if (event->button() == Qt::MiddleButton) {
+    paste(QGuiApplication::clipboard()->text(QClipboard::Selection));
+    updateInput();
   }
-  
-  this->viewport()->update();
-#endif
 }
 
 void TtyWidget::mouseReleaseEvent(QMouseEvent* event) {
   QAbstractScrollArea::mouseReleaseEvent(event);
+
+  if (event->button() == Qt::LeftButton &&
+      QGuiApplication::clipboard()->supportsSelection())
+    copySelection(QClipboard::Selection);
 }
 
 void TtyWidget::mouseMoveEvent(QMouseEvent* event) {
-#if 0
   QAbstractScrollArea::mouseMoveEvent(event);
 
-  if(event->buttons().testFlag(Qt::LeftButton)) {
-    TextPosition tp = getTextPosition(event->pos());
-    if (tp.row < buffer_.size())
-      _selection->end(tp);
+  if (event->buttons().testFlag(Qt::LeftButton)) {
+    _selection->end(getTextPosition(event->pos()));
+    viewport()->update();
   }
+}
 
-  update();
-#endif
+void TtyWidget::setSelection(int row, int column, int end_row,
+                             int end_column) {
+  _selection->start(TextPosition(row, column));
+  _selection->end(TextPosition(end_row, end_column));
+  viewport()->update();
+}
+
+void TtyWidget::clearSelection() {
+  _selection->start(TextPosition());
+  viewport()->update();
 }
 
 void TtyWidget::writeTty(QString str) {
-  buffer_ << str;
-  ;
+  auto first = buffer_.size();
+
+  for (auto& line : str.split('\n')) buffer_.append(line);
+  updateFrom(first);
+}
+
+/** * sessions **/
+void TtyWidget::attach(Session* session) {
+  if (session == session_) return;
+
+  /* a session is shown in one console at a time */
+  if (session->tty != nullptr)
+    session->tty->attach(SessionManager::instance()->create());
+
+  detach();
+
+  auto released = !session->hasEnv() && !session->scrollback.isEmpty();
+
+  session_ = session;
+  session_->tty = this;
+  symbols_ = Completer::forEnv(session_->env());
+
+  buffer_ = session_->scrollback;
+  if (buffer_.isEmpty())
+    buffer_.append(QString(";;; gyre ").append(session_->env()->version()),
+                   buffer_.intern(BANNER_ATTR));
+  if (released)
+    buffer_.append(
+        QString(";;; %1 was released while idle, this is a fresh env")
+            .arg(session_->name),
+        buffer_.intern(BANNER_ATTR));
+
+  if (finding_) findEnd();
+  _selection->start(TextPosition());
+  completer_->popup()->hide();
+  offsets_.clear();
+
+  session_->touch();
+  viewport()->update();
+}
+
+/** * the scrollback goes back to the session **/
+void TtyWidget::detach() {
+  if (session_ == nullptr) return;
+
+  session_->scrollback = buffer_;
+  session_->tty = nullptr;
+  session_->touch();
+  session_ = nullptr;
 }
 
 /** * constructor **/
 TtyWidget::TtyWidget(QWidget* parent)
     : QAbstractScrollArea(parent),
-      ideEnv(new GyreEnv()),
-      _selection(new TextSelection) {
+      inputGeneration_(~0ULL),
+      history_(History::instance()),
+      historyIndex_(-1),
+      searching_(false),
+      searchFailed_(false),
+      searchMatch_(-1),
+      finding_(false),
+      matchLength_(0),
+      currentMatch_(0),
+      session_(nullptr),
+      symbols_(nullptr),
+      completer_(new QCompleter(this)),
+      _selection(new TextSelection),
+      offsets_(1 << 20) {
+  completer_->setWidget(this);
+  completer_->setModel(new QStringListModel(completer_));
+  completer_->setCompletionMode(QCompleter::UnfilteredPopupCompletion);
+  connect(completer_, QOverload<const QString&>::of(&QCompleter::activated),
+          this, &TtyWidget::insertCompletion);
+
   viewport()->setCursor(Qt::IBeamCursor);
-  buffer_ << QString(";;; gyre ").append(ideEnv->version());
   prompt_ = QString(". ");
-  cursor_ = QString("_");
+
+  attach(SessionManager::instance()->create());
 }
 
+TtyWidget::~TtyWidget() { detach(); }
+
 }  // namespace gyreui
@@ -15,6 +15,9 @@
 #define GYREUI_UI_TTYWIDGET_H_
 
 #include <QAbstractScrollArea>
+#include <QCache>
+#include <QClipboard>
+#include <QCompleter>
 #include <QDebug>
 #include <QFrame>
 #include <QKeyEvent>
@@ -25,7 +28,13 @@
 #include <QSharedPointer>
 #include <QStringList>
 
+#include "Completer.h"
 #include "GyreEnv.h"
+#include "History.h"
+#include "LineEditor.h"
+#include "Scrollback.h"
+#include "ScrollbackFinder.h"
+#include "Session.h"
 
 class QPaintEvent;
 class QMouseEvent;
@@ -40,14 +49,24 @@ class TtyWidget : public QAbstractScrollArea {
 
  public:
   explicit TtyWidget(QWidget*);
+  ~TtyWidget() override;
 
   void writeTty(QString);
+  void setSelection(int, int, int, int);
+  void clearSelection();
+  QString selectedText() const;
 
-  GyreEnv* get_gyre() { return ideEnv; }
+  void attach(Session*);
+  void detach();
+  Session* session() const { return session_; }
+
+  GyreEnv* get_gyre() { return session_->pin(); }
 
  protected:
   void paintEvent(QPaintEvent* event) override;
+  void changeEvent(QEvent* event) override;
 
+  bool focusNextPrevChild(bool) override { return false; }
   void keyPressEvent(QKeyEvent* event) override;
   void keyReleaseEvent(QKeyEvent* event) override;
   void mouseMoveEvent(QMouseEvent* event) override;
@@ -55,18 +74,63 @@ class TtyWidget : public QAbstractScrollArea {
   void mouseReleaseEvent(QMouseEvent* event) override;
 
  private:
-  void DrawCursor();
-  void DrawLine(int&, int, QString, QFontMetrics, int);
-
+  void DrawCursor(QPainter&, const QFontMetrics&);
+  void DrawMatches(QPainter&, int, int, const QFontMetrics&);
+  void DrawLine(QPainter&, int&, int, const QString&, const QVector<AttrRun>&,
+                const QFontMetrics&, int);
+
+  const QStringList& inputLines();
+  QRect inputRect();
+  QRect cursorRect(const QFontMetrics&);
+  void updateInput();
+  void updateFrom(int);
+  void paste(QString);
+
+  void requestCompletion();
+  void insertCompletion(const QString&);
+
+  void historyMove(int);
+  bool searchKey(QKeyEvent*);
+  void searchUpdate(int);
+  void searchEnd();
+
+  bool findKey(QKeyEvent*);
+  void findUpdate();
+  void findMove(int);
+  void findPrompt();
+  void findEnd();
+
+  void copySelection(QClipboard::Mode);
+  QVector<int> glyphOffsets(int) const;
   TextPosition getTextPosition(const QPoint& pos) const;
 
-  QString cursor_;
-  QString line_;
+  LineEditor line_;
+  QStringList inputLines_;
+  quint64 inputGeneration_;
   QString prompt_;
-  QStringList buffer_;
-
-  GyreEnv* ideEnv;
+  Scrollback buffer_;
+  QString segment_;
+
+  History* history_;
+  int historyIndex_;
+  QString draft_;
+  bool searching_;
+  bool searchFailed_;
+  QString searchQuery_;
+  int searchMatch_;
+
+  ScrollbackFinder finder_;
+  bool finding_;
+  QString findQuery_;
+  int matchLength_;
+  int currentMatch_;
+  QVector<ScrollbackFinder::Match> matches_;
+
+  Session* session_;
+  Completer* symbols_;
+  QCompleter* completer_;
   QSharedPointer<TextSelection> _selection;
+  mutable QCache<int, QVector<int>> offsets_;
 };
 
 }  // namespace gyreui
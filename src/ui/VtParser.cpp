@@ -0,0 +1,172 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  VtParser.cpp: VT100/xterm parser implementation
+ **
+ **  after Paul Williams' DEC ANSI parser state diagram, with DCS, SOS,
+ **  PM and APC strings swallowed whole. printable ASCII in the ground
+ **  state goes straight to the screen, which is nearly all of a build log.
+ **
+ **/
+#include "VtParser.h"
+
+namespace gyreui {
+
+void VtParser::clear(STATE next) {
+  state = next;
+  params.clear();
+  intermediates.clear();
+  codepoint = 0;
+  pending = 0;
+}
+
+/** * C0 controls act in every state but the strings **/
+void VtParser::control(unsigned char ch) {
+  switch (ch) {
+    case 0x18: /* CAN */
+    case 0x1a: /* SUB */
+      clear(GROUND);
+      break;
+    case 0x1b:
+      clear(ESCAPE);
+      break;
+    default:
+      screen->execute(ch);
+      break;
+  }
+}
+
+void VtParser::utf8(unsigned char ch) {
+  if (pending > 0) {
+    if ((ch & 0xc0) == 0x80) {
+      codepoint = codepoint << 6 | (ch & 0x3f);
+      if (--pending == 0) screen->print(codepoint);
+      return;
+    }
+
+    /* truncated sequence, show it and take this byte afresh */
+    pending = 0;
+    screen->print(U'\ufffd');
+  }
+
+  if (ch < 0x80) {
+    screen->print(ch);
+  } else if ((ch & 0xe0) == 0xc0) {
+    codepoint = ch & 0x1f;
+    pending = 1;
+  } else if ((ch & 0xf0) == 0xe0) {
+    codepoint = ch & 0x0f;
+    pending = 2;
+  } else if ((ch & 0xf8) == 0xf0) {
+    codepoint = ch & 0x07;
+    pending = 3;
+  } else {
+    screen->print(U'\ufffd');
+  }
+}
+
+void VtParser::feed(const char* data, int size) {
+  for (int i = 0; i < size; ++i) {
+    auto ch = static_cast<unsigned char>(data[i]);
+
+    switch (state) {
+      case GROUND:
+        if (ch >= 0x20 && ch < 0x7f && pending == 0)
+          screen->print(ch);
+        else if (ch < 0x20)
+          control(ch);
+        else if (ch != 0x7f)
+          utf8(ch);
+        break;
+
+      case ESCAPE:
+        if (ch < 0x20) {
+          control(ch);
+        } else if (ch == '[') {
+          clear(CSI_PARAM);
+        } else if (ch == ']') {
+          clear(OSC_STRING);
+          oscText.clear();
+        } else if (ch == 'P' || ch == 'X' || ch == '^' || ch == '_') {
+          clear(STRING_IGNORE);
+        } else if (ch < 0x30) {
+          intermediates += ch;
+          state = ESCAPE_INTERMEDIATE;
+        } else if (ch < 0x7f) {
+          screen->esc(intermediates, ch);
+          clear(GROUND);
+        }
+        break;
+
+      case ESCAPE_INTERMEDIATE:
+        if (ch < 0x20) {
+          control(ch);
+        } else if (ch < 0x30) {
+          intermediates += ch;
+        } else if (ch < 0x7f) {
+          screen->esc(intermediates, ch);
+          clear(GROUND);
+        }
+        break;
+
+      case CSI_PARAM:
+        if (ch < 0x20) {
+          control(ch);
+        } else if (ch >= '0' && ch <= '9') {
+          if (params.isEmpty()) params << 0;
+          params.last() = qMin(params.last() * 10 + (ch - '0'), 0xffff);
+        } else if (ch == ';' || ch == ':') {
+          if (params.isEmpty()) params << 0;
+          if (params.size() < MAX_PARAMS)
+            params << 0;
+          else
+            state = CSI_IGNORE;
+        } else if (ch >= 0x3c && ch <= 0x3f) {
+          /* private markers only lead, anywhere else the sequence is bad */
+          if (params.isEmpty() && intermediates.isEmpty())
+            intermediates += ch;
+          else
+            state = CSI_IGNORE;
+        } else if (ch < 0x30) {
+          intermediates += ch;
+        } else if (ch >= 0x40 && ch < 0x7f) {
+          screen->csi(params, intermediates, ch);
+          clear(GROUND);
+        }
+        break;
+
+      case CSI_IGNORE:
+        if (ch < 0x20)
+          control(ch);
+        else if (ch >= 0x40 && ch < 0x7f)
+          clear(GROUND);
+        break;
+
+      case OSC_STRING:
+        if (ch == 0x07 || ch == 0x1b) {
+          screen->osc(oscText);
+          oscText.clear();
+          clear(ch == 0x1b ? ESCAPE : GROUND);
+        } else if (ch >= 0x20 && oscText.size() < MAX_OSC) {
+          oscText += ch;
+        }
+        break;
+
+      case STRING_IGNORE:
+        if (ch == 0x07)
+          clear(GROUND);
+        else if (ch == 0x1b)
+          clear(ESCAPE);
+        break;
+    }
+  }
+}
+
+}  // namespace gyreui
@@ -0,0 +1,63 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  VtParser.h: incremental VT100/xterm escape sequence parser
+ **
+ **/
+#ifndef GYREUI_UI_VTPARSER_H_
+#define GYREUI_UI_VTPARSER_H_
+
+#include <QByteArray>
+#include <QVector>
+
+#include "Screen.h"
+
+namespace gyreui {
+
+/** * byte at a time state machine, sequences may span any number of reads **/
+class VtParser {
+ public:
+  static const int MAX_PARAMS = 16;
+  static const int MAX_OSC = 4096;
+
+  void feed(const char*, int);
+  void feed(const QByteArray& bytes) { feed(bytes.constData(), bytes.size()); }
+
+  explicit VtParser(Screen* screen) : screen(screen) { clear(GROUND); }
+
+ private:
+  enum STATE {
+    GROUND,
+    ESCAPE,
+    ESCAPE_INTERMEDIATE,
+    CSI_PARAM,
+    CSI_IGNORE,
+    OSC_STRING,
+    STRING_IGNORE
+  };
+
+  void clear(STATE);
+  void utf8(unsigned char);
+  void control(unsigned char);
+
+  Screen* screen;
+  STATE state;
+
+  QVector<int> params;
+  QByteArray intermediates;
+  QByteArray oscText;
+
+  char32_t codepoint;
+  int pending;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_VTPARSER_H_ */
@@ -0,0 +1,198 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Watchdog.cpp: gui thread stall watchdog implementation
+ **
+ **  a timer on the gui thread bumps a heartbeat. the watcher thread
+ **  notices when it stops, asks the gui thread for a backtrace the
+ **  way the profiler does, and waits for the heartbeat to come back
+ **  to time the stall. scopes around evals say what was running.
+ **
+ **/
+#include "Watchdog.h"
+
+#include <execinfo.h>
+#include <signal.h>
+
+#include <chrono>
+
+#include <QDateTime>
+#include <QStringList>
+
+#include "Profiler.h"
+
+namespace gyreui {
+
+namespace {
+
+/* backtrace frames for onSignal and the signal trampoline */
+const int SKIP = 2;
+
+qint64 now() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void nap(int msecs) {
+  std::this_thread::sleep_for(std::chrono::milliseconds(msecs));
+}
+
+}  // namespace
+
+Watchdog* Watchdog::self = nullptr;
+
+/** * runs on the gui thread, async-signal-safe work only **/
+void Watchdog::onSignal(int) {
+  auto dog = self;
+
+  if (dog == nullptr || dog->sampled.load()) return;
+
+  dog->depth = backtrace(dog->frames, MAX_DEPTH);
+  dog->sampled.store(true);
+}
+
+Watchdog* Watchdog::instance() {
+  static Watchdog watchdog;
+
+  return &watchdog;
+}
+
+void Watchdog::enter(QString inFrame, QString inForm) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  frame = inFrame;
+  form = inForm;
+}
+
+void Watchdog::leave() {
+  std::lock_guard<std::mutex> guard(lock);
+
+  frame.clear();
+  form.clear();
+}
+
+void Watchdog::start() {
+  if (running.load()) return;
+
+  /* backtrace may allocate on first use, get that out of the way here */
+  void* warm[2];
+  (void)backtrace(warm, 2);
+
+  struct sigaction sa;
+  sa.sa_handler = &Watchdog::onSignal;
+  sa.sa_flags = SA_RESTART;
+  sigemptyset(&sa.sa_mask);
+  sigaction(SIGUSR2, &sa, nullptr);
+
+  gui = pthread_self();
+  beat.store(now());
+  pingTimer->start();
+
+  running.store(true);
+  watcher = std::thread([this]() { watch(); });
+}
+
+void Watchdog::stop() {
+  if (!running.load()) return;
+
+  running.store(false);
+  watcher.join();
+  pingTimer->stop();
+}
+
+/** * the watcher thread, one stall at a time **/
+void Watchdog::watch() {
+  while (running.load()) {
+    nap(PING_MSECS);
+
+    auto last = beat.load();
+    if (now() - last < DEADLINE_MSECS) continue;
+
+    Stall stall;
+    stall.when = QDateTime::currentMSecsSinceEpoch() - (now() - last);
+
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stall.frame = frame;
+      stall.form = form;
+    }
+
+    sampled.store(false);
+    pthread_kill(gui, SIGUSR2);
+    for (int i = 0; i < 100 && !sampled.load(); ++i) nap(1);
+
+    if (sampled.load())
+      for (int i = SKIP; i < depth; ++i) stall.stack << frames[i];
+
+    /* the next beat is at most a ping after the gui thread comes back */
+    while (running.load() && beat.load() == last) nap(PING_MSECS / 5);
+    stall.msecs = qMax(0LL, beat.load() - last - PING_MSECS);
+
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      ring << stall;
+      if (ring.size() > RING_SIZE) ring.removeFirst();
+    }
+
+    emit stalled();
+  }
+}
+
+QList<Stall> Watchdog::stalls() {
+  std::lock_guard<std::mutex> guard(lock);
+
+  return ring;
+}
+
+void Watchdog::clear() {
+  std::lock_guard<std::mutex> guard(lock);
+
+  ring.clear();
+}
+
+/** * symbolized stacks, gui thread **/
+QString Watchdog::stackText(const Stall& stall) {
+  QStringList lines;
+
+  for (int i = 0; i < stall.stack.size(); ++i)
+    lines << QString("  #%1 %2").arg(i).arg(
+                 Profiler::instance()->symbolize(stall.stack[i]));
+
+  return lines.join('\n');
+}
+
+QString Watchdog::report() {
+  QStringList out;
+
+  for (auto& stall : stalls()) {
+    out << QString("%1 %2ms %3")
+               .arg(QDateTime::fromMSecsSinceEpoch(stall.when)
+                        .toString("yyyy-MM-dd hh:mm:ss.zzz"))
+               .arg(stall.msecs)
+               .arg(stall.frame.isEmpty() ? "event loop" : stall.frame);
+    if (!stall.form.isEmpty()) out << "  form: " + stall.form;
+    out << stackText(stall) << "";
+  }
+
+  return out.join('\n');
+}
+
+Watchdog::Watchdog() : running(false), beat(0), sampled(false), depth(0) {
+  pingTimer = new QTimer(this);
+  pingTimer->setInterval(PING_MSECS);
+  connect(pingTimer, &QTimer::timeout, this, [this]() { beat.store(now()); });
+
+  self = this;
+}
+
+Watchdog::~Watchdog() { stop(); }
+
+}  // namespace gyreui
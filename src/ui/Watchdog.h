@@ -0,0 +1,105 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  Watchdog.h: gui thread stall watchdog
+ **
+ **/
+#ifndef GYREUI_UI_WATCHDOG_H_
+#define GYREUI_UI_WATCHDOG_H_
+
+#include <pthread.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QVector>
+
+namespace gyreui {
+
+/** * one missed deadline, stack taken as it was detected **/
+struct Stall {
+  qint64 when;
+  qint64 msecs;
+  QString frame;
+  QString form;
+  QVector<void*> stack;
+};
+
+class Watchdog : public QObject {
+  Q_OBJECT
+
+ public:
+  static const int PING_MSECS = 50;
+  static const int DEADLINE_MSECS = 250;
+  static const int RING_SIZE = 128;
+  static const int MAX_DEPTH = 64;
+
+  /** * names the frame and form the gui thread is busy with **/
+  class Scope {
+   public:
+    Scope(QString frame, QString form) {
+      Watchdog::instance()->enter(frame, form);
+    }
+    ~Scope() { Watchdog::instance()->leave(); }
+  };
+
+  static Watchdog* instance();
+
+  /** * from the gui thread **/
+  void start();
+  void stop();
+
+  QList<Stall> stalls();
+  void clear();
+
+  /** * the stall log as text, newest last, gui thread **/
+  static QString stackText(const Stall&);
+  QString report();
+
+ signals:
+  void stalled();
+
+ private:
+  Watchdog();
+  ~Watchdog() override;
+
+  void enter(QString, QString);
+  void leave();
+  void watch();
+
+  static void onSignal(int);
+
+  static Watchdog* self;
+
+  std::atomic<bool> running;
+  std::atomic<qint64> beat;
+  pthread_t gui;
+  std::thread watcher;
+  QTimer* pingTimer;
+
+  /* written by the signal handler on the gui thread */
+  std::atomic<bool> sampled;
+  int depth;
+  void* frames[MAX_DEPTH];
+
+  std::mutex lock;
+  QString frame;
+  QString form;
+  QList<Stall> ring;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_WATCHDOG_H_ */
@@ -0,0 +1,751 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  XrefIndex.cpp: cross reference index implementation
+ **
+ **  the index lives in ~/.gyre-ui-xref, the sites of every file with
+ **  their symbols interned. at startup the builder thread loads it and
+ **  walks the roots; only files whose mtime or size moved are parsed
+ **  again, on every core. after that the tree watcher, and the composer
+ **  when it loads or saves a file, hand it single files.
+ **
+ **  lookups never touch the files, they take the lock and copy out one
+ **  hash entry.
+ **
+ **/
+#include "XrefIndex.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+#include "Completer.h"
+#include "LogBus.h"
+
+namespace gyreui {
+
+namespace {
+
+bool stamp(const QString& path, QPair<qint64, qint64>& out) {
+  struct stat st;
+  if (stat(QFile::encodeName(path).constData(), &st) != 0 ||
+      !S_ISREG(st.st_mode))
+    return false;
+
+  out = qMakePair(qint64(st.st_mtime), qint64(st.st_size));
+  return true;
+}
+
+/** * a reader that only looks at heads: the symbol opening a list is a
+      call unless the list is data, a parameter list or a let binding **/
+class Scanner {
+ public:
+  explicit Scanner(const QString& text)
+      : src(text), pos(0), line(1), lineStart(0) {}
+
+  QVector<XrefIndex::Site> scan() {
+    for (;;) {
+      skipWhitespace();
+      if (pos >= src.size()) return sites;
+      form(QString(), false, true);
+    }
+  }
+
+ private:
+  QChar at(int n) const { return n < src.size() ? src[n] : QChar(); }
+
+  void advance() {
+    if (src[pos] == '\n') {
+      line++;
+      lineStart = pos + 1;
+    }
+    pos++;
+  }
+
+  void skipWhitespace() {
+    while (pos < src.size()) {
+      auto ch = src[pos];
+
+      if (ch.isSpace()) {
+        advance();
+      } else if (ch == ';') {
+        while (pos < src.size() && src[pos] != '\n') advance();
+      } else if (ch == '#' && at(pos + 1) == '|') {
+        pos += 2;
+        while (pos < src.size() && !(src[pos] == '|' && at(pos + 1) == '#'))
+          advance();
+        pos = qMin(pos + 2, src.size());
+      } else {
+        break;
+      }
+    }
+  }
+
+  void skipString() {
+    for (advance(); pos < src.size(); advance()) {
+      if (src[pos] == '\\') {
+        advance();
+        if (pos >= src.size()) return;
+      } else if (src[pos] == '"') {
+        advance();
+        return;
+      }
+    }
+  }
+
+  bool atAtom() const {
+    auto ch = src[pos];
+
+    return ch != '(' && ch != ')' && ch != '"' && ch != '\'' && ch != '`' &&
+           ch != ',' && !(ch == '#' && at(pos + 1) == '(');
+  }
+
+  QString atom() {
+    auto start = pos;
+
+    while (pos < src.size()) {
+      auto ch = src[pos];
+
+      if (ch.isSpace() || ch == '(' || ch == ')' || ch == '"' || ch == ';')
+        break;
+      if (ch == '#' && at(pos + 1) == '\\') {
+        pos += 2;
+        if (pos >= src.size()) break;
+      }
+      advance();
+    }
+
+    return src.mid(start, pos - start);
+  }
+
+  /** * keywords are special forms, numbers and #-syntax aren't symbols **/
+  static bool callable(const QString& head) {
+    auto ch = head[0];
+
+    if (ch == ':' || ch == '#' || ch.isDigit()) return false;
+
+    return !((ch == '-' || ch == '+' || ch == '.') && head.size() > 1 &&
+             head[1].isDigit());
+  }
+
+  void site(const QString& symbol, const QString& scope, int atLine,
+            int column, XrefIndex::Kind kind) {
+    sites.push_back(XrefIndex::Site{symbol, scope, atLine, column, kind});
+  }
+
+  /** * the head of the list at pos, without moving **/
+  QString peekHead() {
+    if (pos >= src.size() || src[pos] != '(') return QString();
+
+    auto saved = pos;
+    auto savedLine = line;
+    auto savedStart = lineStart;
+
+    advance();
+    skipWhitespace();
+    auto head = pos < src.size() && atAtom() ? atom() : QString();
+
+    pos = saved;
+    line = savedLine;
+    lineStart = savedStart;
+
+    return head;
+  }
+
+  /** * one form, quoted forms are data and call nothing **/
+  void form(const QString& scope, bool quoted, bool top = false) {
+    skipWhitespace();
+    if (pos >= src.size()) return;
+
+    auto ch = src[pos];
+
+    if (ch == '\'' || ch == '`') {
+      advance();
+      form(scope, true);
+    } else if (ch == ',') {
+      advance();
+      if (at(pos) == '@') advance();
+      form(scope, false);
+    } else if (ch == '"') {
+      skipString();
+    } else if (ch == '#' && at(pos + 1) == '(') {
+      advance();
+      list(scope, true, false);
+    } else if (ch == ')') {
+      advance();
+    } else if (ch == '(') {
+      list(scope, quoted, top);
+    } else {
+      atom();
+    }
+  }
+
+  void list(QString scope, bool quoted, bool top) {
+    advance();
+    skipWhitespace();
+
+    if (pos < src.size() && atAtom()) {
+      auto atLine = line;
+      auto column = pos - lineStart + 1;
+      auto head = atom();
+
+      if (head == ":quote") {
+        quoted = true;
+      } else if (quoted) {
+        /* data */
+      } else if (top && (head == ":defcon" || head == ":defsym")) {
+        scope = define(scope);
+      } else if (head == ":lambda") {
+        skipWhitespace();
+        if (pos < src.size() && src[pos] == '(') form(scope, true);
+      } else if (head == "let" || head == "let*") {
+        bindings(scope);
+      } else if (callable(head)) {
+        site(head, scope, atLine, column, XrefIndex::CALL);
+      }
+    }
+
+    rest(scope, quoted);
+  }
+
+  void rest(const QString& scope, bool quoted) {
+    for (;;) {
+      skipWhitespace();
+      if (pos >= src.size()) return;
+
+      if (src[pos] == ')') {
+        advance();
+        return;
+      }
+
+      form(scope, quoted);
+    }
+  }
+
+  /** * the name after a defining head, a function when its value is a
+        lambda or a closure over one **/
+  QString define(const QString& scope) {
+    skipWhitespace();
+    if (pos >= src.size() || !atAtom()) return scope;
+
+    auto atLine = line;
+    auto column = pos - lineStart + 1;
+    auto name = atom();
+
+    skipWhitespace();
+    auto value = peekHead();
+    site(name, QString(), atLine, column,
+         value == ":lambda" || value == "closure" ? XrefIndex::FUNCTION
+                                                  : XrefIndex::CONSTANT);
+
+    return name;
+  }
+
+  /** * (let ((name value) ...) body), the names aren't calls **/
+  void bindings(const QString& scope) {
+    skipWhitespace();
+    if (pos >= src.size() || src[pos] != '(') return;
+
+    advance();
+    for (;;) {
+      skipWhitespace();
+      if (pos >= src.size()) return;
+
+      if (src[pos] == ')') {
+        advance();
+        return;
+      }
+
+      if (src[pos] != '(') {
+        form(scope, false);
+        continue;
+      }
+
+      advance();
+      skipWhitespace();
+      if (pos < src.size() && atAtom()) atom();
+      rest(scope, false);
+    }
+  }
+
+  QString src;
+  int pos;
+  int line;
+  int lineStart;
+  QVector<XrefIndex::Site> sites;
+};
+
+}  // namespace
+
+const char* XrefIndex::coreSource = "/opt/gyre/src";
+const char* XrefIndex::rootsVariable = "GYRE_UI_XREF_PATH";
+
+XrefIndex* XrefIndex::instance() {
+  static XrefIndex index;
+
+  return &index;
+}
+
+QString XrefIndex::symbolAt(const QString& text, int pos) {
+  int start = qBound(0, pos, text.size());
+  int end = start;
+
+  while (start > 0 && Completer::isSymbolChar(text[start - 1])) --start;
+  while (end < text.size() && Completer::isSymbolChar(text[end])) ++end;
+
+  return text.mid(start, end - start);
+}
+
+QVector<XrefIndex::Site> XrefIndex::parse(const QString& text) {
+  return Scanner(text).scan();
+}
+
+void XrefIndex::addRoot(QString path) {
+  auto root = QDir::cleanPath(QDir(path).absolutePath());
+  std::lock_guard<std::mutex> guard(lock);
+
+  for (auto& known : roots)
+    if (root == known || root.startsWith(known + '/')) return;
+
+  roots << root;
+  rescan = true;
+  wanted.notify_one();
+}
+
+void XrefIndex::addRoots(QString userdir) {
+  addRoot(userdir);
+  addRoot(coreSource);
+
+  auto configured = QString::fromLocal8Bit(qgetenv(rootsVariable));
+  for (auto& root :
+       configured.split(QDir::listSeparator(), QString::SkipEmptyParts))
+    addRoot(root);
+}
+
+/** * a file already known is checked again, the composer saved it **/
+void XrefIndex::addFile(QString path) {
+  auto file = QDir::cleanPath(QDir(path).absolutePath());
+  std::lock_guard<std::mutex> guard(lock);
+
+  if (!wants(file)) files << file;
+
+  touched.insert(file);
+  wanted.notify_one();
+}
+
+QVector<XrefIndex::Ref> XrefIndex::definitions(QString symbol) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  return defined.value(symbol);
+}
+
+QVector<XrefIndex::Ref> XrefIndex::callers(QString symbol) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  return called.value(symbol);
+}
+
+QString XrefIndex::status() {
+  std::lock_guard<std::mutex> guard(lock);
+
+  if (!state.isEmpty()) return state;
+
+  return QString("%1 files, %2 symbols defined")
+      .arg(units.size())
+      .arg(defined.size());
+}
+
+/** * under lock **/
+bool XrefIndex::wants(const QString& path) {
+  if (files.contains(path)) return true;
+  if (!path.endsWith(".l")) return false;
+
+  for (auto& root : roots)
+    if (path.startsWith(root + '/')) return true;
+
+  return false;
+}
+
+void XrefIndex::insert(const QString& path, const Unit& unit) {
+  for (auto& site : unit.sites)
+    (site.kind == CALL ? called : defined)[site.symbol].push_back(
+        Ref{path, site});
+
+  units.insert(path, unit);
+}
+
+/** * each symbol's refs are filtered once, however often the file
+      mentions it **/
+void XrefIndex::remove(const QString& path) {
+  auto unit = units.find(path);
+  if (unit == units.end()) return;
+
+  QSet<QString> defs;
+  QSet<QString> calls;
+
+  for (auto& site : unit->sites)
+    (site.kind == CALL ? calls : defs).insert(site.symbol);
+
+  auto purge = [&path](QHash<QString, QVector<Ref>>& table,
+                       const QSet<QString>& symbols) {
+    for (auto& symbol : symbols) {
+      auto refs = table.find(symbol);
+      if (refs == table.end()) continue;
+
+      refs->erase(std::remove_if(refs->begin(), refs->end(),
+                                 [&path](const Ref& ref) {
+                                   return ref.path == path;
+                                 }),
+                  refs->end());
+      if (refs->isEmpty()) table.erase(refs);
+    }
+  };
+
+  purge(defined, defs);
+  purge(called, calls);
+  units.erase(unit);
+}
+
+/** * builder thread **/
+void XrefIndex::walk(QString root, QHash<QString, Stamp>& found) {
+  QStringList dirs{root};
+
+  while (!dirs.isEmpty() && !stopping.load()) {
+    auto dir = dirs.takeLast();
+
+    watcher->watch(dir);
+
+    auto dp = opendir(QFile::encodeName(dir).constData());
+    if (dp == nullptr) continue;
+
+    for (auto ent = readdir(dp); ent != nullptr; ent = readdir(dp)) {
+      if (ent->d_name[0] == '.') continue;
+
+      struct stat st;
+      if (fstatat(dirfd(dp), ent->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0)
+        continue;
+
+      auto path = dir + '/' + QFile::decodeName(ent->d_name);
+
+      if (S_ISDIR(st.st_mode))
+        dirs << path;
+      else if (S_ISREG(st.st_mode) && path.endsWith(".l"))
+        found.insert(path, {qint64(st.st_mtime), qint64(st.st_size)});
+    }
+
+    closedir(dp);
+  }
+}
+
+void XrefIndex::parseAll(QHash<QString, Unit>& stale) {
+  std::vector<std::pair<QString, Unit*>> jobs;
+  for (auto it = stale.begin(); it != stale.end(); ++it)
+    jobs.emplace_back(it.key(), &it.value());
+
+  auto threads = std::min<size_t>(
+      jobs.size(), qMax(1u, std::thread::hardware_concurrency()));
+  std::vector<std::thread> workers;
+  std::atomic<size_t> next(0);
+
+  for (size_t w = 0; w < threads; ++w)
+    workers.emplace_back([this, &jobs, &next]() {
+      for (auto i = next++; i < jobs.size(); i = next++) {
+        if (stopping.load()) return;
+
+        QFile file(jobs[i].first);
+        if (!file.open(QIODevice::ReadOnly) || file.size() > MAX_FILE_SIZE)
+          continue;
+
+        jobs[i].second->sites = parse(QString::fromUtf8(file.readAll()));
+      }
+    });
+
+  for (auto& worker : workers) worker.join();
+}
+
+/** * parse what moved among paths, found stamps the ones still there **/
+void XrefIndex::reconcile(const QSet<QString>& paths,
+                          const QHash<QString, Stamp>& found) {
+  QHash<QString, Unit> stale;
+  QStringList gone;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+
+    for (auto& path : paths) {
+      auto at = found.constFind(path);
+
+      if (at == found.constEnd() || !wants(path)) {
+        if (units.contains(path)) gone << path;
+        continue;
+      }
+
+      auto unit = units.constFind(path);
+      if (unit == units.constEnd() || unit->mtime != at->first ||
+          unit->size != at->second)
+        stale.insert(path, Unit{at->first, at->second, {}});
+    }
+
+    if (stale.isEmpty() && gone.isEmpty()) return;
+    if (stale.size() > 1) state = QString("parsing %1 files").arg(stale.size());
+  }
+
+  parseAll(stale);
+  if (stopping.load()) return;
+
+  std::lock_guard<std::mutex> guard(lock);
+
+  for (auto& path : gone) remove(path);
+  for (auto it = stale.constBegin(); it != stale.constEnd(); ++it) {
+    remove(it.key());
+    insert(it.key(), it.value());
+  }
+
+  modified = true;
+  state.clear();
+}
+
+/** * every root walked again, against everything the index holds **/
+void XrefIndex::refresh() {
+  QStringList rootList;
+  QStringList fileList;
+  QSet<QString> paths;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+
+    rootList = roots;
+    fileList = files;
+    for (auto it = units.constBegin(); it != units.constEnd(); ++it)
+      paths.insert(it.key());
+  }
+
+  watcher->clear();
+
+  QHash<QString, Stamp> found;
+  for (auto& root : rootList) walk(root, found);
+
+  for (auto& path : fileList) {
+    Stamp at;
+    if (stamp(path, at)) found.insert(path, at);
+  }
+
+  for (auto it = found.constBegin(); it != found.constEnd(); ++it)
+    paths.insert(it.key());
+
+  reconcile(paths, found);
+}
+
+void XrefIndex::update(const QSet<QString>& paths) {
+  QHash<QString, Stamp> found;
+
+  for (auto& path : paths) {
+    Stamp at;
+    if (stamp(path, at)) found.insert(path, at);
+  }
+
+  reconcile(paths, found);
+}
+
+/** * symbols and scopes are interned, a site is five numbers **/
+void XrefIndex::save() {
+  QHash<QString, Unit> snapshot;
+  QStringList rootList;
+  QStringList fileList;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    if (!modified) return;
+
+    modified = false;
+    snapshot = units;
+    rootList = roots;
+    fileList = files;
+  }
+
+  QHash<QString, quint32> ids;
+  QStringList strings;
+
+  auto intern = [&ids, &strings](const QString& text) {
+    if (!ids.contains(text)) {
+      ids.insert(text, strings.size());
+      strings << text;
+    }
+  };
+
+  for (auto& unit : snapshot)
+    for (auto& site : unit.sites) {
+      intern(site.symbol);
+      intern(site.scope);
+    }
+
+  QSaveFile file(indexPath);
+  if (!file.open(QIODevice::WriteOnly)) {
+    LogBus::instance()->post(LogEntry::ERROR, "xref",
+                             "can't write " + indexPath);
+    return;
+  }
+
+  QDataStream out(&file);
+  out.setVersion(QDataStream::Qt_5_12);
+  out << MAGIC << rootList << fileList << strings << quint32(snapshot.size());
+
+  for (auto it = snapshot.constBegin(); it != snapshot.constEnd(); ++it) {
+    auto& unit = it.value();
+
+    out << it.key() << unit.mtime << unit.size << quint32(unit.sites.size());
+    for (auto& site : unit.sites)
+      out << ids[site.symbol] << ids[site.scope] << qint32(site.line)
+          << qint32(site.column) << quint8(site.kind);
+  }
+
+  if (!file.commit())
+    LogBus::instance()->post(LogEntry::ERROR, "xref",
+                             "can't write " + indexPath);
+}
+
+void XrefIndex::load() {
+  QFile file(indexPath);
+  if (!file.open(QIODevice::ReadOnly)) return;
+
+  QDataStream in(&file);
+  in.setVersion(QDataStream::Qt_5_12);
+
+  quint32 magic;
+  QStringList rootList;
+  QStringList fileList;
+  QStringList strings;
+  quint32 count;
+
+  in >> magic;
+  if (magic != MAGIC) return;
+
+  in >> rootList >> fileList >> strings >> count;
+
+  QHash<QString, Unit> loaded;
+  for (quint32 n = 0; n < count && in.status() == QDataStream::Ok; ++n) {
+    QString path;
+    Unit unit;
+    quint32 sites;
+
+    in >> path >> unit.mtime >> unit.size >> sites;
+    for (quint32 s = 0; s < sites && in.status() == QDataStream::Ok; ++s) {
+      quint32 symbol, scope;
+      qint32 line, column;
+      quint8 kind;
+
+      in >> symbol >> scope >> line >> column >> kind;
+      if (symbol >= quint32(strings.size()) ||
+          scope >= quint32(strings.size()) || kind > CALL) {
+        in.setStatus(QDataStream::ReadCorruptData);
+        break;
+      }
+
+      unit.sites.push_back(
+          Site{strings[symbol], strings[scope], line, column, Kind(kind)});
+    }
+
+    loaded.insert(path, unit);
+  }
+
+  if (in.status() != QDataStream::Ok) {
+    LogBus::instance()->post(LogEntry::WARNING, "xref",
+                             indexPath + " is damaged, reparsing");
+    return;
+  }
+
+  std::lock_guard<std::mutex> guard(lock);
+
+  for (auto& root : rootList)
+    if (!roots.contains(root)) roots << root;
+  for (auto& path : fileList)
+    if (!files.contains(path)) files << path;
+  for (auto it = loaded.constBegin(); it != loaded.constEnd(); ++it)
+    insert(it.key(), it.value());
+}
+
+void XrefIndex::build() {
+  load();
+
+  for (;;) {
+    bool all;
+    QSet<QString> paths;
+    {
+      std::unique_lock<std::mutex> guard(lock);
+
+      wanted.wait(guard, [this]() {
+        return stopping.load() || rescan || !touched.isEmpty();
+      });
+      if (stopping.load()) return;
+
+      all = rescan;
+      rescan = false;
+      paths.swap(touched);
+    }
+
+    if (all)
+      refresh();
+    else
+      update(paths);
+
+    save();
+  }
+}
+
+/** * watcher thread **/
+void XrefIndex::changed(TreeWatcher::Change change, QString path) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  if (change == TreeWatcher::OVERFLOWED) {
+    rescan = true;
+  } else if (change == TreeWatcher::DIR_REMOVED) {
+    path += '/';
+    for (auto it = units.constBegin(); it != units.constEnd(); ++it)
+      if (it.key().startsWith(path)) touched.insert(it.key());
+  } else if (wants(path)) {
+    touched.insert(path);
+  } else {
+    return;
+  }
+
+  wanted.notify_one();
+}
+
+XrefIndex::XrefIndex()
+    : indexPath(QDir::home().filePath(".gyre-ui-xref")),
+      files{QDir::home().filePath(".gyre-ui")},
+      rescan(true),
+      modified(false),
+      stopping(false) {
+  watcher.reset(new TreeWatcher(
+      [this](TreeWatcher::Change change, QString path) {
+        changed(change, path);
+      }));
+
+  builder = std::thread([this]() { build(); });
+}
+
+XrefIndex::~XrefIndex() {
+  stopping.store(true);
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    wanted.notify_one();
+  }
+
+  builder.join();
+  watcher.reset();
+}
+
+}  // namespace gyreui
@@ -0,0 +1,132 @@
+/********
+ **
+ **  SPDX-License-Identifier: BSD-3-Clause
+ **
+ **  Copyright (c) 2017-2021 James M. Putnam <putnamjm.design@gmail.com>
+ **
+ **/
+
+/********
+ **
+ **  XrefIndex.h: definitions and call sites in mu source
+ **
+ **/
+#ifndef GYREUI_UI_XREFINDEX_H_
+#define GYREUI_UI_XREFINDEX_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include <QHash>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include "TreeWatcher.h"
+
+namespace gyreui {
+
+/** * every .l file under the roots, parsed in the background and kept
+      current file by file; lookups are a hash probe on the caller's thread **/
+class XrefIndex {
+ public:
+  static const quint32 MAGIC = 0x47585231; /* GXR1 */
+  static const qint64 MAX_FILE_SIZE = 4 << 20;
+  static const char* coreSource;
+  /* more roots, separated as PATH is */
+  static const char* rootsVariable;
+
+  enum Kind { CONSTANT, FUNCTION, CALL };
+
+  /** * a definition, or a call made from within scope **/
+  struct Site {
+    QString symbol;
+    QString scope;
+    int line;
+    int column;
+    Kind kind;
+  };
+
+  struct Ref {
+    QString path;
+    Site site;
+  };
+
+  static XrefIndex* instance();
+
+  /** * the whole symbol under pos in text **/
+  static QString symbolAt(const QString&, int);
+
+  /** * the definitions and call sites in mu source text **/
+  static QVector<Site> parse(const QString&);
+
+  /** * roots are walked for .l files, both are remembered in the index **/
+  void addRoot(QString);
+
+  /** * the user's directory, mu's core source and the configured roots,
+        once at startup **/
+  void addRoots(QString);
+  void addFile(QString);
+
+  QVector<Ref> definitions(QString);
+  QVector<Ref> callers(QString);
+
+  QString status();
+
+ private:
+  typedef QPair<qint64, qint64> Stamp;
+
+  struct Unit {
+    qint64 mtime;
+    qint64 size;
+    QVector<Site> sites;
+  };
+
+  XrefIndex();
+  ~XrefIndex();
+
+  /* the builder thread */
+  void build();
+  void refresh();
+  void update(const QSet<QString>&);
+  void reconcile(const QSet<QString>&, const QHash<QString, Stamp>&);
+  void walk(QString, QHash<QString, Stamp>&);
+  void parseAll(QHash<QString, Unit>&);
+  void save();
+  void load();
+
+  /* under lock */
+  bool wants(const QString&);
+  void insert(const QString&, const Unit&);
+  void remove(const QString&);
+
+  /* the watcher thread */
+  void changed(TreeWatcher::Change, QString);
+
+  QString indexPath;
+
+  std::mutex lock;
+  std::condition_variable wanted;
+  QStringList roots;
+  QStringList files;
+  QHash<QString, Unit> units;
+  QHash<QString, QVector<Ref>> defined;
+  QHash<QString, QVector<Ref>> called;
+  bool rescan;
+  bool modified;
+  QSet<QString> touched;
+  QString state;
+  std::atomic<bool> stopping;
+
+  std::unique_ptr<TreeWatcher> watcher;
+  std::thread builder;
+};
+
+}  // namespace gyreui
+
+#endif /* GYREUI_UI_XREFINDEX_H_ */
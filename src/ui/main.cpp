@@ -14,9 +14,14 @@
 #include <QApplication>
 #include <QDesktopWidget>
 
+#include "BatchRunner.h"
 #include "MainWindow.h"
 
 int main(int argc, char **argv) {
+  /* no QApplication and no widgets in batch mode */
+  if (gyreui::BatchRunner::isBatch(argc, argv))
+    return gyreui::BatchRunner(argc, argv).run();
+
   QApplication app(argc, argv);
 
   gyreui::MainWindow mainWindow;
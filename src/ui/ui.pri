@@ -0,0 +1,118 @@
+INCLUDEPATH += $$PWD /opt/gyre/include
+LIBS += /opt/gyre/lib/libmu.a
+
+unix:!macx {
+  LIBS += -ldl -lpthread -lutil
+  QMAKE_LFLAGS += -rdynamic
+}
+
+HEADERS += \
+           /opt/gyre/include/libmu/libmu.h \
+           $$PWD/BatchRunner.h        \
+           $$PWD/Completer.h          \
+           $$PWD/ComposerFrame.h      \
+           $$PWD/ConsoleFrame.h       \
+           $$PWD/DiagnosticsFrame.h   \
+           $$PWD/DirScanner.h         \
+           $$PWD/EnvPool.h            \
+           $$PWD/EnvironmentView.h    \
+           $$PWD/ExpanderFrame.h      \
+           $$PWD/FileSystemFrame.h    \
+           $$PWD/FileSystemModel.h    \
+           $$PWD/FileView.h           \
+           $$PWD/FlameGraph.h         \
+           $$PWD/FormReader.h         \
+           $$PWD/FrameMenu.h          \
+           $$PWD/GyreEnv.h            \
+           $$PWD/GyreFrame.h          \
+           $$PWD/History.h            \
+           $$PWD/InspectorFrame.h     \
+           $$PWD/InspectorModel.h     \
+           $$PWD/LatencyHistogram.h   \
+           $$PWD/Layout.h             \
+           $$PWD/LineEditor.h         \
+           $$PWD/LogBus.h             \
+           $$PWD/MacroExpander.h      \
+           $$PWD/MainMenuBar.h        \
+           $$PWD/MainWindow.h         \
+           $$PWD/MuPrelude.h          \
+           $$PWD/NotificationsFrame.h \
+           $$PWD/Profiler.h           \
+           $$PWD/ProfilerFrame.h      \
+           $$PWD/Pty.h                \
+           $$PWD/ResultView.h         \
+           $$PWD/ScratchpadFrame.h    \
+           $$PWD/Screen.h             \
+           $$PWD/ScriptFrame.h        \
+           $$PWD/Scrollback.h         \
+           $$PWD/ScrollbackFinder.h   \
+           $$PWD/SearchFrame.h        \
+           $$PWD/SearchIndex.h        \
+           $$PWD/Session.h            \
+           $$PWD/SessionsFrame.h      \
+           $$PWD/ShellFrame.h         \
+           $$PWD/StatusClock.h        \
+           $$PWD/SystemView.h         \
+           $$PWD/TerminalView.h       \
+           $$PWD/TestRunnerFrame.h    \
+           $$PWD/Tile.h               \
+           $$PWD/TreeWatcher.h        \
+           $$PWD/TrigramIndex.h       \
+           $$PWD/TtyWidget.h          \
+           $$PWD/UserFrame.h          \
+           $$PWD/VtParser.h           \
+           $$PWD/Watchdog.h           \
+           $$PWD/XrefIndex.h          \
+           $$PWD/user.h
+
+SOURCES += \
+           $$PWD/BatchRunner.cpp      \
+           $$PWD/Completer.cpp        \
+           $$PWD/ComposerFrame.cpp    \
+           $$PWD/ConsoleFrame.cpp     \
+           $$PWD/DiagnosticsFrame.cpp \
+           $$PWD/DirScanner.cpp       \
+           $$PWD/EnvPool.cpp          \
+           $$PWD/EnvironmentView.cpp  \
+           $$PWD/ExpanderFrame.cpp    \
+           $$PWD/FileSystemFrame.cpp  \
+           $$PWD/FileSystemModel.cpp  \
+           $$PWD/FileView.cpp         \
+           $$PWD/FlameGraph.cpp       \
+           $$PWD/FrameMenu.cpp        \
+           $$PWD/GyreFrame.cpp        \
+           $$PWD/History.cpp          \
+           $$PWD/InspectorFrame.cpp   \
+           $$PWD/InspectorModel.cpp   \
+           $$PWD/Layout.cpp           \
+           $$PWD/LogBus.cpp           \
+           $$PWD/MacroExpander.cpp    \
+           $$PWD/MainMenuBar.cpp      \
+           $$PWD/MainWindow.cpp       \
+           $$PWD/NotificationsFrame.cpp \
+           $$PWD/Profiler.cpp         \
+           $$PWD/ProfilerFrame.cpp    \
+           $$PWD/Pty.cpp              \
+           $$PWD/ResultView.cpp       \
+           $$PWD/ScratchpadFrame.cpp  \
+           $$PWD/Screen.cpp           \
+           $$PWD/ScriptFrame.cpp      \
+           $$PWD/ScrollbackFinder.cpp \
+           $$PWD/SearchFrame.cpp      \
+           $$PWD/SearchIndex.cpp      \
+           $$PWD/Session.cpp          \
+           $$PWD/SessionsFrame.cpp    \
+           $$PWD/ShellFrame.cpp       \
+           $$PWD/SystemView.cpp       \
+           $$PWD/TerminalView.cpp     \
+           $$PWD/TestRunnerFrame.cpp  \
+           $$PWD/Tile.cpp             \
+           $$PWD/TreeWatcher.cpp      \
+           $$PWD/TrigramIndex.cpp     \
+           $$PWD/TtyWidget.cpp        \
+           $$PWD/UserFrame.cpp        \
+           $$PWD/VtParser.cpp         \
+           $$PWD/Watchdog.cpp         \
+           $$PWD/XrefIndex.cpp
+
+QT += core gui widgets